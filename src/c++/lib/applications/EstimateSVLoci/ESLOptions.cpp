@@ -95,7 +95,17 @@ parseESLOptions(const manta::Program& prog,
     ("align-stats", po::value<std::string>(&opt.statsFilename),
      "pre-computed alignment statistics for the input alignment files (required)")
     ("region", po::value<std::string>(&opt.region),
-     "samtools formatted region, eg. 'chr1:20-30' (optional)");
+     "samtools formatted region, eg. 'chr1:20-30' (optional)")
+    ("decompress-threads", po::value(&opt.decompressThreadCount)->default_value(opt.decompressThreadCount),
+     "number of threads used to decompress each alignment file, 0 reads without worker threads")
+    ("chrom-depth", po::value(&opt.chromDepthFilename),
+     "average depth estimate for each chromosome, enables depth throttling (optional)")
+    ("throttle-depth-factor", po::value(&opt.throttleDepthFactor)->default_value(opt.throttleDepthFactor),
+     "downsample SV evidence where the local depth exceeds the chromosome depth times this factor")
+    ("throttled-region-file", po::value(&opt.throttledRegionFilename),
+     "write regions where SV evidence was downsampled to this file (optional)")
+    ("depth-index-output-file", po::value(&opt.depthIndexFilename),
+     "write the binned maximum depth of the first alignment file over the scan region to this file (optional)");
 
     po::options_description help("help");
     help.add_options()
@@ -154,6 +164,15 @@ parseESLOptions(const manta::Program& prog,
 
     checkStandardizeUsageFile(log_os,prog,visible,opt.statsFilename,"alignment statistics");
 
+    if (! opt.chromDepthFilename.empty())
+    {
+        checkStandardizeUsageFile(log_os,prog,visible,opt.chromDepthFilename,"chromosome depth");
+    }
+    if (opt.throttleDepthFactor <= 0.)
+    {
+        usage(log_os,prog,visible,"throttle-depth-factor must be greater than 0");
+    }
+
     if (opt.outputFilename.empty())
     {
         usage(log_os,prog,visible,"Must specify a graph output file");
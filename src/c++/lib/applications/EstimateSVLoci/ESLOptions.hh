@@ -29,16 +29,33 @@ struct ESLOptions
 {
 
     ESLOptions() :
-        minMergeEdgeCount(3)
+        minMergeEdgeCount(3),
+        decompressThreadCount(0),
+        throttleDepthFactor(10.)
     {}
 
     ReadScannerOptions scanOpt;
     unsigned minMergeEdgeCount;
 
+    /// number of threads used to decompress each alignment file, 0 disables threaded decompression
+    unsigned decompressThreadCount;
+
     std::vector<std::string> alignmentFilename;
     std::string outputFilename;
     std::string region;
     std::string statsFilename;
+
+    /// average depth of each chromosome, required for depth throttling
+    std::string chromDepthFilename;
+
+    /// SV evidence is downsampled where the local depth exceeds the chromosome depth x this factor
+    double throttleDepthFactor;
+
+    /// if non-empty, write the regions where evidence was downsampled to this file
+    std::string throttledRegionFilename;
+
+    /// if non-empty, write the binned max depth of the first alignment file over the scan region to this file
+    std::string depthIndexFilename;
 };
 
 
@@ -47,7 +47,7 @@ runESL(const ESLOptions& opt)
     // setup all data for main alignment loop:
     BOOST_FOREACH(const std::string& afile, opt.alignmentFilename)
     {
-        stream_ptr tmp(new bam_streamer(afile.c_str(),opt.region.c_str()));
+        stream_ptr tmp(new bam_streamer(afile.c_str(),opt.region.c_str(),opt.decompressThreadCount));
         bam_streams.push_back(tmp);
     }
 
@@ -96,6 +96,17 @@ runESL(const ESLOptions& opt)
     locusFinder.flush();
 
     locusFinder.getLocusSet().save(opt.outputFilename.c_str());
+
+    if (! opt.throttledRegionFilename.empty())
+    {
+        OutStream throttleos(opt.throttledRegionFilename);
+        locusFinder.writeThrottledRegions(throttleos.getStream());
+    }
+
+    if (! opt.depthIndexFilename.empty())
+    {
+        locusFinder.getDepthIndex().save(opt.depthIndexFilename.c_str());
+    }
 }
 
 
@@ -18,10 +18,14 @@
 #include "SVLocusSetFinder.hh"
 
 #include "blt_util/align_path_bam_util.hh"
+#include "blt_util/hash_util.hh"
 #include "blt_util/log.hh"
+#include "manta/ChromDepthFilterUtil.hh"
 
 #include "boost/foreach.hpp"
 
+#include <cmath>
+
 #include <iostream>
 
 
@@ -66,7 +70,14 @@ SVLocusSetFinder(
     _denoisePos(0),
     _readScanner(opt.scanOpt,opt.statsFilename,opt.alignmentFilename),
     _anomCount(0),
-    _nonAnomCount(0)
+    _nonAnomCount(0),
+    _chromDepthFilename(opt.chromDepthFilename),
+    _throttleDepthFactor(opt.throttleDepthFactor),
+    _isMaxDepth(false),
+    _maxDepth(0),
+    _sampleDepth(opt.alignmentFilename.size()),
+    _isDepthIndex(! opt.depthIndexFilename.empty()),
+    _depthIndexBuilder(_depthIndex,scanRegion.tid,scanRegion.range.begin_pos(),scanRegion.range.end_pos())
 {
     updateDenoiseRegion();
 }
@@ -105,6 +116,82 @@ updateDenoiseRegion()
 
 
 
+void
+SVLocusSetFinder::
+updateMaxDepth()
+{
+    const ChromDepthFilterUtil dFilter(_chromDepthFilename,_throttleDepthFactor,_svLoci.header);
+
+    _isMaxDepth=(dFilter.isMaxDepthFilter() &&
+                 (static_cast<int32_t>(_svLoci.header.chrom_data.size()) > _scanRegion.tid));
+    if (_isMaxDepth)
+    {
+        _maxDepth=std::max(1.,dFilter.maxDepth(_scanRegion.tid));
+    }
+
+#ifdef DEBUG_SFINDER
+    log_os << "SFinder::updateMaxDepth isMaxDepth: " << _isMaxDepth << " maxDepth: " << _maxDepth << "\n";
+#endif
+}
+
+
+
+bool
+SVLocusSetFinder::
+isDepthThrottled(
+    const bam_record& bamRead,
+    const unsigned sampleIndex)
+{
+    if (! _isMaxDepth) return false;
+
+    const unsigned depth(_sampleDepth[sampleIndex].depth());
+    if (depth <= _maxDepth) return false;
+
+    // keep a fraction of evidence reads so that total evidence stays near the threshold depth,
+    // the read name is hashed so that both reads of a pair make the same decision:
+    const unsigned stride(static_cast<unsigned>(std::ceil(depth/_maxDepth)));
+    if ((fnv1a_hash(bamRead.qname()) % stride) == 0) return false;
+
+    // record throttled region, merging with the previous region if nearby:
+    static const pos_t regionMergeDistance(1000);
+    const pos_t beginPos(bamRead.pos()-1);
+    const pos_t endPos(bam_calend(&(bamRead.get_data()->core),bamRead.raw_cigar()));
+    if (_throttledRegions.empty() ||
+        (_throttledRegions.back().interval.tid != bamRead.target_id()) ||
+        ((_throttledRegions.back().interval.range.end_pos()+regionMergeDistance) < beginPos))
+    {
+        _throttledRegions.push_back(ThrottledRegion(GenomeInterval(bamRead.target_id(),beginPos,endPos),depth));
+    }
+    else
+    {
+        ThrottledRegion& region(_throttledRegions.back());
+        region.interval.range.set_end_pos(std::max(endPos,region.interval.range.end_pos()));
+        region.maxDepth=std::max(depth,region.maxDepth);
+    }
+    _throttledRegions.back().skipCount++;
+
+    return true;
+}
+
+
+
+void
+SVLocusSetFinder::
+writeThrottledRegions(std::ostream& os) const
+{
+    BOOST_FOREACH(const ThrottledRegion& region, _throttledRegions)
+    {
+        os << _svLoci.header.chrom_data[region.interval.tid].label
+           << '\t' << region.interval.range.begin_pos()
+           << '\t' << region.interval.range.end_pos()
+           << '\t' << region.maxDepth
+           << '\t' << region.skipCount
+           << '\n';
+    }
+}
+
+
+
 void
 SVLocusSetFinder::
 process_pos(const int stage_no,
@@ -175,6 +262,25 @@ update(const bam_record& bamRead,
 {
     _isScanStarted=true;
 
+    // track depth over all mapped reads to match the chromosome depth estimate:
+    const bool isDepthIndexRead(_isDepthIndex && (0 == defaultReadGroupIndex));
+    if ((_isMaxDepth || isDepthIndexRead) && (! bamRead.is_unmapped()))
+    {
+        const pos_t beginPos(bamRead.pos()-1);
+        if (_isMaxDepth)
+        {
+            const pos_t endPos(bam_calend(&(bamRead.get_data()->core),bamRead.raw_cigar()));
+            _sampleDepth[defaultReadGroupIndex].add(beginPos,endPos);
+        }
+
+        // count only aligned bases, to match the breakend depth computed in hygen:
+        if (isDepthIndexRead)
+        {
+            bam_cigar_to_apath(bamRead.raw_cigar(),bamRead.n_cigar(),_apath);
+            _depthIndexBuilder.add_alignment(beginPos,_apath);
+        }
+    }
+
     // shortcut to speed things up:
     if (_readScanner.isReadFiltered(bamRead)) return;
 
@@ -194,6 +300,9 @@ update(const bam_record& bamRead,
 
     _stageman.handle_new_pos_value(bamRead.pos()-1);
 
+    // downsample evidence in regions of extreme depth:
+    if (isDepthThrottled(bamRead,defaultReadGroupIndex)) return;
+
     SVLocus locus;
 
     //_readScanner.getSVLocus(bamRead, defaultReadGroupIndex, locus);
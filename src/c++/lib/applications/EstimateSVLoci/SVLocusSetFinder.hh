@@ -20,8 +20,10 @@
 #include "ESLOptions.hh"
 
 #include "blt_util/bam_record.hh"
+#include "blt_util/depth_bin_index.hh"
 #include "blt_util/pos_processor_base.hh"
 #include "blt_util/stage_manager.hh"
+#include "blt_util/stream_depth_tracker.hh"
 #include "manta/SVLocusScanner.hh"
 #include "svgraph/SVLocusSet.hh"
 
@@ -67,6 +69,7 @@ struct SVLocusSetFinder : public pos_processor_base
         assert(! _isScanStarted);
         _svLoci.header = bam_header_info(header);
         updateDenoiseRegion();
+        updateMaxDepth();
     }
 
     // flush any cached values built up during the update process
@@ -76,11 +79,27 @@ struct SVLocusSetFinder : public pos_processor_base
         _svLoci.addAnomCount(_anomCount);
         _svLoci.addNonAnomCount(_nonAnomCount);
         _stageman.reset();
+        _depthIndexBuilder.finish();
 
         _anomCount=0;
         _nonAnomCount=0;
     }
 
+    /// binned max depth of the first alignment file over the scan region, this is only
+    /// built if a depth index file is specified in the options
+    const depth_bin_index&
+    getDepthIndex() const
+    {
+        return _depthIndex;
+    }
+
+    /// write the regions where SV evidence was downsampled due to excessive depth
+    ///
+    /// one tab-delimited line is written per region: chrom, zero-indexed begin,
+    /// end, max depth observed, number of evidence reads skipped
+    void
+    writeThrottledRegions(std::ostream& os) const;
+
 
 private:
 
@@ -91,12 +110,38 @@ private:
     void
     updateDenoiseRegion();
 
+    /// find the depth throttling threshold of the scan region chromosome
+    void
+    updateMaxDepth();
+
+    /// update local depth for the sample, and test whether SV evidence from this
+    /// read should be skipped because the local depth is too high
+    bool
+    isDepthThrottled(
+        const bam_record& bamRead,
+        const unsigned sampleIndex);
+
     // TODO -- compute this number from read insert ranges:
     enum hack_t
     {
         REGION_DENOISE_BORDER = 5000
     };
 
+    struct ThrottledRegion
+    {
+        ThrottledRegion(
+            const GenomeInterval& initInterval = GenomeInterval(),
+            const unsigned initMaxDepth = 0) :
+            interval(initInterval),
+            maxDepth(initMaxDepth),
+            skipCount(0)
+        {}
+
+        GenomeInterval interval;
+        unsigned maxDepth;
+        unsigned skipCount;
+    };
+
     /////////////////////////////////////////////////
     // data:
     const GenomeInterval _scanRegion;
@@ -113,5 +158,21 @@ private:
 
     unsigned _anomCount;
     unsigned _nonAnomCount;
+
+    // depth throttling:
+    const std::string _chromDepthFilename;
+    const double _throttleDepthFactor;
+    bool _isMaxDepth;
+    double _maxDepth;
+    std::vector<stream_depth_tracker> _sampleDepth;
+    std::vector<ThrottledRegion> _throttledRegions;
+
+    // binned max depth index:
+    const bool _isDepthIndex;
+    depth_bin_index _depthIndex;
+    depth_bin_index_builder _depthIndexBuilder;
+
+    // alignment path buffer reused for each depth index read:
+    ALIGNPATH::path_t _apath;
 };
 
@@ -0,0 +1,228 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+
+///
+/// \author Chris Saunders
+///
+
+#include "EdgeCostModel.hh"
+
+#include "blt_util/log.hh"
+#include "blt_util/parse_util.hh"
+
+#include "boost/foreach.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+
+
+/// get the size of the region scanned for reads supporting a breakend in node
+static
+unsigned long
+getNodeSearchSize(const SVLocusNode& node)
+{
+    known_pos_range2 searchRange(node.interval.range);
+    searchRange.merge_range(node.evidenceRange);
+    return searchRange.size();
+}
+
+
+
+EdgeCostModel::
+EdgeCostModel(const SVLocusSet& set) :
+    _set(set),
+    _readDensity(1.)
+{
+    unsigned long genomeSize(0);
+    BOOST_FOREACH(const bam_header_info::chrom_info& chrom, _set.header.chrom_data)
+    {
+        genomeSize += chrom.length;
+    }
+
+    const unsigned long totalReadCount(_set.totalAnomCount()+_set.totalNonAnomCount());
+    if ((genomeSize > 0) && (totalReadCount > 0))
+    {
+        _readDensity = (static_cast<double>(totalReadCount)/static_cast<double>(genomeSize));
+    }
+}
+
+
+
+EdgeCostModel::edge_key_t
+EdgeCostModel::
+getEdgeKey(const EdgeInfo& edge) const
+{
+    const SVLocus& locus(_set.getLocus(edge.locusIndex));
+    return std::make_pair(locus.getNode(edge.nodeIndex1).interval,locus.getNode(edge.nodeIndex2).interval);
+}
+
+
+
+unsigned long
+EdgeCostModel::
+getEstimatedCost(const EdgeInfo& edge) const
+{
+    const SVLocus& locus(_set.getLocus(edge.locusIndex));
+    const SVLocusNode& node1(locus.getNode(edge.nodeIndex1));
+    const SVLocusNode& node2(locus.getNode(edge.nodeIndex2));
+
+    const unsigned long searchSize(getNodeSearchSize(node1)+getNodeSearchSize(node2));
+    const unsigned long observationCount(locus.getEdge(edge.nodeIndex1,edge.nodeIndex2).count +
+                                         locus.getEdge(edge.nodeIndex2,edge.nodeIndex1).count);
+
+    return (1 + static_cast<unsigned long>(std::ceil(_readDensity*searchSize)) + observationCount);
+}
+
+
+
+unsigned long
+EdgeCostModel::
+getCost(const EdgeInfo& edge) const
+{
+    if (! _measuredCost.empty())
+    {
+        const std::map<edge_key_t,unsigned long>::const_iterator iter(_measuredCost.find(getEdgeKey(edge)));
+        if (iter != _measuredCost.end()) return iter->second;
+    }
+    return getEstimatedCost(edge);
+}
+
+
+
+void
+EdgeCostModel::
+addMeasuredCosts(const std::string& filename)
+{
+    std::ifstream ifs(filename.c_str());
+    if (! ifs)
+    {
+        log_os << "ERROR: Failed to open edge runtime file: " << filename << "\n";
+        exit(EXIT_FAILURE);
+    }
+
+    std::map<std::string,int32_t> chromIndex;
+    const unsigned chromCount(_set.header.chrom_data.size());
+    for (unsigned tid(0); tid<chromCount; ++tid)
+    {
+        chromIndex[_set.header.chrom_data[tid].label] = tid;
+    }
+
+    std::map<edge_key_t,double> seconds;
+    std::string line;
+    std::vector<std::string> words;
+    while (std::getline(ifs,line))
+    {
+        if (line.empty()) continue;
+
+        words.clear();
+        std::istringstream iss(line);
+        std::string word;
+        while (std::getline(iss,word,'\t')) words.push_back(word);
+
+        if (words.size() != 7)
+        {
+            log_os << "ERROR: Unexpected format in edge runtime file: " << filename << " line: '" << line << "'\n";
+            exit(EXIT_FAILURE);
+        }
+
+        GenomeInterval intervals[2];
+        bool isKnownChrom(true);
+        for (unsigned nodeIndex(0); nodeIndex<2; ++nodeIndex)
+        {
+            const std::map<std::string,int32_t>::const_iterator chromIter(chromIndex.find(words[nodeIndex*3]));
+            if (chromIter == chromIndex.end())
+            {
+                isKnownChrom=false;
+                break;
+            }
+            intervals[nodeIndex].tid = chromIter->second;
+            intervals[nodeIndex].range.set_begin_pos(illumina::blt_util::parse_int_str(words[nodeIndex*3+1]));
+            intervals[nodeIndex].range.set_end_pos(illumina::blt_util::parse_int_str(words[nodeIndex*3+2]));
+        }
+
+        // runtimes from a graph built on a different reference are ignored:
+        if (! isKnownChrom) continue;
+
+        seconds[std::make_pair(intervals[0],intervals[1])] += illumina::blt_util::parse_double_str(words[6]);
+    }
+
+    // find the measured edges in this graph and the scale from seconds to estimate units:
+    typedef SVLocusNode::edges_type::const_iterator edgeiter_t;
+
+    std::vector<std::pair<edge_key_t,double> > matched;
+    double totalEstimate(0);
+    double totalSeconds(0);
+
+    const unsigned locusCount(_set.size());
+    for (unsigned locusIndex(0); locusIndex<locusCount; ++locusIndex)
+    {
+        const SVLocus& locus(_set.getLocus(locusIndex));
+        const unsigned nodeCount(locus.size());
+        for (unsigned nodeIndex(0); nodeIndex<nodeCount; ++nodeIndex)
+        {
+            const SVLocusNode& node(locus.getNode(nodeIndex));
+            edgeiter_t edgeIter(node.edges.upper_bound(nodeIndex));
+            const edgeiter_t edgeIterEnd(node.edges.end());
+            for (; edgeIter != edgeIterEnd; ++edgeIter)
+            {
+                EdgeInfo edge;
+                edge.locusIndex = locusIndex;
+                edge.nodeIndex1 = nodeIndex;
+                edge.nodeIndex2 = edgeIter->first;
+
+                const edge_key_t key(getEdgeKey(edge));
+                const std::map<edge_key_t,double>::const_iterator secIter(seconds.find(key));
+                if (secIter == seconds.end()) continue;
+
+                matched.push_back(std::make_pair(key,secIter->second));
+                totalEstimate += getEstimatedCost(edge);
+                totalSeconds += secIter->second;
+            }
+        }
+    }
+
+    if (totalSeconds <= 0.) return;
+
+    const double scale(totalEstimate/totalSeconds);
+    for (unsigned matchIndex(0); matchIndex<matched.size(); ++matchIndex)
+    {
+        const double cost(std::floor(matched[matchIndex].second*scale+0.5));
+        _measuredCost[matched[matchIndex].first] = (1 + static_cast<unsigned long>(cost));
+    }
+}
+
+
+
+void
+EdgeCostModel::
+writeMeasuredCost(
+    std::ostream& os,
+    const EdgeInfo& edge,
+    const double seconds) const
+{
+    const edge_key_t key(getEdgeKey(edge));
+    const GenomeInterval* intervals[] = { &(key.first), &(key.second) };
+    BOOST_FOREACH(const GenomeInterval* interval, intervals)
+    {
+        os << _set.header.chrom_data[interval->tid].label << '\t'
+           << interval->range.begin_pos() << '\t'
+           << interval->range.end_pos() << '\t';
+    }
+    os << seconds << '\n';
+}
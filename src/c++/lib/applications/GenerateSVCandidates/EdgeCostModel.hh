@@ -0,0 +1,80 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+
+///
+/// \author Chris Saunders
+///
+
+#pragma once
+
+#include "svgraph/EdgeInfo.hh"
+#include "svgraph/GenomeInterval.hh"
+#include "svgraph/SVLocusSet.hh"
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <utility>
+
+
+/// estimate the relative cost of generating SV hypotheses for each edge of an SV locus graph
+///
+/// The estimate is dominated by the number of reads scanned in the search regions of the
+/// edge's two nodes, which is approximated from the search region size and the read density
+/// recorded in the graph, plus the edge observation count to account for candidate complexity.
+///
+/// Edge runtimes measured by a previous run on the same graph can be added, these replace
+/// the estimate for each measured edge after being scaled into estimate units.
+///
+struct EdgeCostModel
+{
+    explicit
+    EdgeCostModel(const SVLocusSet& set);
+
+    /// read edge runtimes written by a previous hypothesis generation run
+    ///
+    /// the file has one tab-delimited line per edge: chrom1, begin1, end1, chrom2, begin2,
+    /// end2, seconds, where the node intervals are zero-indexed and half-open
+    void
+    addMeasuredCosts(const std::string& filename);
+
+    /// get the cost of edge, always 1 or greater
+    unsigned long
+    getCost(const EdgeInfo& edge) const;
+
+    /// the estimated cost of edge, ignoring any measured runtime
+    unsigned long
+    getEstimatedCost(const EdgeInfo& edge) const;
+
+    /// write a runtime line for edge in the format read by addMeasuredCosts
+    void
+    writeMeasuredCost(
+        std::ostream& os,
+        const EdgeInfo& edge,
+        const double seconds) const;
+
+private:
+    typedef std::pair<GenomeInterval,GenomeInterval> edge_key_t;
+
+    edge_key_t
+    getEdgeKey(const EdgeInfo& edge) const;
+
+    const SVLocusSet& _set;
+
+    /// expected reads per base in the search regions of each node
+    double _readDensity;
+
+    /// measured edge costs, scaled into estimate units
+    std::map<edge_key_t,unsigned long> _measuredCost;
+};
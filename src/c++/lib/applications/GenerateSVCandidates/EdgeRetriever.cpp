@@ -11,6 +11,7 @@
 // <https://github.com/downloads/sequencing/licenses/>.
 //
 
+
 ///
 /// \author Chris Saunders
 ///
@@ -19,8 +20,8 @@
 
 #include "boost/foreach.hpp"
 
+#include <algorithm>
 #include <cassert>
-
 #include <iostream>
 
 //#define DEBUG_EDGER
@@ -33,143 +34,169 @@
 
 static
 unsigned long
-getBoundaryCount(
-    const double binCount,
-    const double binIndex,
-    const double totalCount)
+getBoundaryCost(
+    const unsigned binCount,
+    const unsigned binIndex,
+    const unsigned long totalCost)
 {
-    return static_cast<unsigned>(std::floor((totalCount*binIndex)/binCount));
+    return static_cast<unsigned long>((static_cast<double>(totalCost)*binIndex)/binCount);
 }
 
 
 
-EdgeRetriever::
-EdgeRetriever(
-    const SVLocusSet& set,
-    const unsigned binCount,
-    const unsigned binIndex) :
-    _set(set),
-    _headCount(0)
+/// an edge with its cost and the genomic intervals of its nodes, where interval1 is the lower of the two
+struct CostedEdge
 {
-    assert(binCount > 0);
-    assert(binIndex < binCount);
+    CostedEdge(
+        const EdgeInfo& initEdge,
+        const GenomeInterval& nodeInterval1,
+        const GenomeInterval& nodeInterval2,
+        const unsigned long initCost) :
+        edge(initEdge),
+        interval1(nodeInterval1),
+        interval2(nodeInterval2),
+        cost(initCost)
+    {
+        if (interval2 < interval1) std::swap(interval1,interval2);
+    }
 
-    const unsigned long totalObservationCount(_set.totalObservationCount());
-    _beginCount=(getBoundaryCount(binCount,binIndex,totalObservationCount));
-    _endCount=(getBoundaryCount(binCount,binIndex+1,totalObservationCount));
+    /// locality order
+    bool
+    operator<(const CostedEdge& rhs) const
+    {
+        if (interval1 < rhs.interval1) return true;
+        if (rhs.interval1 < interval1) return false;
+        if (interval2 < rhs.interval2) return true;
+        if (rhs.interval2 < interval2) return false;
+        if (edge.locusIndex < rhs.edge.locusIndex) return true;
+        if (edge.locusIndex != rhs.edge.locusIndex) return false;
+        if (edge.nodeIndex1 < rhs.edge.nodeIndex1) return true;
+        if (edge.nodeIndex1 != rhs.edge.nodeIndex1) return false;
+        return (edge.nodeIndex2 < rhs.edge.nodeIndex2);
+    }
 
-#ifdef DEBUG_EDGER
-    log_os << "EDGER: bi,bc,begin,end: "
-           << binIndex << " "
-           << binCount << " "
-           << _beginCount << " "
-           << _endCount << "\n";
-#endif
-}
+    EdgeInfo edge;
+    GenomeInterval interval1;
+    GenomeInterval interval2;
+    unsigned long cost;
+};
 
 
 
 void
-EdgeRetriever::
-jumpToFirstEdge()
+getEdgeBins(
+    const SVLocusSet& set,
+    const unsigned binCount,
+    const bool isLocalityOrder,
+    const EdgeCostModel* costModel,
+    std::vector<std::vector<EdgeInfo> >& bins)
 {
-    // first catch headCount up to the begin edge if required:
-    while (true)
-    {
-        const SVLocus& locus(_set.getLocus(_edge.locusIndex));
-        const unsigned locusObservatinoCount(locus.totalObservationCount());
+    assert(binCount > 0);
 
-        if ((_headCount+locusObservatinoCount) > _beginCount)
+    const EdgeCostModel defaultCostModel(set);
+    if (NULL == costModel) costModel = &defaultCostModel;
+
+    typedef SVLocusNode::edges_type::const_iterator edgeiter_t;
+
+    // get every edge in the set with its cost, in locus and node index order:
+    std::vector<CostedEdge> edges;
+    unsigned long totalCost(0);
+
+    const unsigned locusCount(set.size());
+    for (unsigned locusIndex(0); locusIndex<locusCount; ++locusIndex)
+    {
+        const SVLocus& locus(set.getLocus(locusIndex));
+        const unsigned nodeCount(locus.size());
+        for (unsigned nodeIndex(0); nodeIndex<nodeCount; ++nodeIndex)
         {
-            while (true)
+            const SVLocusNode& node(locus.getNode(nodeIndex));
+            edgeiter_t edgeIter(node.edges.upper_bound(nodeIndex));
+            const edgeiter_t edgeIterEnd(node.edges.end());
+            for (; edgeIter != edgeIterEnd; ++edgeIter)
             {
-                const SVLocusNode& node(locus.getNode(_edge.nodeIndex1));
-
-                typedef SVLocusNode::edges_type::const_iterator edgeiter_t;
-                edgeiter_t edgeIter(node.edges.upper_bound(_edge.nodeIndex1));
-                const edgeiter_t edgeiterEnd(node.edges.end());
-
-                for (; edgeIter != edgeiterEnd; ++edgeIter)
-                {
-                    const unsigned edgeCount(edgeIter->second.count + locus.getEdge(edgeIter->first,_edge.nodeIndex1).count);
-                    _headCount += edgeCount;
-                    if (_headCount >= _beginCount)
-                    {
-                        _edge.nodeIndex2 = edgeIter->first;
-                        return;
-                    }
-                }
-
-                _edge.nodeIndex1++;
+                EdgeInfo edge;
+                edge.locusIndex = locusIndex;
+                edge.nodeIndex1 = nodeIndex;
+                edge.nodeIndex2 = edgeIter->first;
+
+                const unsigned long edgeCost(costModel->getCost(edge));
+                edges.push_back(CostedEdge(edge,node.interval,locus.getNode(edge.nodeIndex2).interval,edgeCost));
+                totalCost += edgeCost;
             }
-            assert(_headCount >= _beginCount);
         }
-        _headCount += locusObservatinoCount;
-        _edge.locusIndex++;
     }
-}
 
+    if (isLocalityOrder) std::sort(edges.begin(),edges.end());
 
+    // each bin takes a contiguous section of the ordered edges with a similar total cost,
+    // where each edge is assigned to the bin holding the midpoint of its cost range:
+    bins.clear();
+    bins.resize(binCount);
 
-void
-EdgeRetriever::
-advanceEdge()
-{
-    typedef SVLocusNode::edges_type::const_iterator edgeiter_t;
-
-    while (true)
+    unsigned binIndex(0);
+    unsigned long headCost(0);
+    BOOST_FOREACH(const CostedEdge& cedge, edges)
     {
-        const SVLocus& locus(_set.getLocus(_edge.locusIndex));
-        while (_edge.nodeIndex1<locus.size())
-        {
-            const SVLocusNode& node(locus.getNode(_edge.nodeIndex1));
-            edgeiter_t edgeIter(node.edges.upper_bound(_edge.nodeIndex2));
-            const edgeiter_t edgeIterEnd(node.edges.end());
+        // twice the edge midpoint, to keep all boundary tests in integers:
+        const unsigned long midCost2((2*headCost)+cedge.cost);
+        headCost += cedge.cost;
 
-            for (; edgeIter != edgeIterEnd; ++edgeIter)
-            {
-                const unsigned edgeCount(edgeIter->second.count + locus.getEdge(edgeIter->first,_edge.nodeIndex1).count);
-                _headCount += edgeCount;
-                _edge.nodeIndex2 = edgeIter->first;
-                return;
-            }
-            _edge.nodeIndex1++;
-            _edge.nodeIndex2=_edge.nodeIndex1;
+        while (((binIndex+1) < binCount) && (midCost2 >= (2*getBoundaryCost(binCount,binIndex+1,totalCost))))
+        {
+            binIndex++;
         }
-        _edge.locusIndex++;
-        _edge.nodeIndex1=0;
-        _edge.nodeIndex2=0;
+        bins[binIndex].push_back(cedge.edge);
+    }
+
+#ifdef DEBUG_EDGER
+    for (binIndex=0; binIndex<binCount; ++binIndex)
+    {
+        log_os << "EDGER: bi,bc,edges: "
+               << binIndex << " "
+               << binCount << " "
+               << bins[binIndex].size() << "\n";
     }
+#endif
+}
+
+
+
+EdgeRetriever::
+EdgeRetriever(
+    const SVLocusSet& set,
+    const unsigned binCount,
+    const unsigned binIndex,
+    const bool isLocalityOrder,
+    const EdgeCostModel* costModel) :
+    _binEdgeIndex(0)
+{
+    assert(binIndex < binCount);
+
+    std::vector<std::vector<EdgeInfo> > bins;
+    getEdgeBins(set,binCount,isLocalityOrder,costModel,bins);
+    _binEdges.swap(bins[binIndex]);
 }
 
 
 
+EdgeRetriever::
+EdgeRetriever(const std::vector<EdgeInfo>& edges) :
+    _binEdges(edges),
+    _binEdgeIndex(0)
+{}
+
+
+
 bool
 EdgeRetriever::
 next()
 {
-#ifdef DEBUG_EDGER
-    log_os << "EDGER: start next hc: " << _headCount << "\n";
-#endif
-
-    if (_headCount >= _endCount) return false;
+    if (_binEdgeIndex >= _binEdges.size()) return false;
+    _edge = _binEdges[_binEdgeIndex++];
 
-    // first catch headCount up to the begin edge if required:
-    if (_headCount < _beginCount)
-    {
-        jumpToFirstEdge();
-#ifdef DEBUG_EDGER
-        log_os << "EDGER: jumped hc: " << _headCount << " " << _edge  << "\n";
-#endif
-    }
-    else
-    {
-        advanceEdge();
 #ifdef DEBUG_EDGER
-        log_os << "EDGER: advanced hc: " << _headCount << " " << _edge  << "\n";
+    log_os << "EDGER: next edge: " << _edge  << "\n";
 #endif
-    }
 
-    assert(_headCount >= _beginCount);
-    return (_headCount <= _endCount);
+    return true;
 }
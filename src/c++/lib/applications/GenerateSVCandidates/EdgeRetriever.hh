@@ -11,30 +11,62 @@
 // <https://github.com/downloads/sequencing/licenses/>.
 //
 
+
 ///
 /// \author Chris Saunders
 ///
 
 #pragma once
 
+#include "EdgeCostModel.hh"
+
 #include "svgraph/EdgeInfo.hh"
 #include "svgraph/SVLocusSet.hh"
 
+#include <vector>
+
+
+/// divide all edges of set into binCount bins, which are contiguous sections of the edge order
+/// with similar total edge cost
+///
+/// \param isLocalityOrder if true, edges are ordered by genomic position, otherwise by locus and node index
+/// \param costModel edge costs used to balance bins, if null the default cost estimate is used
+void
+getEdgeBins(
+    const SVLocusSet& set,
+    const unsigned binCount,
+    const bool isLocalityOrder,
+    const EdgeCostModel* costModel,
+    std::vector<std::vector<EdgeInfo> >& bins);
+
+
 
 /// provide an iterator over edges in a set of SV locus graphs
 ///
 /// designed to allow parallelization of the graph processing by
 /// dividing iteration into a set of bins with similar total edge
-/// observation counts
+/// cost, as estimated by EdgeCostModel
+///
+/// by default edges are visited in locus and node index order, in locality order edges are
+/// visited in the genomic order of their nodes, so that each bin covers a contiguous
+/// part of the genome
 ///
 struct EdgeRetriever
 {
     /// \param binCount total number of parallel bins, must be 1 or greater
     /// \param binIndex parallel bin id, must be less than binCount
+    /// \param isLocalityOrder if true, visit edges in genomic order
+    /// \param costModel edge costs used to balance bins, if null the default cost estimate is used
     EdgeRetriever(
         const SVLocusSet& set,
         const unsigned binCount = 1,
-        const unsigned binIndex = 0);
+        const unsigned binIndex = 0,
+        const bool isLocalityOrder = false,
+        const EdgeCostModel* costModel = NULL);
+
+    /// iterate over a precomputed list of edges, such as one bin from getEdgeBins
+    explicit
+    EdgeRetriever(const std::vector<EdgeInfo>& edges);
 
     bool
     next();
@@ -46,16 +78,8 @@ struct EdgeRetriever
     }
 
 private:
-    void
-    jumpToFirstEdge();
-
-    void
-    advanceEdge();
-
-    const SVLocusSet& _set;
-    unsigned long _beginCount;
-    unsigned long _endCount;
-
-    unsigned long _headCount;
     EdgeInfo _edge;
+
+    std::vector<EdgeInfo> _binEdges;
+    unsigned _binEdgeIndex;
 };
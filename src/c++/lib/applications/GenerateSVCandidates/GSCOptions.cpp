@@ -97,16 +97,45 @@ parseGSCOptions(const manta::Program& prog,
      "pre-computed alignment statistics for the input alignment files (required)")
     ("chrom-depth", po::value(&opt.chromDepthFilename),
      "average depth estimate for each chromosome")
+    ("depth-index-file", po::value(&opt.depthIndexFilename),
+     "binned max depth index of the first non-tumor alignment file. Breakend depth from the index is an upper bound over whole bins, "
+     "exact breakend depth is collected from the alignment file if not provided (optional)")
     ("ref", po::value(&opt.referenceFilename),
      "fasta reference sequence (required)")
     ("candidate-output-file", po::value(&opt.candidateOutputFilename),
      "Write SV candidates to file (required)")
     ("somatic-output-file", po::value(&opt.somaticOutputFilename),
      "Write somatic SV candidates to file (at least one tumor and non-tumor alignment file must be specified)")
+    ("edge-runtime-file", po::value(&opt.edgeRuntimeFilename),
+     "Balance bins using the edge runtimes written by a previous run on the same graph (optional)")
+    ("edge-runtime-output-file", po::value(&opt.edgeRuntimeOutputFilename),
+     "Write the runtime of each edge to file (optional)")
+    ("claim-dir", po::value(&opt.claimDir),
+     "Run in dynamic work mode: processes sharing this directory claim chunks of edges until none remain. "
+     "Output for each chunk is written to the output filenames with a chunk number suffix, and bin-index/bin-count "
+     "set the first chunk claimed by each process. A process restarted with the same bin-index first "
+     "reprocesses the chunks it claimed earlier without completing them (optional)")
+    ("chunk-count", po::value(&opt.chunkCount)->default_value(opt.chunkCount),
+     "number of edge chunks in dynamic work mode")
     ("bin-count", po::value(&opt.binCount)->default_value(opt.binCount),
      "Specify how many bins the SV candidate problem should be divided into, where bin-index can be used to specify which bin to solve")
     ("bin-index", po::value(&opt.binIndex)->default_value(opt.binIndex),
      "specify which bin to solve when the SV candidate problem is subdivided into bins. Value must bin in [0,bin-count)")
+    ("decompress-threads", po::value(&opt.decompressThreadCount)->default_value(opt.decompressThreadCount),
+     "number of threads used to decompress each alignment file, 0 reads without worker threads")
+    ("prefetch-regions",
+     "read alignment file regions for the next graph edge in the background while the current edge is processed")
+    ("threads", po::value(&opt.threadCount)->default_value(opt.threadCount),
+     "number of threads processing edges of the graph, output is written in the same order for any thread count")
+    ("edge-batch-size", po::value(&opt.edgeBatchSize)->default_value(opt.edgeBatchSize),
+     "number of graph edges which are processed together, so that alignment regions shared by several edges are read once")
+    ("read-cache-megabytes", po::value(&opt.readCacheMegabytes)->default_value(opt.readCacheMegabytes),
+     "total size of the caches of decoded reads from recently scanned alignment regions, split evenly over all threads, 0 disables the cache")
+    ("locality-edge-order",
+     "process graph edges in the genomic order of their nodes, so that each bin covers a contiguous part of the genome")
+    ("bgzf-output",
+     "write each vcf output file sorted by position in BGZF-compressed format with a tabix index (filename + '.tbi'), "
+     "every bin or chunk file includes the vcf header")
     ;
 
     po::options_description help("help");
@@ -135,6 +164,10 @@ parseGSCOptions(const manta::Program& prog,
         usage(log_os,prog,visible);
     }
 
+    if (vm.count("prefetch-regions")) opt.isPrefetchRegions=true;
+    if (vm.count("locality-edge-order")) opt.isLocalityEdgeOrder=true;
+    if (vm.count("bgzf-output")) opt.isBgzfOutput=true;
+
     {
         // paste together tumor and normal:
         opt.alignmentFilename = normalAlignmentFilename;
@@ -155,6 +188,27 @@ parseGSCOptions(const manta::Program& prog,
     {
         usage(log_os,prog,visible,"bin-index must be in range [0,bin-count)");
     }
+    if (opt.threadCount < 1)
+    {
+        usage(log_os,prog,visible,"threads must be 1 or greater");
+    }
+    if (! opt.claimDir.empty())
+    {
+        if (opt.chunkCount < 1)
+        {
+            usage(log_os,prog,visible,"chunk-count must be 1 or greater in dynamic work mode");
+        }
+        if (! boost::filesystem::is_directory(opt.claimDir))
+        {
+            std::ostringstream oss;
+            oss << "Can't find claim directory '" << opt.claimDir << "'";
+            usage(log_os,prog,visible,oss.str().c_str());
+        }
+    }
+    if (opt.edgeBatchSize < 1)
+    {
+        usage(log_os,prog,visible,"edge-batch-size must be 1 or greater");
+    }
     if (opt.alignmentFilename.empty())
     {
         usage(log_os,prog,visible,"Must specify at least one input alignment file");
@@ -182,6 +236,14 @@ parseGSCOptions(const manta::Program& prog,
     {
         checkStandardizeUsageFile(log_os,prog,visible,opt.chromDepthFilename,"chromosome depth");
     }
+    if (! opt.depthIndexFilename.empty())
+    {
+        checkStandardizeUsageFile(log_os,prog,visible,opt.depthIndexFilename,"depth index");
+    }
+    if (! opt.edgeRuntimeFilename.empty())
+    {
+        checkStandardizeUsageFile(log_os,prog,visible,opt.edgeRuntimeFilename,"edge runtime");
+    }
     if (opt.candidateOutputFilename.empty())
     {
         usage(log_os,prog,visible,"Must specify candidate output file");
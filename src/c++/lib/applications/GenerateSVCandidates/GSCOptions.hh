@@ -30,7 +30,15 @@ struct GSCOptions
 {
     GSCOptions() :
         binCount(1),
-        binIndex(0)
+        binIndex(0),
+        decompressThreadCount(0),
+        isPrefetchRegions(false),
+        threadCount(1),
+        edgeBatchSize(1),
+        readCacheMegabytes(0),
+        isLocalityEdgeOrder(false),
+        chunkCount(0),
+        isBgzfOutput(false)
     {}
 
     ReadScannerOptions scanOpt;
@@ -43,12 +51,49 @@ struct GSCOptions
     std::string statsFilename;
     std::string chromDepthFilename;
 
+    /// binned max depth of the first non-tumor alignment file, written by EstimateSVLoci
+    std::string depthIndexFilename;
+
     std::string candidateOutputFilename;
     //std::string germlineOutputFilename;
     std::string somaticOutputFilename;
 
+    /// edge runtimes from a previous run, used to balance bins
+    std::string edgeRuntimeFilename;
+
+    /// write the runtime of each edge to this file
+    std::string edgeRuntimeOutputFilename;
+
     unsigned binCount;
     unsigned binIndex;
+
+    unsigned decompressThreadCount;
+
+    /// if true, read the bam regions for the next edge in the background while the current edge is processed
+    bool isPrefetchRegions;
+
+    /// number of threads processing graph edges, all threads share one copy of the graph
+    unsigned threadCount;
+
+    /// number of edges whose alignment regions are read together in a single sorted sweep
+    unsigned edgeBatchSize;
+
+    /// maximum total size of the decoded read caches of all threads, 0 disables the cache
+    unsigned readCacheMegabytes;
+
+    /// if true, visit edges in genomic order and build bins from contiguous parts of the genome
+    bool isLocalityEdgeOrder;
+
+    /// if set, run in dynamic work mode, where chunks of edges are claimed through files in this
+    /// directory shared by all processes, instead of solving a single static bin
+    std::string claimDir;
+
+    /// number of edge chunks in dynamic work mode
+    unsigned chunkCount;
+
+    /// if true, vcf output is position sorted, BGZF-compressed and tabix indexed, with each
+    /// output file written as a complete vcf file
+    bool isBgzfOutput;
 };
 
 
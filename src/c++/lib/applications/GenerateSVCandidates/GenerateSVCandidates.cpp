@@ -17,87 +17,1012 @@
 
 #include "GenerateSVCandidates.hh"
 #include "GSCOptions.hh"
+#include "EdgeCostModel.hh"
 #include "EdgeRetriever.hh"
 #include "SVFinder.hh"
 #include "SVScorer.hh"
 
+#include "blt_util/bgzf_vcf_writer.hh"
 #include "blt_util/log.hh"
 #include "common/OutStream.hh"
 #include "manta/ReadGroupStatsSet.hh"
 #include "format/VcfWriterCandidateSV.hh"
 #include "format/VcfWriterSomaticSV.hh"
 
+#include "boost/bind.hpp"
+#include "boost/filesystem.hpp"
+#include "boost/date_time/posix_time/posix_time_types.hpp"
+#include "boost/exception_ptr.hpp"
 #include "boost/foreach.hpp"
+#include "boost/scoped_ptr.hpp"
+#include "boost/thread/condition_variable.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/thread.hpp"
+#include "boost/utility.hpp"
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+
+
+/// path of the output file for one chunk of the graph edges in dynamic work mode
+static
+std::string
+getChunkFilename(
+    const std::string& filename,
+    const unsigned chunkIndex)
+{
+    std::ostringstream oss;
+    oss << filename << '.' << std::setw(5) << std::setfill('0') << chunkIndex;
+    return oss.str();
+}
+
+
+
+/// path of the claim file for one chunk in dynamic work mode
+static
+std::string
+getChunkClaimFilename(
+    const std::string& claimDir,
+    const unsigned chunkIndex)
+{
+    return getChunkFilename((boost::filesystem::path(claimDir) / "chunk").string(),chunkIndex);
+}
+
+
+
+/// path of the file marking the output of one chunk as complete in dynamic work mode
+static
+std::string
+getChunkDoneFilename(
+    const std::string& claimDir,
+    const unsigned chunkIndex)
+{
+    return getChunkClaimFilename(claimDir,chunkIndex)+".done";
+}
+
+
+
+/// claims chunks of the graph edges for this process in dynamic work mode
+///
+/// a chunk is claimed by atomically creating its claim file in a directory shared by
+/// all processes, so that each chunk is processed by exactly one process. Each process
+/// starts from its own section of the chunks and continues through the chunks of the
+/// other processes until all chunks are claimed.
+///
+/// each claim file is a hard link to an owner file for the claiming bin index, and a
+/// separate done file is written once the chunk output is complete. A process restarted
+/// after a failure first reclaims the chunks claimed under its bin index which were never
+/// completed, so that these are not lost.
+///
+struct ChunkClaimer : private boost::noncopyable
+{
+    ChunkClaimer(
+        const std::string& claimDir,
+        const unsigned chunkCount,
+        const unsigned startChunk,
+        const unsigned ownerIndex) :
+        _claimDir(claimDir),
+        _ownerFilename(getChunkFilename((boost::filesystem::path(claimDir) / "owner").string(),ownerIndex)),
+        _chunkCount(chunkCount),
+        _startChunk(startChunk),
+        _chunkOffset(0)
+    {
+        // the owner file is reused by a restarted process, so that its earlier claims can be identified:
+        const int fd(open(_ownerFilename.c_str(), (O_WRONLY | O_CREAT), 0644));
+        if (fd < 0)
+        {
+            log_os << "ERROR: Failed to create chunk owner file: " << _ownerFilename << "\n";
+            exit(EXIT_FAILURE);
+        }
+        ::close(fd);
+
+        for (unsigned chunkIndex(0); chunkIndex<_chunkCount; ++chunkIndex)
+        {
+            const std::string claimFile(getChunkClaimFilename(_claimDir,chunkIndex));
+            if (! boost::filesystem::exists(claimFile)) continue;
+            if (boost::filesystem::exists(getChunkDoneFilename(_claimDir,chunkIndex))) continue;
+            if (! boost::filesystem::equivalent(claimFile,_ownerFilename)) continue;
+            _reclaimedChunks.push_back(chunkIndex);
+        }
+    }
+
+    /// claim the next unclaimed chunk
+    ///
+    /// \returns false if all chunks are claimed
+    bool
+    next(unsigned& chunkIndex)
+    {
+        if (! _reclaimedChunks.empty())
+        {
+            chunkIndex = _reclaimedChunks.front();
+            _reclaimedChunks.pop_front();
+            return true;
+        }
+
+        while (_chunkOffset < _chunkCount)
+        {
+            chunkIndex = ((_startChunk+_chunkOffset) % _chunkCount);
+            _chunkOffset++;
+            if (claim(chunkIndex)) return true;
+        }
+        return false;
+    }
+
+private:
+    bool
+    claim(const unsigned chunkIndex) const
+    {
+        const std::string claimFile(getChunkClaimFilename(_claimDir,chunkIndex));
+        if (0 != link(_ownerFilename.c_str(), claimFile.c_str()))
+        {
+            if (EEXIST == errno) return false;
+            log_os << "ERROR: Failed to create chunk claim file: " << claimFile << "\n";
+            exit(EXIT_FAILURE);
+        }
+        return true;
+    }
+
+    const std::string _claimDir;
+    const std::string _ownerFilename;
+    const unsigned _chunkCount;
+    const unsigned _startChunk;
+    unsigned _chunkOffset;
+    std::deque<unsigned> _reclaimedChunks;
+};
+
+
+
+/// output files for the current chunk in dynamic work mode
+///
+/// files are written to a temporary name and moved to the final chunk filename once the chunk is complete
+///
+/// in BGZF output mode, vcf records of the chunk are buffered and sorted before they are written
+///
+struct ChunkOutput : private boost::noncopyable
+{
+    ChunkOutput(
+        const GSCOptions& opt,
+        const SVLocusSet& cset,
+        const char* progName,
+        const char* progVersion) :
+        _opt(opt),
+        _cset(cset),
+        _progName(progName),
+        _progVersion(progVersion),
+        _isOpen(false),
+        _chunkIndex(0)
+    {}
+
+    /// close the current chunk and start writing chunkIndex
+    void
+    open(const unsigned chunkIndex)
+    {
+        close();
+
+        _chunkIndex=chunkIndex;
+        if (_opt.isBgzfOutput)
+        {
+            _candss.str("");
+            _somss.str("");
+        }
+        else
+        {
+            openFile(_opt.candidateOutputFilename,_candfs);
+            if (isSomatic()) openFile(_opt.somaticOutputFilename,_somfs);
+        }
+        if (isRuntime()) openFile(_opt.edgeRuntimeOutputFilename,_runtimefs);
+        _isOpen=true;
+
+        // each indexed chunk is a complete vcf file:
+        if ((0 == _chunkIndex) || _opt.isBgzfOutput)
+        {
+            VcfWriterCandidateSV candWriter(_opt.referenceFilename,_cset,candStream());
+            candWriter.writeHeader(_progName, _progVersion);
+            if (isSomatic())
+            {
+                VcfWriterSomaticSV somWriter(_opt.somaticOpt, (! _opt.chromDepthFilename.empty()),
+                                             _opt.referenceFilename,_cset,somStream());
+                somWriter.writeHeader(_progName, _progVersion);
+            }
+        }
+    }
+
+    /// complete the current chunk, if any
+    void
+    close()
+    {
+        if (! _isOpen) return;
+        if (_opt.isBgzfOutput)
+        {
+            closeBgzfFile(_opt.candidateOutputFilename,_candss);
+            if (isSomatic()) closeBgzfFile(_opt.somaticOutputFilename,_somss);
+        }
+        else
+        {
+            closeFile(_opt.candidateOutputFilename,_candfs);
+            if (isSomatic()) closeFile(_opt.somaticOutputFilename,_somfs);
+        }
+        if (isRuntime()) closeFile(_opt.edgeRuntimeOutputFilename,_runtimefs);
+        markDone();
+        _isOpen=false;
+    }
+
+    std::ostream&
+    candStream()
+    {
+        if (_opt.isBgzfOutput) return _candss;
+        return _candfs;
+    }
+
+    std::ostream&
+    somStream()
+    {
+        if (_opt.isBgzfOutput) return _somss;
+        return _somfs;
+    }
+
+    std::ostream*
+    runtimeStream()
+    {
+        return (isRuntime() ? &_runtimefs : NULL);
+    }
+
+private:
+    bool
+    isSomatic() const
+    {
+        return (! _opt.somaticOutputFilename.empty());
+    }
+
+    bool
+    isRuntime() const
+    {
+        return (! _opt.edgeRuntimeOutputFilename.empty());
+    }
+
+    void
+    openFile(
+        const std::string& filename,
+        std::ofstream& ofs) const
+    {
+        const std::string tmpFilename(getChunkFilename(filename,_chunkIndex)+".tmp");
+        ofs.open(tmpFilename.c_str());
+        if (! ofs)
+        {
+            log_os << "ERROR: Failed to open chunk output file: " << tmpFilename << "\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    void
+    closeFile(
+        const std::string& filename,
+        std::ofstream& ofs) const
+    {
+        const std::string chunkFilename(getChunkFilename(filename,_chunkIndex));
+        ofs.close();
+        if (ofs.fail())
+        {
+            log_os << "ERROR: Failed to write chunk output file: " << chunkFilename << "\n";
+            exit(EXIT_FAILURE);
+        }
+        boost::filesystem::rename(chunkFilename+".tmp",chunkFilename);
+    }
+
+    /// mark the chunk complete after all of its output files are in place
+    void
+    markDone() const
+    {
+        const std::string doneFile(getChunkDoneFilename(_opt.claimDir,_chunkIndex));
+        const int fd(::open(doneFile.c_str(), (O_WRONLY | O_CREAT), 0644));
+        if (fd < 0)
+        {
+            log_os << "ERROR: Failed to create chunk done file: " << doneFile << "\n";
+            exit(EXIT_FAILURE);
+        }
+        ::close(fd);
+    }
+
+    /// sort the buffered vcf chunk and write it with its tabix index
+    void
+    closeBgzfFile(
+        const std::string& filename,
+        const std::ostringstream& oss) const
+    {
+        const std::string chunkFilename(getChunkFilename(filename,_chunkIndex));
+        write_sorted_bgzf_vcf(oss.str(),_cset.header,chunkFilename+".tmp",chunkFilename+".tmp.tbi");
+        boost::filesystem::rename(chunkFilename+".tmp.tbi",chunkFilename+".tbi");
+        boost::filesystem::rename(chunkFilename+".tmp",chunkFilename);
+    }
+
+    const GSCOptions& _opt;
+    const SVLocusSet& _cset;
+    const char* _progName;
+    const char* _progVersion;
+
+    bool _isOpen;
+    unsigned _chunkIndex;
+    std::ofstream _candfs;
+    std::ofstream _somfs;
+    std::ofstream _runtimefs;
+    std::ostringstream _candss;
+    std::ostringstream _somss;
+};
+
+
+
+/// write the output of each edge in edge sequence order, whatever order the edges complete in
+///
+/// in dynamic work mode, output is switched to the file of each chunk as its first edge is reached
+///
+/// output of edges completed ahead of the next edge in sequence is held in memory. To bound this,
+/// a worker writing an edge maxPendingEdges or more ahead of the next edge waits until the
+/// next edge has been written.
+///
+struct OrderedEdgeOutput : private boost::noncopyable
+{
+    /// \param runtimeos edge runtime output stream, no runtimes are written if this is null
+    OrderedEdgeOutput(
+        const unsigned long maxPendingEdges,
+        std::ostream& candos,
+        std::ostream& somos,
+        std::ostream* runtimeos) :
+        _maxPendingEdges(maxPendingEdges),
+        _candos(&candos),
+        _somos(&somos),
+        _runtimeos(runtimeos),
+        _chunkOutput(NULL),
+        _nextEdgeIndex(0),
+        _isStop(false)
+    {}
+
+    OrderedEdgeOutput(
+        const unsigned long maxPendingEdges,
+        ChunkOutput& chunkOutput) :
+        _maxPendingEdges(maxPendingEdges),
+        _candos(NULL),
+        _somos(NULL),
+        _runtimeos(NULL),
+        _chunkOutput(&chunkOutput),
+        _nextEdgeIndex(0),
+        _isStop(false)
+    {}
+
+    /// start a new chunk before edge firstEdgeIndex, chunks must be added in edge order
+    void
+    addChunk(
+        const unsigned long firstEdgeIndex,
+        const unsigned chunkIndex)
+    {
+        assert(NULL != _chunkOutput);
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        _chunkStarts.push_back(std::make_pair(firstEdgeIndex,chunkIndex));
+    }
+
+    /// write the output of edgeIndex, waiting first if edgeIndex is too far ahead of the next edge
+    ///
+    /// each worker writes the edges it holds in increasing order and edges are handed out in
+    /// increasing order, so the worker holding the next edge never waits here
+    void
+    write(
+        const unsigned long edgeIndex,
+        const std::string& candOutput,
+        const std::string& somOutput,
+        const std::string& runtimeOutput)
+    {
+        boost::unique_lock<boost::mutex> lock(_mutex);
+        while ((! _isStop) && (edgeIndex >= (_nextEdgeIndex+_maxPendingEdges)))
+        {
+            _writeCond.wait(lock);
+        }
+        if (_isStop) return;
+
+        EdgeOutput& output(_pending[edgeIndex]);
+        output.cand = candOutput;
+        output.som = somOutput;
+        output.runtime = runtimeOutput;
+
+        bool isWritten(false);
+        while ((! _pending.empty()) && (_pending.begin()->first == _nextEdgeIndex))
+        {
+            startChunks();
+
+            const pending_t::iterator iter(_pending.begin());
+            *_candos << iter->second.cand;
+            *_somos << iter->second.som;
+            if (NULL != _runtimeos) *_runtimeos << iter->second.runtime;
+            _pending.erase(iter);
+            _nextEdgeIndex++;
+            isWritten=true;
+        }
+
+        if (isWritten) _writeCond.notify_all();
+    }
+
+    /// release all waiting workers and discard any further output, used when a worker fails
+    void
+    stop()
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        _isStop=true;
+        _writeCond.notify_all();
+    }
+
+    /// complete the output of all chunks after the last edge has been written
+    void
+    finish()
+    {
+        if (NULL == _chunkOutput) return;
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        assert(_pending.empty());
+        startChunks();
+        _chunkOutput->close();
+    }
+
+private:
+    /// switch to the output of each chunk starting at the next edge, chunks without edges are
+    /// opened and closed in turn so that their files are still written
+    void
+    startChunks()
+    {
+        while ((! _chunkStarts.empty()) && (_chunkStarts.front().first == _nextEdgeIndex))
+        {
+            _chunkOutput->open(_chunkStarts.front().second);
+            _candos = &(_chunkOutput->candStream());
+            _somos = &(_chunkOutput->somStream());
+            _runtimeos = _chunkOutput->runtimeStream();
+            _chunkStarts.pop_front();
+        }
+    }
+
+    struct EdgeOutput
+    {
+        std::string cand;
+        std::string som;
+        std::string runtime;
+    };
+
+    typedef std::map<unsigned long, EdgeOutput> pending_t;
+
+    const unsigned long _maxPendingEdges;
+    boost::mutex _mutex;
+    boost::condition_variable _writeCond;
+    std::ostream* _candos;
+    std::ostream* _somos;
+    std::ostream* _runtimeos;
+    ChunkOutput* _chunkOutput;
+    std::deque<std::pair<unsigned long,unsigned> > _chunkStarts;
+    unsigned long _nextEdgeIndex;
+    bool _isStop;
+    pending_t _pending;
+};
+
+
+
+/// get the number of edges the output can run ahead of the next edge in sequence
+///
+/// each worker holds up to two batches of edges (the current and the look-ahead batch), the limit
+/// leaves room for twice this over all workers so that a single slow edge rarely stalls the others
+static
+unsigned long
+getMaxPendingEdges(const GSCOptions& opt)
+{
+    return (4ul*opt.threadCount*opt.edgeBatchSize);
+}
+
+
+
+/// edges to be solved by this process, shared by all edge processing threads
+///
+/// edges are numbered in retrieval order so that output can be written in the
+/// same order as a single threaded run
+///
+/// edges are either taken from a single static bin, or in dynamic work mode, from chunks
+/// claimed one at a time until all chunks of the graph have been claimed by some process
+///
+struct SharedEdgeQueue : private boost::noncopyable
+{
+    SharedEdgeQueue(
+        const SVLocusSet& set,
+        const unsigned binCount,
+        const unsigned binIndex,
+        const bool isLocalityOrder,
+        const EdgeCostModel& costModel) :
+        _edger(new EdgeRetriever(set, binCount, binIndex, isLocalityOrder, &costModel)),
+        _chunks(NULL),
+        _claimer(NULL),
+        _edgeOutput(NULL),
+        _edgeCount(0),
+        _isStop(false)
+    {}
+
+    /// \param chunks edges of each chunk
+    /// \param edgeOutput notified of the first edge of each chunk
+    SharedEdgeQueue(
+        const std::vector<std::vector<EdgeInfo> >& chunks,
+        ChunkClaimer& claimer,
+        OrderedEdgeOutput& edgeOutput) :
+        _chunks(&chunks),
+        _claimer(&claimer),
+        _edgeOutput(&edgeOutput),
+        _edgeCount(0),
+        _isStop(false)
+    {}
+
+    /// get up to maxEdgeCount edges, numbered consecutively from firstEdgeIndex
+    ///
+    /// \returns false if no edges remain or the queue has been stopped
+    bool
+    nextBatch(
+        const unsigned maxEdgeCount,
+        std::vector<EdgeInfo>& edges,
+        unsigned long& firstEdgeIndex)
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        edges.clear();
+        firstEdgeIndex = _edgeCount;
+        while ((edges.size() < maxEdgeCount) && (! _isStop))
+        {
+            if (_edger && _edger->next())
+            {
+                edges.push_back(_edger->getEdge());
+                _edgeCount++;
+                continue;
+            }
+
+            // static bins have no further edges:
+            if (NULL == _claimer) break;
+
+            unsigned chunkIndex(0);
+            if (! _claimer->next(chunkIndex)) break;
+            _edgeOutput->addChunk(_edgeCount,chunkIndex);
+            _edger.reset(new EdgeRetriever((*_chunks)[chunkIndex]));
+        }
+        return (! edges.empty());
+    }
 
+    /// stop handing out edges, used to end all threads early after an error
+    void
+    stop()
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        _isStop=true;
+    }
+
+private:
+    boost::mutex _mutex;
+    boost::scoped_ptr<EdgeRetriever> _edger;
+    const std::vector<std::vector<EdgeInfo> >* _chunks;
+    ChunkClaimer* _claimer;
+    OrderedEdgeOutput* _edgeOutput;
+    unsigned long _edgeCount;
+    bool _isStop;
+};
+
+
+
+/// first error from any edge processing thread
+struct EdgeThreadError : private boost::noncopyable
+{
+    void
+    set(const boost::exception_ptr& error)
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        if (! _error) _error = error;
+    }
+
+    /// rethrow the stored error, if any
+    void
+    rethrow() const
+    {
+        if (_error) boost::rethrow_exception(_error);
+    }
+
+private:
+    boost::mutex _mutex;
+    boost::exception_ptr _error;
+};
+
+
+
+typedef boost::posix_time::ptime ptime;
+
+
+
+/// get the current time if isTimed is set
+static
+ptime
+getTime(const bool isTimed)
+{
+    if (! isTimed) return ptime();
+    return boost::posix_time::microsec_clock::universal_time();
+}
 
 
 
+/// seconds elapsed since start
+static
+double
+getSeconds(const ptime& start)
+{
+    const boost::posix_time::time_duration elapsed(boost::posix_time::microsec_clock::universal_time()-start);
+    return (elapsed.total_microseconds()/1000000.);
+}
+
+
+
+/// read cache counts summed over all edge processing threads
+struct SharedReadCacheStats : private boost::noncopyable
+{
+    void
+    merge(const ReadWindowCacheStats& stats)
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        _stats.merge(stats);
+    }
+
+    const ReadWindowCacheStats&
+    getStats() const
+    {
+        return _stats;
+    }
+
+private:
+    boost::mutex _mutex;
+    ReadWindowCacheStats _stats;
+};
+
+
+
+/// find and score SVs for edges from edgeQueue until none remain
+///
+/// each call uses its own alignment file streams, so several calls can run in parallel
+/// over the same locus set
+///
 static
 void
-runGSC(
+processEdges(
     const GSCOptions& opt,
-    const char* progName,
-    const char* progVersion)
+    const SVLocusSet& cset,
+    const EdgeCostModel& costModel,
+    SharedEdgeQueue& edgeQueue,
+    OrderedEdgeOutput& edgeOutput,
+    SharedReadCacheStats& cacheStats)
 {
     const bool isSomatic(! opt.somaticOutputFilename.empty());
 
-    SVFinder svFind(opt);
-    const SVLocusSet& cset(svFind.getSet());
-
+    SVFinder svFind(opt,cset);
     SVScorer svScore(opt, cset.header);
 
-    EdgeRetriever edger(cset, opt.binCount, opt.binIndex);
+    const bool isRuntime(! opt.edgeRuntimeOutputFilename.empty());
 
-    OutStream candfs(opt.candidateOutputFilename);
-    OutStream somfs(opt.somaticOutputFilename);
+    std::ostringstream candss;
+    std::ostringstream somss;
+    std::ostringstream runtimess;
 
-    VcfWriterCandidateSV candWriter(opt.referenceFilename,cset,candfs.getStream());
+    VcfWriterCandidateSV candWriter(opt.referenceFilename,cset,candss);
     VcfWriterSomaticSV somWriter(opt.somaticOpt, (! opt.chromDepthFilename.empty()),
-                                 opt.referenceFilename,cset,somfs.getStream());
-
-    if (0 == opt.binIndex)
-    {
-        candWriter.writeHeader(progName, progVersion);
-        if (isSomatic) somWriter.writeHeader(progName, progVersion);
-    }
+                                 opt.referenceFilename,cset,somss);
 
-    SVCandidateData svData;
-    std::vector<SVCandidate> svs;
+    std::vector<SVCandidateData> svDataSet;
+    std::vector<std::vector<SVCandidate> > svsSet;
     SomaticSVScoreInfo ssInfo;
-    while (edger.next())
+    std::vector<EdgeInfo> edges;
+    std::vector<EdgeInfo> nextEdges;
+    unsigned long firstEdgeIndex(0);
+    unsigned long nextFirstEdgeIndex(0);
+    bool isEdge(edgeQueue.nextBatch(opt.edgeBatchSize,nextEdges,nextFirstEdgeIndex));
+    while (isEdge)
     {
-        const EdgeInfo& edge(edger.getEdge());
+        edges.swap(nextEdges);
+        firstEdgeIndex=nextFirstEdgeIndex;
+
+        // look one batch ahead so that its alignment regions can be read in the background:
+        isEdge=edgeQueue.nextBatch(opt.edgeBatchSize,nextEdges,nextFirstEdgeIndex);
+        if (isEdge && opt.isPrefetchRegions) svFind.prefetchEdges(nextEdges);
 
+        // find number, type and breakend range of SVs on all edges of the batch in one pass over the alignments:
+        const ptime findStart(getTime(isRuntime));
         try
         {
-            // find number, type and breakend range of SVs on this edge:
-            svFind.findCandidateSV(edge,svData,svs);
+            svFind.findCandidateSVBatch(edges,svDataSet,svsSet);
+        }
+        catch (...)
+        {
+            log_os << "Exception caught while processing graph component batch starting at: " << edges.front() << "\n";
+            throw;
+        }
+
+        // the batch search time is divided between its evaluated edges in proportion to estimated cost:
+        double findSeconds(0);
+        double totalFindCost(0);
+        if (isRuntime)
+        {
+            findSeconds = getSeconds(findStart);
+            BOOST_FOREACH(const EdgeInfo& edge, edges)
+            {
+                if (svFind.isEvaluatedEdge(edge)) totalFindCost += costModel.getEstimatedCost(edge);
+            }
+        }
 
-            candWriter.writeSV(edge, svData, svs);
+        const unsigned edgeCount(edges.size());
+        for (unsigned batchIndex(0); batchIndex<edgeCount; ++batchIndex)
+        {
+            const EdgeInfo& edge(edges[batchIndex]);
+            const SVCandidateData& svData(svDataSet[batchIndex]);
+            const std::vector<SVCandidate>& svs(svsSet[batchIndex]);
 
-            if (isSomatic)
+            candss.str("");
+            somss.str("");
+            runtimess.str("");
+
+            const ptime edgeStart(getTime(isRuntime));
+            try
             {
-                unsigned svIndex(0);
-                BOOST_FOREACH(const SVCandidate& sv, svs)
+                candWriter.writeSV(edge, svData, svs);
+
+                if (isSomatic)
                 {
-                    svScore.scoreSomaticSV(svData, svIndex, sv, ssInfo);
-                    somWriter.writeSV(edge, svData, svIndex, sv, ssInfo);
-                    svIndex++;
+                    if (opt.isPrefetchRegions)
+                    {
+                        BOOST_FOREACH(const SVCandidate& sv, svs)
+                        {
+                            svScore.prefetchSV(svData,sv);
+                        }
+                    }
+
+                    unsigned svIndex(0);
+                    BOOST_FOREACH(const SVCandidate& sv, svs)
+                    {
+                        svScore.scoreSomaticSV(svData, svIndex, sv, ssInfo);
+                        somWriter.writeSV(edge, svData, svIndex, sv, ssInfo);
+                        svIndex++;
+                    }
                 }
             }
+            catch (...)
+            {
+                log_os << "Exception caught while processing graph component: " << edge << "\n";
+                log_os << "\tnode1:" << cset.getLocus(edge.locusIndex).getNode(edge.nodeIndex1);
+                log_os << "\tnode2:" << cset.getLocus(edge.locusIndex).getNode(edge.nodeIndex2);
+
+                throw;
+            }
+
+            if (isRuntime)
+            {
+                double seconds(getSeconds(edgeStart));
+                if ((totalFindCost > 0) && svFind.isEvaluatedEdge(edge))
+                {
+                    seconds += (findSeconds*costModel.getEstimatedCost(edge))/totalFindCost;
+                }
+                costModel.writeMeasuredCost(runtimess,edge,seconds);
+            }
+
+            edgeOutput.write(firstEdgeIndex+batchIndex,candss.str(),somss.str(),runtimess.str());
         }
-        catch (...)
+    }
+
+    cacheStats.merge(svFind.getReadCacheStats());
+}
+
+
+
+/// thread wrapper for processEdges which stops all threads on the first error
+static
+void
+processEdgesThread(
+    const GSCOptions& opt,
+    const SVLocusSet& cset,
+    const EdgeCostModel& costModel,
+    SharedEdgeQueue& edgeQueue,
+    OrderedEdgeOutput& edgeOutput,
+    SharedReadCacheStats& cacheStats,
+    EdgeThreadError& threadError)
+{
+    try
+    {
+        processEdges(opt,cset,costModel,edgeQueue,edgeOutput,cacheStats);
+    }
+    catch (const std::exception& e)
+    {
+        // log the message here in case it is not preserved when the error is rethrown:
+        log_os << "ERROR: Exception in edge processing thread: " << e.what() << "\n";
+        threadError.set(boost::current_exception());
+        edgeQueue.stop();
+        edgeOutput.stop();
+    }
+    catch (...)
+    {
+        threadError.set(boost::current_exception());
+        edgeQueue.stop();
+        edgeOutput.stop();
+    }
+}
+
+
+
+/// process all edges from edgeQueue on opt.threadCount threads
+static
+void
+runEdges(
+    const GSCOptions& opt,
+    const SVLocusSet& cset,
+    const EdgeCostModel& costModel,
+    SharedEdgeQueue& edgeQueue,
+    OrderedEdgeOutput& edgeOutput)
+{
+    SharedReadCacheStats cacheStats;
+
+    if (1 == opt.threadCount)
+    {
+        processEdges(opt,cset,costModel,edgeQueue,edgeOutput,cacheStats);
+    }
+    else
+    {
+        EdgeThreadError threadError;
+        boost::thread_group workers;
+        for (unsigned threadIndex(0); threadIndex<opt.threadCount; ++threadIndex)
         {
-            log_os << "Exception caught while processing graph component: " << edge << "\n";
-            log_os << "\tnode1:" << cset.getLocus(edge.locusIndex).getNode(edge.nodeIndex1);
-            log_os << "\tnode2:" << cset.getLocus(edge.locusIndex).getNode(edge.nodeIndex2);
+            workers.create_thread(boost::bind(processEdgesThread,
+                                              boost::cref(opt),
+                                              boost::cref(cset),
+                                              boost::cref(costModel),
+                                              boost::ref(edgeQueue),
+                                              boost::ref(edgeOutput),
+                                              boost::ref(cacheStats),
+                                              boost::ref(threadError)));
+        }
+        workers.join_all();
 
-            throw;
+        threadError.rethrow();
+    }
+
+    if (opt.readCacheMegabytes > 0)
+    {
+        log_os << "INFO: decoded read cache " << cacheStats.getStats() << "\n";
+    }
+}
+
+
+
+/// solve the edges of one static bin
+///
+/// in BGZF output mode, vcf records of the bin are buffered and sorted before they are written
+///
+static
+void
+runStaticBin(
+    const GSCOptions& opt,
+    const SVLocusSet& cset,
+    const EdgeCostModel& costModel,
+    const char* progName,
+    const char* progVersion)
+{
+    const bool isSomatic(! opt.somaticOutputFilename.empty());
+
+    boost::scoped_ptr<OutStream> candfs;
+    boost::scoped_ptr<OutStream> somfs;
+    std::ostringstream candss;
+    std::ostringstream somss;
+    if (! opt.isBgzfOutput)
+    {
+        candfs.reset(new OutStream(opt.candidateOutputFilename));
+        somfs.reset(new OutStream(opt.somaticOutputFilename));
+    }
+    std::ostream& candos(opt.isBgzfOutput ? candss : candfs->getStream());
+    std::ostream& somos(opt.isBgzfOutput ? somss : somfs->getStream());
+
+    // each indexed bin is a complete vcf file:
+    if ((0 == opt.binIndex) || opt.isBgzfOutput)
+    {
+        VcfWriterCandidateSV candWriter(opt.referenceFilename,cset,candos);
+        candWriter.writeHeader(progName, progVersion);
+        if (isSomatic)
+        {
+            VcfWriterSomaticSV somWriter(opt.somaticOpt, (! opt.chromDepthFilename.empty()),
+                                         opt.referenceFilename,cset,somos);
+            somWriter.writeHeader(progName, progVersion);
         }
     }
 
+    std::ofstream runtimefs;
+    if (! opt.edgeRuntimeOutputFilename.empty())
+    {
+        runtimefs.open(opt.edgeRuntimeOutputFilename.c_str());
+        if (! runtimefs)
+        {
+            log_os << "ERROR: Failed to open edge runtime output file: " << opt.edgeRuntimeOutputFilename << "\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    SharedEdgeQueue edgeQueue(cset, opt.binCount, opt.binIndex, opt.isLocalityEdgeOrder, costModel);
+    OrderedEdgeOutput edgeOutput(getMaxPendingEdges(opt), candos, somos,
+                                 (runtimefs.is_open() ? &runtimefs : NULL));
+
+    runEdges(opt,cset,costModel,edgeQueue,edgeOutput);
+
+    if (opt.isBgzfOutput)
+    {
+        write_sorted_bgzf_vcf(candss.str(),cset.header,opt.candidateOutputFilename,opt.candidateOutputFilename+".tbi");
+        if (isSomatic)
+        {
+            write_sorted_bgzf_vcf(somss.str(),cset.header,opt.somaticOutputFilename,opt.somaticOutputFilename+".tbi");
+        }
+    }
+}
+
+
+
+/// claim and solve chunks of edges until all chunks of the graph are claimed
+static
+void
+runDynamicChunks(
+    const GSCOptions& opt,
+    const SVLocusSet& cset,
+    const EdgeCostModel& costModel,
+    const char* progName,
+    const char* progVersion)
+{
+    std::vector<std::vector<EdgeInfo> > chunks;
+    getEdgeBins(cset, opt.chunkCount, opt.isLocalityEdgeOrder, &costModel, chunks);
+
+    // start from this process's share of the chunks, to keep each process's work local
+    // unless it finishes early and steals chunks from the others:
+    const unsigned startChunk(static_cast<unsigned>((static_cast<unsigned long>(opt.chunkCount)*opt.binIndex)/opt.binCount));
+    ChunkClaimer claimer(opt.claimDir, opt.chunkCount, startChunk, opt.binIndex);
+
+    ChunkOutput chunkOutput(opt, cset, progName, progVersion);
+    OrderedEdgeOutput edgeOutput(getMaxPendingEdges(opt), chunkOutput);
+    SharedEdgeQueue edgeQueue(chunks, claimer, edgeOutput);
+
+    runEdges(opt,cset,costModel,edgeQueue,edgeOutput);
+
+    edgeOutput.finish();
+}
+
+
+
+static
+void
+runGSC(
+    const GSCOptions& opt,
+    const char* progName,
+    const char* progVersion)
+{
+    // the graph is loaded once and shared by all threads:
+    SVLocusSet cset;
+    cset.load(opt.graphFilename.c_str());
+
+    EdgeCostModel costModel(cset);
+    if (! opt.edgeRuntimeFilename.empty())
+    {
+        costModel.addMeasuredCosts(opt.edgeRuntimeFilename);
+    }
+
+    if (opt.claimDir.empty())
+    {
+        runStaticBin(opt,cset,costModel,progName,progVersion);
+    }
+    else
+    {
+        runDynamicChunks(opt,cset,costModel,progName,progVersion);
+    }
 }
 
 
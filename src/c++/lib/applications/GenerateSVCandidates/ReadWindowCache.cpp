@@ -0,0 +1,96 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+
+///
+/// \author Chris Saunders
+///
+
+#include "ReadWindowCache.hh"
+
+#include <iostream>
+
+
+
+std::ostream&
+operator<<(std::ostream& os, const ReadWindowCacheStats& stats)
+{
+    os << "hits: " << stats.hitCount
+       << " misses: " << stats.missCount
+       << " evictions: " << stats.evictCount;
+    return os;
+}
+
+
+
+/// approximate memory used by a decoded read
+static
+unsigned long
+getReadBytes(const bam_record& bamRead)
+{
+    return (sizeof(bam_record) + sizeof(bam1_t) + bamRead.get_data()->m_data);
+}
+
+
+
+const ReadWindowCache::window_t&
+ReadWindowCache::
+getWindow(
+    const unsigned bamIndex,
+    bam_streamer& readStream,
+    const int tid,
+    const int windowIndex)
+{
+    const WindowKey key(bamIndex,tid,windowIndex);
+    const index_t::iterator iter(_index.find(key));
+    if (iter != _index.end())
+    {
+        _stats.hitCount++;
+        _lru.splice(_lru.begin(),_lru,iter->second);
+        return _lru.front().reads;
+    }
+
+    _stats.missCount++;
+    _lru.push_front(WindowEntry(key));
+    _index[key] = _lru.begin();
+
+    WindowEntry& entry(_lru.front());
+    const int beginPos(windowIndex*static_cast<int>(_windowSize));
+    readStream.set_new_region(tid,beginPos,(beginPos+_windowSize));
+    while (readStream.next())
+    {
+        const bam_record& bamRead(*(readStream.get_record_ptr()));
+        entry.reads.push_back(bamRead);
+        entry.bytes += getReadBytes(entry.reads.back());
+    }
+    _totalBytes += entry.bytes;
+
+    evict();
+    return entry.reads;
+}
+
+
+
+void
+ReadWindowCache::
+evict()
+{
+    while ((_totalBytes > _maxBytes) && (_lru.size() > 1))
+    {
+        const WindowEntry& entry(_lru.back());
+        _totalBytes -= entry.bytes;
+        _index.erase(entry.key);
+        _lru.pop_back();
+        _stats.evictCount++;
+    }
+}
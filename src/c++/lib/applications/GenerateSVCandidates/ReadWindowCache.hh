@@ -0,0 +1,168 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+
+///
+/// \author Chris Saunders
+///
+
+#pragma once
+
+#include "blt_util/bam_record.hh"
+#include "blt_util/bam_streamer.hh"
+
+#include "boost/utility.hpp"
+
+#include <iosfwd>
+#include <list>
+#include <map>
+#include <vector>
+
+
+/// hit and miss counts for a ReadWindowCache
+struct ReadWindowCacheStats
+{
+    ReadWindowCacheStats() :
+        hitCount(0),
+        missCount(0),
+        evictCount(0)
+    {}
+
+    void
+    merge(const ReadWindowCacheStats& rhs)
+    {
+        hitCount += rhs.hitCount;
+        missCount += rhs.missCount;
+        evictCount += rhs.evictCount;
+    }
+
+    unsigned long hitCount;
+    unsigned long missCount;
+    unsigned long evictCount;
+};
+
+
+std::ostream&
+operator<<(std::ostream& os, const ReadWindowCacheStats& stats);
+
+
+
+/// memory bounded LRU cache of decoded reads from fixed size genome windows
+///
+/// each window holds all reads overlapping it, in alignment file order
+///
+struct ReadWindowCache : private boost::noncopyable
+{
+    typedef std::vector<bam_record> window_t;
+
+    /// \param maxBytes approximate maximum memory used by cached reads
+    /// \param windowSize size in bases of each window
+    ReadWindowCache(
+        const unsigned long maxBytes,
+        const unsigned windowSize = 16384) :
+        _maxBytes(maxBytes),
+        _windowSize(windowSize),
+        _totalBytes(0)
+    {}
+
+    unsigned
+    windowSize() const
+    {
+        return _windowSize;
+    }
+
+    /// true if window is in the cache, does not change the cache state
+    bool
+    isCached(
+        const unsigned bamIndex,
+        const int tid,
+        const int windowIndex) const
+    {
+        return (_index.find(WindowKey(bamIndex,tid,windowIndex)) != _index.end());
+    }
+
+    /// get all reads overlapping window windowIndex of tid, reads are taken from
+    /// readStream if the window is not cached
+    ///
+    /// the returned reads are valid until the next call to getWindow
+    const window_t&
+    getWindow(
+        const unsigned bamIndex,
+        bam_streamer& readStream,
+        const int tid,
+        const int windowIndex);
+
+    const ReadWindowCacheStats&
+    getStats() const
+    {
+        return _stats;
+    }
+
+private:
+
+    struct WindowKey
+    {
+        WindowKey(
+            const unsigned initBamIndex,
+            const int initTid,
+            const int initWindowIndex) :
+            bamIndex(initBamIndex),
+            tid(initTid),
+            windowIndex(initWindowIndex)
+        {}
+
+        bool
+        operator<(const WindowKey& rhs) const
+        {
+            if (bamIndex < rhs.bamIndex) return true;
+            if (bamIndex != rhs.bamIndex) return false;
+            if (tid < rhs.tid) return true;
+            if (tid != rhs.tid) return false;
+            return (windowIndex < rhs.windowIndex);
+        }
+
+        unsigned bamIndex;
+        int tid;
+        int windowIndex;
+    };
+
+    struct WindowEntry
+    {
+        WindowEntry(const WindowKey& initKey) :
+            key(initKey),
+            bytes(0)
+        {}
+
+        WindowKey key;
+        unsigned long bytes;
+        window_t reads;
+    };
+
+    typedef std::list<WindowEntry> lru_t;
+    typedef std::map<WindowKey,lru_t::iterator> index_t;
+
+    /// remove least recently used windows until the cache is within its size limit,
+    /// the most recently used window is always kept
+    void
+    evict();
+
+    const unsigned long _maxBytes;
+    const unsigned _windowSize;
+    unsigned long _totalBytes;
+
+    // most recently used windows are at the front:
+    lru_t _lru;
+    index_t _index;
+
+    ReadWindowCacheStats _stats;
+};
@@ -0,0 +1,470 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+///
+/// \author Chris Saunders
+///
+
+#include "SVCandidateCluster.hh"
+
+#include "boost/foreach.hpp"
+
+#include <algorithm>
+#include <map>
+
+
+
+/// a cluster of candidates with its breakends in canonical order
+struct CandidateCluster
+{
+    CandidateCluster() :
+        firstCandIndex(0),
+        isFirstSwapped(false),
+        rootIndex(0)
+    {}
+
+    SVCandidate sv;
+
+    /// the lowest candidate index in the cluster
+    unsigned firstCandIndex;
+
+    /// true if the breakends of the first candidate were swapped into canonical order
+    bool isFirstSwapped;
+
+    /// the candidate index representing this cluster in the candidate union-find forest
+    unsigned rootIndex;
+};
+
+
+
+/// order clusters by breakend orientation and chromosome, then by first breakend start
+static
+bool
+isClusterSweepLess(
+    const CandidateCluster& lhs,
+    const CandidateCluster& rhs)
+{
+    const SVBreakend& lbp1(lhs.sv.bp1);
+    const SVBreakend& rbp1(rhs.sv.bp1);
+    const SVBreakend& lbp2(lhs.sv.bp2);
+    const SVBreakend& rbp2(rhs.sv.bp2);
+    if (lbp1.state != rbp1.state) return (lbp1.state < rbp1.state);
+    if (lbp1.interval.tid != rbp1.interval.tid) return (lbp1.interval.tid < rbp1.interval.tid);
+    if (lbp2.state != rbp2.state) return (lbp2.state < rbp2.state);
+    if (lbp2.interval.tid != rbp2.interval.tid) return (lbp2.interval.tid < rbp2.interval.tid);
+    if (lbp1.interval.range.begin_pos() != rbp1.interval.range.begin_pos())
+    {
+        return (lbp1.interval.range.begin_pos() < rbp1.interval.range.begin_pos());
+    }
+    return (lhs.firstCandIndex < rhs.firstCandIndex);
+}
+
+
+
+/// can clusters intersect, based on breakend orientation and chromosome?
+static
+bool
+isSameSweep(
+    const CandidateCluster& lhs,
+    const CandidateCluster& rhs)
+{
+    return ((lhs.sv.bp1.state == rhs.sv.bp1.state) &&
+            (lhs.sv.bp1.interval.tid == rhs.sv.bp1.interval.tid) &&
+            (lhs.sv.bp2.state == rhs.sv.bp2.state) &&
+            (lhs.sv.bp2.interval.tid == rhs.sv.bp2.interval.tid));
+}
+
+
+
+static
+unsigned
+findRoot(
+    std::vector<unsigned>& candParent,
+    unsigned candIndex)
+{
+    unsigned root(candIndex);
+    while (candParent[root] != root) root=candParent[root];
+
+    // compress the path to root:
+    while (candParent[candIndex] != root)
+    {
+        const unsigned next(candParent[candIndex]);
+        candParent[candIndex]=root;
+        candIndex=next;
+    }
+    return root;
+}
+
+
+
+/// merge all intersecting clusters found in one sweep
+///
+/// Clusters which are active at a sweep position all overlap it on the first breakend, so any
+/// two active clusters with intersecting second breakends are merged when the later one is
+/// added. The active clusters therefore have disjoint second breakend ranges, and those
+/// intersecting a new cluster form a contiguous run in second breakend order.
+///
+/// \returns true if any clusters were merged
+///
+static
+bool
+mergeIntersectingClusters(
+    std::vector<unsigned>& candParent,
+    std::vector<CandidateCluster>& clusters)
+{
+    std::sort(clusters.begin(),clusters.end(),isClusterSweepLess);
+
+    typedef std::multimap<pos_t,unsigned> active_t;
+
+    // active clusters keyed on second breakend start and first breakend end:
+    active_t activeBp2;
+    active_t activeBp1End;
+
+    const unsigned clusterCount(clusters.size());
+    std::vector<active_t::iterator> bp2Iter(clusterCount);
+    std::vector<active_t::iterator> bp1EndIter(clusterCount);
+    std::vector<bool> isMerged(clusterCount,false);
+    bool isAnyMerged(false);
+
+    for (unsigned clusterIndex(0); clusterIndex<clusterCount; ++clusterIndex)
+    {
+        CandidateCluster& cluster(clusters[clusterIndex]);
+        if ((clusterIndex>0) && (! isSameSweep(clusters[clusterIndex-1],cluster)))
+        {
+            activeBp2.clear();
+            activeBp1End.clear();
+        }
+
+        // retire clusters ending before the sweep position:
+        const pos_t sweepPos(cluster.sv.bp1.interval.range.begin_pos());
+        while ((! activeBp1End.empty()) && (activeBp1End.begin()->first <= sweepPos))
+        {
+            activeBp2.erase(bp2Iter[activeBp1End.begin()->second]);
+            activeBp1End.erase(activeBp1End.begin());
+        }
+
+        // find the first active cluster which could intersect on the second breakend:
+        const known_pos_range2& bp2Range(cluster.sv.bp2.interval.range);
+        active_t::iterator iter(activeBp2.upper_bound(bp2Range.begin_pos()));
+        if (iter != activeBp2.begin())
+        {
+            --iter;
+            if (clusters[iter->second].sv.bp2.interval.range.end_pos() <= bp2Range.begin_pos()) ++iter;
+        }
+
+        while ((iter != activeBp2.end()) && (iter->first < bp2Range.end_pos()))
+        {
+            const unsigned mergeIndex(iter->second);
+            CandidateCluster& mergeCluster(clusters[mergeIndex]);
+
+            // both breakends are known to intersect at this point:
+            cluster.sv.merge(mergeCluster.sv);
+            if (mergeCluster.firstCandIndex < cluster.firstCandIndex)
+            {
+                cluster.firstCandIndex = mergeCluster.firstCandIndex;
+                cluster.isFirstSwapped = mergeCluster.isFirstSwapped;
+            }
+            candParent[mergeCluster.rootIndex] = cluster.rootIndex;
+
+            isMerged[mergeIndex] = true;
+            isAnyMerged = true;
+            activeBp1End.erase(bp1EndIter[mergeIndex]);
+            activeBp2.erase(iter++);
+        }
+
+        bp2Iter[clusterIndex] = activeBp2.insert(std::make_pair(bp2Range.begin_pos(),clusterIndex));
+        bp1EndIter[clusterIndex] = activeBp1End.insert(std::make_pair(cluster.sv.bp1.interval.range.end_pos(),clusterIndex));
+    }
+
+    if (! isAnyMerged) return false;
+
+    unsigned keepCount(0);
+    for (unsigned clusterIndex(0); clusterIndex<clusterCount; ++clusterIndex)
+    {
+        if (isMerged[clusterIndex]) continue;
+        if (keepCount != clusterIndex) clusters[keepCount] = clusters[clusterIndex];
+        keepCount++;
+    }
+    clusters.resize(keepCount);
+    return true;
+}
+
+
+
+/// can the breakends of a cluster also match another cluster's breakends in crossed order?
+static
+bool
+isSymmetricCluster(const CandidateCluster& cluster)
+{
+    return ((cluster.sv.bp1.state == cluster.sv.bp2.state) &&
+            (cluster.sv.bp1.interval.tid == cluster.sv.bp2.interval.tid));
+}
+
+
+
+/// one breakend order of a symmetric cluster in the crossed match sweep
+///
+/// the sweep runs over the first breakend of an entry, each cluster is added once
+/// in its own order and once with its breakends swapped (the mirror entry)
+struct CrossedSweepEntry
+{
+    bool
+    operator<(const CrossedSweepEntry& rhs) const
+    {
+        if (state != rhs.state) return (state < rhs.state);
+        if (tid != rhs.tid) return (tid < rhs.tid);
+        if (sweepRange.begin_pos() != rhs.sweepRange.begin_pos())
+        {
+            return (sweepRange.begin_pos() < rhs.sweepRange.begin_pos());
+        }
+        if (clusterIndex != rhs.clusterIndex) return (clusterIndex < rhs.clusterIndex);
+        return (isMirror < rhs.isMirror);
+    }
+
+    SVBreakendState::index_t state;
+    int tid;
+    known_pos_range2 sweepRange;
+    known_pos_range2 matchRange;
+    unsigned clusterIndex;
+    bool isMirror;
+};
+
+
+
+/// merge symmetric clusters whose breakends intersect in crossed order
+///
+/// this completes mergeIntersectingClusters, which only compares breakends in the same
+/// canonical order. A crossed match of two clusters is a direct match of one cluster's
+/// entry with the other's mirror entry, so each entry is looked up among the active
+/// entries of the opposite kind. The sweep is only run once no clusters intersect
+/// directly, so active entries of each kind have disjoint match ranges and the entries
+/// intersecting a lookup form a contiguous run, as in the direct sweep.
+///
+/// once a cluster has been merged its entries are dropped from the rest of the sweep,
+/// so the sweep is repeated while it continues to merge clusters.
+///
+/// \returns true if any clusters were merged
+///
+static
+bool
+mergeCrossedClusters(
+    std::vector<unsigned>& candParent,
+    std::vector<CandidateCluster>& clusters)
+{
+    const unsigned clusterCount(clusters.size());
+
+    std::vector<CrossedSweepEntry> entries;
+    for (unsigned clusterIndex(0); clusterIndex<clusterCount; ++clusterIndex)
+    {
+        const CandidateCluster& cluster(clusters[clusterIndex]);
+        if (! isSymmetricCluster(cluster)) continue;
+
+        CrossedSweepEntry entry;
+        entry.state = cluster.sv.bp1.state;
+        entry.tid = cluster.sv.bp1.interval.tid;
+        entry.clusterIndex = clusterIndex;
+        entry.sweepRange = cluster.sv.bp1.interval.range;
+        entry.matchRange = cluster.sv.bp2.interval.range;
+        entry.isMirror = false;
+        entries.push_back(entry);
+        std::swap(entry.sweepRange,entry.matchRange);
+        entry.isMirror = true;
+        entries.push_back(entry);
+    }
+    if (entries.empty()) return false;
+
+    std::sort(entries.begin(),entries.end());
+
+    typedef std::multimap<pos_t,unsigned> active_t;
+
+    // active entries of each kind keyed on match range start, and all active entries keyed on sweep range end:
+    active_t activeMatch[2];
+    active_t activeSweepEnd;
+
+    const unsigned entryCount(entries.size());
+    std::vector<active_t::iterator> matchIter(entryCount);
+    std::vector<active_t::iterator> sweepEndIter(entryCount);
+    std::vector<bool> isActive(entryCount,false);
+
+    // the active entries of each cluster:
+    std::vector<std::vector<unsigned> > clusterEntries(clusterCount);
+
+    // clusters which have been merged in this sweep, either as the target or the source:
+    std::vector<bool> isMergeCluster(clusterCount,false);
+    std::vector<bool> isMerged(clusterCount,false);
+    bool isAnyMerged(false);
+
+    std::vector<unsigned> matchClusters;
+    for (unsigned entryIndex(0); entryIndex<entryCount; ++entryIndex)
+    {
+        const CrossedSweepEntry& entry(entries[entryIndex]);
+        if ((entryIndex>0) &&
+            ((entries[entryIndex-1].state != entry.state) || (entries[entryIndex-1].tid != entry.tid)))
+        {
+            activeMatch[0].clear();
+            activeMatch[1].clear();
+            activeSweepEnd.clear();
+        }
+
+        // retire entries ending before the sweep position:
+        const pos_t sweepPos(entry.sweepRange.begin_pos());
+        while ((! activeSweepEnd.empty()) && (activeSweepEnd.begin()->first <= sweepPos))
+        {
+            const unsigned retireIndex(activeSweepEnd.begin()->second);
+            activeMatch[entries[retireIndex].isMirror].erase(matchIter[retireIndex]);
+            activeSweepEnd.erase(activeSweepEnd.begin());
+            isActive[retireIndex]=false;
+        }
+
+        if (isMergeCluster[entry.clusterIndex]) continue;
+
+        // find active entries of the other kind which intersect on the match range:
+        active_t& otherMatch(activeMatch[! entry.isMirror]);
+        active_t::iterator iter(otherMatch.upper_bound(entry.matchRange.begin_pos()));
+        if (iter != otherMatch.begin())
+        {
+            --iter;
+            if (entries[iter->second].matchRange.end_pos() <= entry.matchRange.begin_pos()) ++iter;
+        }
+
+        matchClusters.clear();
+        for (; (iter != otherMatch.end()) && (iter->first < entry.matchRange.end_pos()); ++iter)
+        {
+            const unsigned matchClusterIndex(entries[iter->second].clusterIndex);
+            if (matchClusterIndex == entry.clusterIndex) continue;
+            matchClusters.push_back(matchClusterIndex);
+        }
+
+        if (matchClusters.empty())
+        {
+            matchIter[entryIndex] = activeMatch[entry.isMirror].insert(std::make_pair(entry.matchRange.begin_pos(),entryIndex));
+            sweepEndIter[entryIndex] = activeSweepEnd.insert(std::make_pair(entry.sweepRange.end_pos(),entryIndex));
+            isActive[entryIndex] = true;
+            clusterEntries[entry.clusterIndex].push_back(entryIndex);
+            continue;
+        }
+
+        CandidateCluster& cluster(clusters[entry.clusterIndex]);
+        matchClusters.push_back(entry.clusterIndex);
+        BOOST_FOREACH(const unsigned matchClusterIndex, matchClusters)
+        {
+            // drop the active entries of all clusters in the merge from the sweep:
+            isMergeCluster[matchClusterIndex] = true;
+            BOOST_FOREACH(const unsigned clusterEntryIndex, clusterEntries[matchClusterIndex])
+            {
+                if (! isActive[clusterEntryIndex]) continue;
+                activeMatch[entries[clusterEntryIndex].isMirror].erase(matchIter[clusterEntryIndex]);
+                activeSweepEnd.erase(sweepEndIter[clusterEntryIndex]);
+                isActive[clusterEntryIndex] = false;
+            }
+            if (matchClusterIndex == entry.clusterIndex) continue;
+
+            CandidateCluster& mergeCluster(clusters[matchClusterIndex]);
+
+            // SVCandidate::merge uses the crossed breakend order only if the direct order does not intersect:
+            const bool isCrossed(! (cluster.sv.bp1.isIntersect(mergeCluster.sv.bp1) &&
+                                    cluster.sv.bp2.isIntersect(mergeCluster.sv.bp2)));
+            cluster.sv.merge(mergeCluster.sv);
+            if (mergeCluster.firstCandIndex < cluster.firstCandIndex)
+            {
+                cluster.firstCandIndex = mergeCluster.firstCandIndex;
+                cluster.isFirstSwapped = (mergeCluster.isFirstSwapped != isCrossed);
+            }
+            candParent[mergeCluster.rootIndex] = cluster.rootIndex;
+
+            isMerged[matchClusterIndex] = true;
+            isAnyMerged = true;
+        }
+
+        // restore canonical breakend order:
+        if (cluster.sv.bp2 < cluster.sv.bp1)
+        {
+            std::swap(cluster.sv.bp1,cluster.sv.bp2);
+            cluster.isFirstSwapped = (! cluster.isFirstSwapped);
+        }
+    }
+
+    if (! isAnyMerged) return false;
+
+    unsigned keepCount(0);
+    for (unsigned clusterIndex(0); clusterIndex<clusterCount; ++clusterIndex)
+    {
+        if (isMerged[clusterIndex]) continue;
+        if (keepCount != clusterIndex) clusters[keepCount] = clusters[clusterIndex];
+        keepCount++;
+    }
+    clusters.resize(keepCount);
+    return true;
+}
+
+
+
+static
+bool
+isFirstCandLess(
+    const CandidateCluster& lhs,
+    const CandidateCluster& rhs)
+{
+    return (lhs.firstCandIndex < rhs.firstCandIndex);
+}
+
+
+
+void
+clusterSVCandidates(
+    const std::vector<SVCandidate>& cands,
+    std::vector<unsigned>& candSVIndex,
+    std::vector<SVCandidate>& svs)
+{
+    const unsigned candCount(cands.size());
+
+    std::vector<unsigned> candParent(candCount);
+    std::vector<CandidateCluster> clusters(candCount);
+    for (unsigned candIndex(0); candIndex<candCount; ++candIndex)
+    {
+        candParent[candIndex] = candIndex;
+
+        CandidateCluster& cluster(clusters[candIndex]);
+        cluster.sv = cands[candIndex];
+        cluster.firstCandIndex = candIndex;
+        cluster.rootIndex = candIndex;
+        cluster.isFirstSwapped = (cluster.sv.bp2 < cluster.sv.bp1);
+        if (cluster.isFirstSwapped) std::swap(cluster.sv.bp1,cluster.sv.bp2);
+    }
+
+    // sweeps without merges in either breakend order show that no two clusters intersect:
+    do
+    {
+        while (mergeIntersectingClusters(candParent,clusters)) {}
+    }
+    while (mergeCrossedClusters(candParent,clusters));
+
+    std::sort(clusters.begin(),clusters.end(),isFirstCandLess);
+
+    const unsigned svCount(clusters.size());
+    svs.resize(svCount);
+    std::vector<unsigned> rootSVIndex(candCount,0);
+    for (unsigned svIndex(0); svIndex<svCount; ++svIndex)
+    {
+        const CandidateCluster& cluster(clusters[svIndex]);
+        svs[svIndex] = cluster.sv;
+        if (cluster.isFirstSwapped) std::swap(svs[svIndex].bp1,svs[svIndex].bp2);
+        rootSVIndex[cluster.rootIndex] = svIndex;
+    }
+
+    candSVIndex.resize(candCount);
+    for (unsigned candIndex(0); candIndex<candCount; ++candIndex)
+    {
+        candSVIndex[candIndex] = rootSVIndex[findRoot(candParent,candIndex)];
+    }
+}
@@ -0,0 +1,45 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+///
+/// \author Chris Saunders
+///
+
+#pragma once
+
+#include "manta/SVCandidate.hh"
+
+#include <vector>
+
+
+/// cluster the single read pair candidates of an edge into SV hypotheses
+///
+/// Candidates are merged when their breakends intersect, either directly or through the
+/// growing breakend ranges of the clusters they have joined, until no two clusters intersect.
+/// Clusters are found with a sweep over the first breakend of each candidate, split by the
+/// orientation and chromosome of both breakends, so the cost is O(n log n) per sweep and
+/// the sweep is repeated only while it continues to merge clusters. When both breakends share
+/// orientation and chromosome, candidates can also intersect in crossed breakend order, and
+/// these are found by a second sweep in which each candidate is also looked up with its
+/// breakends swapped.
+///
+/// \param[in] cands the candidate from each read pair
+/// \param[out] candSVIndex the index in svs of each candidate's cluster
+/// \param[out] svs clustered candidates, ordered by the first candidate in each cluster. The
+///                 breakend order of each cluster follows that of its first candidate.
+///
+void
+clusterSVCandidates(
+    const std::vector<SVCandidate>& cands,
+    std::vector<unsigned>& candSVIndex,
+    std::vector<SVCandidate>& svs);
@@ -16,7 +16,9 @@
 ///
 
 #include "SVFinder.hh"
+#include "SVCandidateCluster.hh"
 
+#include "blt_util/align_path_bam_util.hh"
 #include "blt_util/bam_streamer.hh"
 #include "blt_util/log.hh"
 #include "common/Exceptions.hh"
@@ -24,6 +26,9 @@
 
 #include "boost/foreach.hpp"
 
+#include <cstring>
+
+#include <algorithm>
 #include <iostream>
 
 
@@ -33,103 +38,403 @@ static const bool isExcludeUnpaired(true);
 
 
 SVFinder::
-SVFinder(const GSCOptions& opt) :
+SVFinder(
+    const GSCOptions& opt,
+    const SVLocusSet& set) :
     _scanOpt(opt.scanOpt),
-    _readScanner(_scanOpt,opt.statsFilename,opt.alignmentFilename)
+    _set(set),
+    _readScanner(_scanOpt,opt.statsFilename,opt.alignmentFilename),
+    _isCollectDepth(false),
+    _depthBamIndex(0)
 {
-    // load in set:
-    _set.load(opt.graphFilename.c_str());
-
     // setup regionless bam_streams:
     // setup all data for main analysis loop:
     BOOST_FOREACH(const std::string& afile, opt.alignmentFilename)
     {
         // avoid creating shared_ptr temporaries:
-        streamPtr tmp(new bam_streamer(afile.c_str()));
+        streamPtr tmp(new bam_streamer(afile.c_str(),NULL,opt.decompressThreadCount));
         _bamStreams.push_back(tmp);
     }
+
+    // somatic scoring needs breakend depth from the first non-tumor alignment file, which is
+    // collected here unless the scorer can read it from a depth index:
+    if ((! opt.somaticOutputFilename.empty()) && opt.depthIndexFilename.empty())
+    {
+        const unsigned bamCount(opt.alignmentFilename.size());
+        for (unsigned bamIndex(0); bamIndex<bamCount; ++bamIndex)
+        {
+            if (opt.isAlignmentTumor[bamIndex]) continue;
+            _isCollectDepth=true;
+            _depthBamIndex=bamIndex;
+            break;
+        }
+    }
+
+    // the cache size option is the budget of the whole process, split evenly over the finder of each thread:
+    if (opt.readCacheMegabytes > 0)
+    {
+        const unsigned long cacheBytes(static_cast<unsigned long>(opt.readCacheMegabytes) << 20);
+        _readCache.reset(new ReadWindowCache(cacheBytes/std::max(1u,opt.threadCount)));
+    }
 }
 
 
 
-// test if read supports an SV on this edge, if so, add to SVData
+/// get the region scanned for reads supporting a breakend in node
 static
+GenomeInterval
+getNodeSearchInterval(const SVLocusNode& node)
+{
+    GenomeInterval searchInterval(node.interval);
+    searchInterval.range.merge_range(node.evidenceRange);
+    return searchInterval;
+}
+
+
+
+bool
+SVFinder::
+isEvaluatedEdge(const EdgeInfo& edge) const
+{
+    const SVLocusSet& set(getSet());
+    const unsigned minEdgeCount(set.getMinMergeEdgeCount());
+
+    // edge must be bidirectional at the noise threshold of the locus set:
+    const SVLocus& locus(set.getLocus(edge.locusIndex));
+
+    return ((locus.getEdge(edge.nodeIndex1,edge.nodeIndex2).count > minEdgeCount) &&
+            (locus.getEdge(edge.nodeIndex2,edge.nodeIndex1).count > minEdgeCount));
+}
+
+
+
 void
-addSVNodeRead(
+SVFinder::
+getNodeSearches(
+    const std::vector<EdgeInfo>& edges,
+    std::vector<NodeSearch>& searches) const
+{
+    searches.clear();
+
+    const unsigned bamCount(_bamStreams.size());
+    const unsigned edgeCount(edges.size());
+    for (unsigned edgeIndex(0); edgeIndex<edgeCount; ++edgeIndex)
+    {
+        const EdgeInfo& edge(edges[edgeIndex]);
+        if (! isEvaluatedEdge(edge)) continue;
+
+        const SVLocus& locus(getSet().getLocus(edge.locusIndex));
+
+        // search the first node of each edge first, to match the order in which
+        // evidence is added to the edge's SVCandidateData:
+        for (unsigned nodeSearchIndex(0); nodeSearchIndex<2; ++nodeSearchIndex)
+        {
+            const bool isFirst(0 == nodeSearchIndex);
+            searches.resize(searches.size()+1);
+            NodeSearch& search(searches.back());
+            search.edgeIndex = edgeIndex;
+            search.localNode = &(locus.getNode(isFirst ? edge.nodeIndex1 : edge.nodeIndex2));
+            search.remoteNode = &(locus.getNode(isFirst ? edge.nodeIndex2 : edge.nodeIndex1));
+            search.searchInterval = getNodeSearchInterval(*(search.localNode));
+            search.reads.resize(bamCount);
+        }
+    }
+}
+
+
+
+void
+SVFinder::
+getSweepIntervals(
+    const std::vector<NodeSearch>& searches,
+    std::vector<unsigned>& searchOrder,
+    std::vector<SweepInterval>& sweeps)
+{
+    searchOrder.clear();
+    sweeps.clear();
+
+    // sort searches by interval, ties are kept in search order:
+    typedef std::pair<GenomeInterval,unsigned> interval_index_t;
+    std::vector<interval_index_t> sortedSearches;
+    const unsigned searchCount(searches.size());
+    for (unsigned searchIndex(0); searchIndex<searchCount; ++searchIndex)
+    {
+        sortedSearches.push_back(std::make_pair(searches[searchIndex].searchInterval,searchIndex));
+    }
+    std::sort(sortedSearches.begin(),sortedSearches.end());
+    BOOST_FOREACH(const interval_index_t& val, sortedSearches)
+    {
+        searchOrder.push_back(val.second);
+    }
+
+    // coalesce overlapping or adjacent search intervals:
+    for (unsigned orderIndex(0); orderIndex<searchCount; ++orderIndex)
+    {
+        const GenomeInterval& interval(searches[searchOrder[orderIndex]].searchInterval);
+        if ((! sweeps.empty()) &&
+            (sweeps.back().interval.tid == interval.tid) &&
+            (sweeps.back().interval.range.end_pos() >= interval.range.begin_pos()))
+        {
+            SweepInterval& sweep(sweeps.back());
+            sweep.interval.range.set_end_pos(std::max(sweep.interval.range.end_pos(),interval.range.end_pos()));
+            sweep.searchEnd = (orderIndex+1);
+        }
+        else
+        {
+            sweeps.resize(sweeps.size()+1);
+            SweepInterval& sweep(sweeps.back());
+            sweep.interval = interval;
+            sweep.searchBegin = orderIndex;
+            sweep.searchEnd = (orderIndex+1);
+        }
+    }
+}
+
+
+
+void
+SVFinder::
+prefetchEdges(const std::vector<EdgeInfo>& edges)
+{
+    std::vector<NodeSearch> searches;
+    getNodeSearches(edges,searches);
+
+    std::vector<unsigned> searchOrder;
+    std::vector<SweepInterval> sweeps;
+    getSweepIntervals(searches,searchOrder,sweeps);
+
+    // queue regions in the order addSweepData will request them:
+    unsigned bamIndex(0);
+    BOOST_FOREACH(streamPtr& bamPtr, _bamStreams)
+    {
+        BOOST_FOREACH(const SweepInterval& sweep, sweeps)
+        {
+            const GenomeInterval& interval(sweep.interval);
+            if (! _readCache)
+            {
+                bamPtr->prefetch_region(interval.tid,interval.range.begin_pos(),interval.range.end_pos());
+                continue;
+            }
+
+            // only windows which are not already cached need to be read:
+            const int windowSize(_readCache->windowSize());
+            const int beginWindow(std::max(0,interval.range.begin_pos())/windowSize);
+            const int endWindow((interval.range.end_pos()-1)/windowSize);
+            for (int windowIndex(beginWindow); windowIndex<=endWindow; ++windowIndex)
+            {
+                if (_readCache->isCached(bamIndex,interval.tid,windowIndex)) continue;
+                bamPtr->prefetch_region(interval.tid,(windowIndex*windowSize),((windowIndex+1)*windowSize));
+            }
+        }
+        bamIndex++;
+    }
+}
+
+
+
+/// test if read could support an SV, if so get the read's SV locus
+///
+/// \returns false if the read can't support any SV
+static
+bool
+getReadSVLocus(
     const SVLocusScanner& scanner,
-    const SVLocusNode& localNode,
-    const SVLocusNode& remoteNode,
     const bam_record& bamRead,
     const unsigned bamIndex,
-    SVCandidateDataGroup& svDataGroup)
+    SVLocus& locus,
+    unsigned& readLocalIndex,
+    unsigned& readRemoteIndex)
 {
-    if (scanner.isReadFiltered(bamRead)) return;
-    if (scanner.isProperPair(bamRead,bamIndex)) return;
-    if (bamRead.is_mate_unmapped()) return;
+    if (scanner.isReadFiltered(bamRead)) return false;
+    if (scanner.isProperPair(bamRead,bamIndex)) return false;
+    if (bamRead.is_mate_unmapped()) return false;
 
-    SVLocus locus;
     scanner.getSVLocus(bamRead,bamIndex,locus);
     const SVLocus& clocus(locus);
 
-    if (clocus.empty()) return;
-    if (2 != clocus.size()) return;
+    if (clocus.empty()) return false;
+    if (2 != clocus.size()) return false;
 
-    unsigned readLocalIndex(0);
-    unsigned readRemoteIndex(1);
+    readLocalIndex=0;
+    readRemoteIndex=1;
     if (0 == clocus.getNode(readLocalIndex).count)
     {
         std::swap(readLocalIndex,readRemoteIndex);
     }
+    return true;
+}
+
+
+
+/// test if the read's SV locus supports an SV between localNode and remoteNode
+static
+bool
+isSVNodeLocus(
+    const SVLocus& locus,
+    const unsigned readLocalIndex,
+    const unsigned readRemoteIndex,
+    const SVLocusNode& localNode,
+    const SVLocusNode& remoteNode)
+{
+    if (! locus.getNode(readLocalIndex).interval.isIntersect(localNode.interval)) return false;
+    if (! locus.getNode(readRemoteIndex).interval.isIntersect(remoteNode.interval)) return false;
+    return true;
+}
+
+
 
-    if (! clocus.getNode(readLocalIndex).interval.isIntersect(localNode.interval)) return;
-    if (! clocus.getNode(readRemoteIndex).interval.isIntersect(remoteNode.interval)) return;
+/// test if bamRead overlaps interval using the same criteria as a bam region query
+static
+bool
+isReadOverlap(
+    const bam_record& bamRead,
+    const GenomeInterval& interval)
+{
+    if (bamRead.target_id() != interval.tid) return false;
 
-    svDataGroup.add(bamRead);
+    const bam1_t& b(*(bamRead.get_data()));
+    const pos_t beginPos(b.core.pos);
+    const pos_t endPos(b.core.n_cigar ? bam_calend(&b.core, bam1_cigar(&b)) : (beginPos + 1));
+    return ((endPos > std::max(0,interval.range.begin_pos())) && (beginPos < interval.range.end_pos()));
 }
 
 
 
 void
 SVFinder::
-addSVNodeData(
-    const SVLocus& locus,
-    const NodeIndexType localNodeIndex,
-    const NodeIndexType remoteNodeIndex,
-    SVCandidateData& svData)
+addSweepRead(
+    const bam_record& bamRead,
+    const unsigned bamIndex,
+    const SweepInterval& sweep,
+    const std::vector<unsigned>& searchOrder,
+    std::vector<NodeSearch>& searches)
 {
-    // get full search interval:
-    const SVLocusNode& localNode(locus.getNode(localNodeIndex));
-    const SVLocusNode& remoteNode(locus.getNode(remoteNodeIndex));
-    GenomeInterval searchInterval(localNode.interval);
+    SVLocus locus;
+    unsigned readLocalIndex(0);
+    unsigned readRemoteIndex(0);
+    if (! getReadSVLocus(_readScanner,bamRead,bamIndex,locus,readLocalIndex,readRemoteIndex)) return;
 
-    searchInterval.range.merge_range(localNode.evidenceRange);
+    // the read is summarized once, when the first supported search is found:
+    bool isSummarized(false);
+    for (unsigned orderIndex(sweep.searchBegin); orderIndex<sweep.searchEnd; ++orderIndex)
+    {
+        NodeSearch& search(searches[searchOrder[orderIndex]]);
+        if (! isReadOverlap(bamRead,search.searchInterval)) continue;
+        if (! isSVNodeLocus(locus,readLocalIndex,readRemoteIndex,*(search.localNode),*(search.remoteNode))) continue;
+
+        if (! isSummarized)
+        {
+            _searchReads.reads.resize(_searchReads.reads.size()+1);
+            SearchRead& searchRead(_searchReads.reads.back());
+            _readScanner.getCandidateRead(bamRead,bamIndex,searchRead.svRead);
+            searchRead.readNo=bamRead.read_no();
+            searchRead.qnameOffset=_searchReads.qnames.size();
+
+            const char* qname(bamRead.qname());
+            _searchReads.qnames.insert(_searchReads.qnames.end(),qname,qname+strlen(qname)+1);
+            isSummarized=true;
+        }
+        search.reads[bamIndex].push_back(_searchReads.reads.size()-1);
+    }
+}
 
-#ifdef DEBUG_SVDATA
-    log_os << "addSVNodeData: bp_interval: " << localNode.interval
-           << " evidnece_interval: " << localNode.evidenceRange
-           << " search_interval: " << searchInterval
-           << "\n";
-#endif
 
-    // iterate through reads, test reads for association and add to svData:
+
+/// add the depth of mapped read bamRead to depth
+static
+void
+addReadDepth(
+    const bam_record& bamRead,
+    ALIGNPATH::path_t& apath,
+    window_depth_counter& depth)
+{
+    if (bamRead.is_unmapped()) return;
+    bam_cigar_to_apath(bamRead.raw_cigar(),bamRead.n_cigar(),apath);
+    depth.add_alignment((bamRead.pos()-1),apath);
+}
+
+
+
+void
+SVFinder::
+addSweepDepth(
+    const window_depth_counter& sweepDepth,
+    const SweepInterval& sweep,
+    const std::vector<unsigned>& searchOrder,
+    std::vector<NodeSearch>& searches)
+{
+    std::vector<unsigned> depth;
+    sweepDepth.get_depth(depth);
+
+    const pos_t sweepBeginPos(sweep.interval.range.begin_pos());
+    for (unsigned orderIndex(sweep.searchBegin); orderIndex<sweep.searchEnd; ++orderIndex)
+    {
+        NodeSearch& search(searches[searchOrder[orderIndex]]);
+        const known_pos_range2& range(search.searchInterval.range);
+        search.depth.assign(depth.begin()+(range.begin_pos()-sweepBeginPos),
+                            depth.begin()+(range.end_pos()-sweepBeginPos));
+    }
+}
+
+
+
+void
+SVFinder::
+addSweepData(std::vector<NodeSearch>& searches)
+{
+    std::vector<unsigned> searchOrder;
+    std::vector<SweepInterval> sweeps;
+    getSweepIntervals(searches,searchOrder,sweeps);
+
+    window_depth_counter sweepDepth;
+    ALIGNPATH::path_t apath;
+
+    // stream each coalesced interval once and dispatch reads to every node search they support,
+    // the depth of each interval is found in the same pass:
     unsigned bamIndex(0);
     BOOST_FOREACH(streamPtr& bamPtr, _bamStreams)
     {
-        SVCandidateDataGroup& svDataGroup(svData.getDataGroup(bamIndex));
         bam_streamer& read_stream(*bamPtr);
+        const bool isDepth(_isCollectDepth && (bamIndex == _depthBamIndex));
 
-        // set bam stream to new search interval:
-        read_stream.set_new_region(searchInterval.tid,searchInterval.range.begin_pos(),searchInterval.range.end_pos());
-
-#ifdef DEBUG_SVDATA
-        log_os << "addSVNodeData: scanning bamIndex: " << bamIndex << "\n";
-#endif
-        while (read_stream.next())
+        BOOST_FOREACH(const SweepInterval& sweep, sweeps)
         {
-            const bam_record& bamRead(*(read_stream.get_record_ptr()));
+            const GenomeInterval& interval(sweep.interval);
+            if (isDepth) sweepDepth.reset(interval.range.begin_pos(),interval.range.size());
+
+            if (! _readCache)
+            {
+                read_stream.set_new_region(interval.tid,interval.range.begin_pos(),interval.range.end_pos());
+
+                while (read_stream.next())
+                {
+                    const bam_record& bamRead(*(read_stream.get_record_ptr()));
+                    addSweepRead(bamRead,bamIndex,sweep,searchOrder,searches);
+                    if (isDepth) addReadDepth(bamRead,apath,sweepDepth);
+                }
+                if (isDepth) addSweepDepth(sweepDepth,sweep,searchOrder,searches);
+                continue;
+            }
 
-            // test if read supports an SV on this edge, if so, add to SVData
-            addSVNodeRead(_readScanner,localNode,remoteNode,bamRead, bamIndex,svDataGroup);
+            // Get the interval's reads from cached windows. Each window holds all reads overlapping it, so
+            // reads starting before a window are skipped after the first window to recreate the read order
+            // of a single region query:
+            const int windowSize(_readCache->windowSize());
+            const int beginWindow(std::max(0,interval.range.begin_pos())/windowSize);
+            const int endWindow((interval.range.end_pos()-1)/windowSize);
+            for (int windowIndex(beginWindow); windowIndex<=endWindow; ++windowIndex)
+            {
+                const pos_t windowBeginPos(windowIndex*windowSize);
+                const ReadWindowCache::window_t& reads(_readCache->getWindow(bamIndex,read_stream,interval.tid,windowIndex));
+                BOOST_FOREACH(const bam_record& bamRead, reads)
+                {
+                    if ((windowIndex != beginWindow) && (bamRead.pos()-1 < windowBeginPos)) continue;
+                    if (! isReadOverlap(bamRead,interval)) continue;
+                    addSweepRead(bamRead,bamIndex,sweep,searchOrder,searches);
+                    if (isDepth) addReadDepth(bamRead,apath,sweepDepth);
+                }
+            }
+            if (isDepth) addSweepDepth(sweepDepth,sweep,searchOrder,searches);
         }
         bamIndex++;
     }
@@ -212,115 +517,15 @@ checkResult(
 
 
 
-// check whether any svs have grown to intersect each other
-//
-// this is also part of the temp hygen hack, so just make this minimally work:
-//
-static
-void
-consolidateOverlap(
-    const unsigned bamCount,
-    SVCandidateData& svData,
-    std::vector<SVCandidate>& svs)
-{
-    typedef std::map<unsigned,unsigned> movemap_t;
-    movemap_t moveSVIndex;
-    std::set<unsigned> deletedSVIndex;
-
-    const unsigned svCount(svs.size());
-    for (unsigned outerIndex(1); outerIndex<svCount; ++outerIndex)
-    {
-        for (unsigned innerIndex(0); innerIndex<outerIndex; ++innerIndex)
-        {
-            if (svs[innerIndex].isIntersect(svs[outerIndex]))
-            {
-#ifdef DEBUG_SVDATA
-                log_os << "Merging outer:inner: " << outerIndex << " " << innerIndex << "\n";
-#endif
-                svs[innerIndex].merge(svs[outerIndex]);
-                moveSVIndex[outerIndex] = (innerIndex - deletedSVIndex.size());
-                deletedSVIndex.insert(outerIndex);
-                break;
-            }
-        }
-    }
-
-    if (! deletedSVIndex.empty())
-    {
-#ifdef DEBUG_SVDATA
-        BOOST_FOREACH(const unsigned index, deletedSVIndex)
-        {
-            log_os << "deleted index: " << index << "\n";
-        }
-#endif
-
-        {
-            unsigned shift(0);
-            bool isLastIndex(false);
-            unsigned lastIndex(0);
-            BOOST_FOREACH(const unsigned index, deletedSVIndex)
-            {
-                if (isLastIndex)
-                {
-                    for (unsigned i(lastIndex+1); i<index; ++i)
-                    {
-                        assert(shift>0);
-                        assert(i>=shift);
-                        moveSVIndex[i] = (i-shift);
-                        svs[(i-shift)] = svs[i];
-                    }
-                }
-                lastIndex=index;
-                isLastIndex=true;
-                shift++;
-            }
-            if (isLastIndex)
-            {
-                for (unsigned i(lastIndex+1); i<svCount; ++i)
-                {
-                    assert(shift>0);
-                    assert(i>=shift);
-                    moveSVIndex[i] = (i-shift);
-                    svs[(i-shift)] = svs[i];
-                }
-            }
-        }
-
-        svs.resize(svs.size()-deletedSVIndex.size());
-    }
-
-    if (! moveSVIndex.empty())
-    {
-#ifdef DEBUG_SVDATA
-        BOOST_FOREACH(const movemap_t::value_type& val, moveSVIndex)
-        {
-            log_os << "Movemap from: " << val.first << " to: " << val.second << "\n";
-        }
-#endif
-
-        for (unsigned bamIndex(0); bamIndex < bamCount; ++bamIndex)
-        {
-            SVCandidateDataGroup& svDataGroup(svData.getDataGroup(bamIndex));
-            BOOST_FOREACH(SVCandidateReadPair& pair, svDataGroup)
-            {
-                if (moveSVIndex.count(pair.svIndex))
-                {
-                    pair.svIndex = moveSVIndex[pair.svIndex];
-                }
-            }
-        }
-    }
-
-}
-
-
-
 void
 SVFinder::
 getCandidatesFromData(
     SVCandidateData& svData,
     std::vector<SVCandidate>& svs)
 {
+    // translate each read pair into a single observation candidate:
+    std::vector<SVCandidate> cands;
+    std::vector<SVCandidateReadPair*> candPairs;
     SVCandidate cand;
 
     const unsigned bamCount(_bamStreams.size());
@@ -343,63 +548,31 @@ getCandidatesFromData(
                     std::swap(localReadPtr,remoteReadPtr);
                 }
             }
-            const bam_record* remoteBamRecPtr( remoteReadPtr->isSet() ? &(remoteReadPtr->bamrec) : NULL);
+            const SVCandidateRead* remoteSetReadPtr( remoteReadPtr->isSet() ? remoteReadPtr : NULL);
 
             cand.clear();
-            _readScanner.getBreakendPair(localReadPtr->bamrec, remoteBamRecPtr, bamIndex, cand.bp1, cand.bp2);
+            _readScanner.getBreakendPair(*localReadPtr, remoteSetReadPtr, cand.bp1, cand.bp2);
 
 #ifdef DEBUG_SVDATA
             log_os << "Checking pair: " << pair << "\n";
             log_os << "Translated to cand: " << cand << "\n";
 #endif
 
-            bool isSVFound(false);
-            unsigned svIndex(0);
-
-            // temporary hack hypoth gen method assumes that only one SV exists for each overlapping breakpoint range with
-            // the same orientation:
-            //
-            // we anticipate so few svs from the POC method, that there's no indexing on them
-            BOOST_FOREACH(SVCandidate& sv, svs)
-            {
-                if (sv.isIntersect(cand))
-                {
-#ifdef DEBUG_SVDATA
-                    log_os << "Adding to svIndex: " << svIndex << "\n";
-#endif
-                    sv.merge(cand);
-                    pair.svIndex = svIndex;
-                    isSVFound=true;
-                    break;
-                }
-                svIndex++;
-            }
-
-            if (! isSVFound)
-            {
-#ifdef DEBUG_SVDATA
-                log_os << "New svIndex: " << svs.size() << "\n";
-#endif
-                pair.svIndex = svs.size();
-                svs.push_back(cand);
-            }
+            cands.push_back(cand);
+            candPairs.push_back(&pair);
         }
     }
 
-#ifdef DEBUG_SVDATA
-    {
-        log_os << "findSVCandidates: precount: " << svs.size() << "\n";
+    // temporary hack hypoth gen method assumes that only one SV exists for each overlapping breakpoint range with
+    // the same orientation:
+    std::vector<unsigned> candSVIndex;
+    clusterSVCandidates(cands,candSVIndex,svs);
 
-        unsigned svIndex(0);
-        BOOST_FOREACH(SVCandidate& sv, svs)
-        {
-            log_os << "\tPRECOUNT: index: " << svIndex << " " << sv;
-            svIndex++;
-        }
+    const unsigned candCount(cands.size());
+    for (unsigned candIndex(0); candIndex<candCount; ++candIndex)
+    {
+        candPairs[candIndex]->svIndex = candSVIndex[candIndex];
     }
-#endif
-
-    consolidateOverlap(bamCount,svData,svs);
 
 #ifdef DEBUG_SVDATA
     {
@@ -424,22 +597,32 @@ findCandidateSV(
     SVCandidateData& svData,
     std::vector<SVCandidate>& svs)
 {
-    svData.clear();
-    svs.clear();
+    const std::vector<EdgeInfo> edges(1,edge);
+    std::vector<SVCandidateData> svDataSet;
+    std::vector<std::vector<SVCandidate> > svsSet;
+    findCandidateSVBatch(edges,svDataSet,svsSet);
+    svData=svDataSet[0];
+    svs=svsSet[0];
+}
 
-    const SVLocusSet& set(getSet());
-    const unsigned minEdgeCount(set.getMinMergeEdgeCount());
 
-    // first determine if this is an edge we're going to evaluate
-    //
-    // edge must be bidirectional at the noise threshold of the locus set:
-    const SVLocus& locus(set.getLocus(edge.locusIndex));
 
-    if ((locus.getEdge(edge.nodeIndex1,edge.nodeIndex2).count <= minEdgeCount) ||
-        (locus.getEdge(edge.nodeIndex2,edge.nodeIndex1).count <= minEdgeCount))
+void
+SVFinder::
+findCandidateSVBatch(
+    const std::vector<EdgeInfo>& edges,
+    std::vector<SVCandidateData>& svDataSet,
+    std::vector<std::vector<SVCandidate> >& svsSet)
+{
+    // candidate data is cleared rather than reallocated, so that its storage is reused from batch to batch:
+    const unsigned edgeCount(edges.size());
+    svDataSet.resize(edgeCount);
+    BOOST_FOREACH(SVCandidateData& svData, svDataSet)
     {
-        return;
+        svData.clear();
     }
+    svsSet.clear();
+    svsSet.resize(edgeCount);
 
     // start gathering evidence required for hypothesis generation,
     //
@@ -447,6 +630,9 @@ findCandidateSV(
     // some sort of breakend in the target region, then match up pairs so that they
     // can easily be accessed from each other
     //
+    // the regions of all edges in the batch are scanned together, so that regions
+    // shared by several edges are only read once
+    //
 
     // steps:
     // iterate through regions -- for each region walk from evidence range to breakpoint range picking up all reads associated with the breakend
@@ -457,15 +643,45 @@ findCandidateSV(
     // come up with an ultra-simple model-free scoring rule: >10 obs = Q60,k else Q0
     //
 
-    addSVNodeData(locus,edge.nodeIndex1,edge.nodeIndex2,svData);
-    addSVNodeData(locus,edge.nodeIndex2,edge.nodeIndex1,svData);
+    // only edges we're going to evaluate have node searches:
+    std::vector<NodeSearch> searches;
+    getNodeSearches(edges,searches);
+
+    _searchReads.clear();
+    addSweepData(searches);
+
+    // add read summaries and breakend depth to each edge's data in search order:
+    const unsigned bamCount(_bamStreams.size());
+    BOOST_FOREACH(NodeSearch& search, searches)
+    {
+        SVCandidateData& svData(svDataSet[search.edgeIndex]);
+        for (unsigned bamIndex(0); bamIndex<bamCount; ++bamIndex)
+        {
+            SVCandidateDataGroup& svDataGroup(svData.getDataGroup(bamIndex));
+            BOOST_FOREACH(const unsigned readIndex, search.reads[bamIndex])
+            {
+                const SearchRead& searchRead(_searchReads.reads[readIndex]);
+                svDataGroup.add(&(_searchReads.qnames[searchRead.qnameOffset]),searchRead.readNo,searchRead.svRead);
+            }
+        }
+
+        if (_isCollectDepth)
+        {
+            SVCandidateDepthRegion& region(svData.addDepthRegion());
+            region.interval=search.searchInterval;
+            region.depth.swap(search.depth);
+        }
+    }
+
+    for (unsigned edgeIndex(0); edgeIndex<edgeCount; ++edgeIndex)
+    {
+        if (! isEvaluatedEdge(edges[edgeIndex])) continue;
 
-    getCandidatesFromData(svData,svs);
+        getCandidatesFromData(svDataSet[edgeIndex],svsSet[edgeIndex]);
 
 #ifdef DEBUG_SVDATA
-    checkResult(svData,svs);
+        checkResult(svDataSet[edgeIndex],svsSet[edgeIndex]);
 #endif
+    }
 }
 
-
-
@@ -18,14 +18,17 @@
 #pragma once
 
 #include "GSCOptions.hh"
+#include "ReadWindowCache.hh"
 #include "svgraph/EdgeInfo.hh"
 
 #include "blt_util/bam_streamer.hh"
+#include "blt_util/window_depth_counter.hh"
 #include "manta/SVCandidate.hh"
 #include "manta/SVCandidateData.hh"
 #include "manta/SVLocusScanner.hh"
 #include "svgraph/SVLocusSet.hh"
 
+#include "boost/scoped_ptr.hpp"
 #include "boost/shared_ptr.hpp"
 
 #include <vector>
@@ -34,7 +37,10 @@
 struct SVFinder
 {
 
-    SVFinder(const GSCOptions& opt);
+    /// \param set the sv locus graph, which may be shared by several finders
+    SVFinder(
+        const GSCOptions& opt,
+        const SVLocusSet& set);
 
     const SVLocusSet&
     getSet() const
@@ -42,25 +48,149 @@ struct SVFinder
         return _set;
     }
 
+    /// hit and miss counts of the decoded read cache, all counts are zero if the cache is disabled
+    ReadWindowCacheStats
+    getReadCacheStats() const
+    {
+        if (! _readCache) return ReadWindowCacheStats();
+        return _readCache->getStats();
+    }
+
+    /// queue the alignment file regions required to evaluate edges for background reading
+    void
+    prefetchEdges(const std::vector<EdgeInfo>& edges);
+
     void
     findCandidateSV(
         const EdgeInfo& edge,
         SVCandidateData& svData,
         std::vector<SVCandidate>& svs);
 
+    /// find candidate SVs for all edges, with the same result as calling findCandidateSV for each edge
+    ///
+    /// reads are gathered in a single sweep over the sorted and coalesced search regions of all
+    /// edges, so that regions shared by several edges are read once
+    ///
+    void
+    findCandidateSVBatch(
+        const std::vector<EdgeInfo>& edges,
+        std::vector<SVCandidateData>& svDataSet,
+        std::vector<std::vector<SVCandidate> >& svsSet);
+
     void
     checkResult(
         const SVCandidateData& svData,
         const std::vector<SVCandidate>& svs) const;
 
+    /// test if edge passes the noise threshold of the locus set, such that its evidence will be gathered
+    bool
+    isEvaluatedEdge(const EdgeInfo& edge) const;
+
 private:
 
+    /// summary of a read supporting one or more node searches, shared by all of these searches
+    struct SearchRead
+    {
+        SearchRead() :
+            qnameOffset(0),
+            readNo(1)
+        {}
+
+        SVCandidateRead svRead;
+
+        /// offset of the read name in the search read name arena
+        unsigned qnameOffset;
+
+        int readNo;
+    };
+
+    /// reads supporting any node search of a batch
+    struct SearchReadSet
+    {
+        void
+        clear()
+        {
+            reads.clear();
+            qnames.clear();
+        }
+
+        std::vector<SearchRead> reads;
+
+        /// null terminated names of all reads
+        std::vector<char> qnames;
+    };
+
+    /// the search for reads supporting one node of an edge
+    struct NodeSearch
+    {
+        NodeSearch() :
+            edgeIndex(0),
+            localNode(NULL),
+            remoteNode(NULL)
+        {}
+
+        unsigned edgeIndex;
+        const SVLocusNode* localNode;
+        const SVLocusNode* remoteNode;
+        GenomeInterval searchInterval;
+
+        /// index of the supporting reads found in each alignment file within the batch SearchReadSet
+        std::vector<std::vector<unsigned> > reads;
+
+        /// mapped depth of the depth estimate alignment file over searchInterval, set only if depth is collected
+        std::vector<unsigned> depth;
+    };
+
+    /// a coalesced region of the genome covering one or more node searches
+    struct SweepInterval
+    {
+        SweepInterval() :
+            searchBegin(0),
+            searchEnd(0)
+        {}
+
+        GenomeInterval interval;
+
+        /// range of the sorted node search order covered by this interval
+        unsigned searchBegin;
+        unsigned searchEnd;
+    };
+
+    /// get the node searches for all evaluated edges, edge indices refer to edges
     void
-    addSVNodeData(
-        const SVLocus& locus,
-        const NodeIndexType node1,
-        const NodeIndexType node2,
-        SVCandidateData& svData);
+    getNodeSearches(
+        const std::vector<EdgeInfo>& edges,
+        std::vector<NodeSearch>& searches) const;
+
+    /// sort searches by interval and coalesce them into non-overlapping sweep intervals
+    static
+    void
+    getSweepIntervals(
+        const std::vector<NodeSearch>& searches,
+        std::vector<unsigned>& searchOrder,
+        std::vector<SweepInterval>& sweeps);
+
+    /// read each sweep interval once and add supporting reads to all node searches
+    void
+    addSweepData(std::vector<NodeSearch>& searches);
+
+    /// copy the depth of sweep to each node search it covers
+    static
+    void
+    addSweepDepth(
+        const window_depth_counter& sweepDepth,
+        const SweepInterval& sweep,
+        const std::vector<unsigned>& searchOrder,
+        std::vector<NodeSearch>& searches);
+
+    /// add the summary of bamRead to each node search of sweep which it supports
+    void
+    addSweepRead(
+        const bam_record& bamRead,
+        const unsigned bamIndex,
+        const SweepInterval& sweep,
+        const std::vector<unsigned>& searchOrder,
+        std::vector<NodeSearch>& searches);
 
 
     void
@@ -69,9 +199,21 @@ private:
         std::vector<SVCandidate>& svs);
 
     const ReadScannerOptions _scanOpt;
-    SVLocusSet _set;
+    const SVLocusSet& _set;
     SVLocusScanner _readScanner;
 
     typedef boost::shared_ptr<bam_streamer> streamPtr;
     std::vector<streamPtr> _bamStreams;
+
+    /// if true, breakend depth is collected for the scorer while the evidence regions are read
+    bool _isCollectDepth;
+
+    /// index of the alignment file used for breakend depth estimates
+    unsigned _depthBamIndex;
+
+    /// decoded reads from recently scanned windows, null if the cache is disabled
+    boost::scoped_ptr<ReadWindowCache> _readCache;
+
+    /// supporting reads of the current batch, storage is reused from batch to batch
+    SearchReadSet _searchReads;
 };
@@ -20,6 +20,7 @@
 #include "blt_util/align_path_bam_util.hh"
 #include "blt_util/bam_streamer.hh"
 #include "blt_util/log.hh"
+#include "blt_util/window_depth_counter.hh"
 #include "common/Exceptions.hh"
 #include "manta/ReadGroupStatsSet.hh"
 
@@ -36,7 +37,7 @@ SVScorer(
     const bam_header_info& header) :
     _isAlignmentTumor(opt.isAlignmentTumor),
     _somaticOpt(opt.somaticOpt),
-    _dFilter(opt.chromDepthFilename, opt.somaticOpt.maxDepthFactor, header),
+    _dFilter(opt.chromDepthFilename, opt.somaticOpt.maxDepthFactor, header, opt.depthIndexFilename),
     _readScanner(opt.scanOpt,opt.statsFilename,opt.alignmentFilename)
 {
     // setup regionless bam_streams:
@@ -44,45 +45,60 @@ SVScorer(
     BOOST_FOREACH(const std::string& afile, opt.alignmentFilename)
     {
         // avoid creating shared_ptr temporaries:
-        streamPtr tmp(new bam_streamer(afile.c_str()));
+        streamPtr tmp(new bam_streamer(afile.c_str(),NULL,opt.decompressThreadCount));
         _bamStreams.push_back(tmp);
     }
 }
 
 
 
-static
-void
-addReadToDepthEst(
-    const bam_record& bamRead,
-    const pos_t beginPos,
-    std::vector<unsigned>& depth)
+known_pos_range2
+SVScorer::
+getBreakendDepthRange(const SVBreakend& bp)
 {
-    using namespace ALIGNPATH;
+    /// define a new interval -/+ 50 bases around the center pos
+    /// of the breakpoint
+    static const pos_t regionSize(50);
+    const pos_t centerPos(bp.interval.range.center_pos());
+    return known_pos_range2(std::max((centerPos-regionSize),0), (centerPos+regionSize));
+}
 
-    const pos_t endPos(beginPos+depth.size());
 
-    // get cigar:
-    path_t apath;
-    bam_cigar_to_apath(bamRead.raw_cigar(), bamRead.n_cigar(), apath);
 
-    pos_t refPos(bamRead.pos()-1);
-    BOOST_FOREACH(const path_segment& ps, apath)
+unsigned
+SVScorer::
+getDepthBamIndex() const
+{
+    const unsigned bamCount(_bamStreams.size());
+    for (unsigned bamIndex(0); bamIndex < bamCount; ++bamIndex)
     {
-        if (refPos>=endPos) return;
+        if (! _isAlignmentTumor[bamIndex]) return bamIndex;
+    }
 
-        if (MATCH == ps.type)
-        {
-            for (pos_t pos(refPos); pos < (refPos+static_cast<pos_t>(ps.length)); ++pos)
-            {
-                if (pos>=beginPos)
-                {
-                    if (pos>=endPos) return;
-                    depth[pos-beginPos]++;
-                }
-            }
-        }
-        if (is_segment_type_ref_length(ps.type)) refPos += ps.length;
+    assert(false && "No non-tumor alignment file found");
+    return 0;
+}
+
+
+
+void
+SVScorer::
+prefetchSV(
+    const SVCandidateData& svData,
+    const SVCandidate& sv)
+{
+    // breakend depth doesn't require the alignments when the depth index is available:
+    if (_dFilter.isDepthIndex()) return;
+
+    bam_streamer& bamStream(*_bamStreams[getDepthBamIndex()]);
+
+    const SVBreakend* bps[] = { &(sv.bp1), &(sv.bp2) };
+    BOOST_FOREACH(const SVBreakend* bp, bps)
+    {
+        const known_pos_range2 searchRange(getBreakendDepthRange(*bp));
+        unsigned maxDepth(0);
+        if (svData.getMaxDepth(GenomeInterval(bp->interval.tid,searchRange.begin_pos(),searchRange.end_pos()),maxDepth)) continue;
+        bamStream.prefetch_region(bp->interval.tid, searchRange.begin_pos(), searchRange.end_pos());
     }
 }
 
@@ -90,53 +106,48 @@ addReadToDepthEst(
 
 unsigned
 SVScorer::
-getBreakendMaxMappedDepth(const SVBreakend& bp)
+getBreakendMaxMappedDepth(
+    const SVCandidateData& svData,
+    const SVBreakend& bp)
 {
-    /// define a new interval -/+ 50 bases around the center pos
-    /// of the breakpoint
-    static const pos_t regionSize(50);
-    const pos_t centerPos(bp.interval.range.center_pos());
-    const known_pos_range2 searchRange(std::max((centerPos-regionSize),0), (centerPos+regionSize));
-
-    std::vector<unsigned> depth(searchRange.size(),0);
+    const known_pos_range2 searchRange(getBreakendDepthRange(bp));
 
-    bool isNormalFound(false);
+    if (_dFilter.isDepthIndex()) return _dFilter.indexMaxDepth(bp.interval.tid, searchRange);
 
-    const unsigned bamCount(_bamStreams.size());
-    for (unsigned bamIndex(0); bamIndex < bamCount; ++bamIndex)
+    // use the depth collected with the breakend evidence if it covers the search range:
+    unsigned maxDepth(0);
+    if (svData.getMaxDepth(GenomeInterval(bp.interval.tid,searchRange.begin_pos(),searchRange.end_pos()),maxDepth))
     {
-        if (_isAlignmentTumor[bamIndex]) continue;
+        return maxDepth;
+    }
 
-        bam_streamer& bamStream(*_bamStreams[bamIndex]);
+    window_depth_counter depth(searchRange.begin_pos(),searchRange.size());
+    ALIGNPATH::path_t apath;
 
-        // set bam stream to new search interval:
-        bamStream.set_new_region(bp.interval.tid, searchRange.begin_pos(), searchRange.end_pos());
+    bam_streamer& bamStream(*_bamStreams[getDepthBamIndex()]);
 
-        while (bamStream.next())
-        {
-            const bam_record& bamRead(*(bamStream.get_record_ptr()));
+    // set bam stream to new search interval:
+    bamStream.set_new_region(bp.interval.tid, searchRange.begin_pos(), searchRange.end_pos());
 
-            // turn filtration off down to mapped only to match depth estimate method:
-            //if (_readScanner.isReadFiltered(bamRead)) continue;
-            if (bamRead.is_unmapped()) continue;
+    while (bamStream.next())
+    {
+        const bam_record& bamRead(*(bamStream.get_record_ptr()));
 
-            if ((bamRead.pos()-1) >= searchRange.end_pos()) break;
+        // turn filtration off down to mapped only to match depth estimate method:
+        //if (_readScanner.isReadFiltered(bamRead)) continue;
+        if (bamRead.is_unmapped()) continue;
 
-            addReadToDepthEst(bamRead,searchRange.begin_pos(),depth);
-        }
+        if ((bamRead.pos()-1) >= searchRange.end_pos()) break;
 
-        isNormalFound=true;
-        break;
+        bam_cigar_to_apath(bamRead.raw_cigar(),bamRead.n_cigar(),apath);
+        depth.add_alignment((bamRead.pos()-1),apath);
     }
 
-    assert(isNormalFound);
-
-    return *(std::max_element(depth.begin(),depth.end()));
+    return depth.max_depth();
 }
 
 
 
-
 void
 SVScorer::
 scoreSomaticSV(
@@ -176,8 +187,8 @@ scoreSomaticSV(
     }
 
     // get breakend center_pos depth estimate:
-    ssInfo.bp1MaxDepth=(getBreakendMaxMappedDepth(sv.bp1));
-    ssInfo.bp2MaxDepth=(getBreakendMaxMappedDepth(sv.bp2));
+    ssInfo.bp1MaxDepth=(getBreakendMaxMappedDepth(svData,sv.bp1));
+    ssInfo.bp2MaxDepth=(getBreakendMaxMappedDepth(svData,sv.bp2));
 
     // Get Data on standard read pairs crossing the two breakends,
     // and get a breakend depth estimate
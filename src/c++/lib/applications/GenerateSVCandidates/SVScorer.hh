@@ -38,6 +38,12 @@ struct SVScorer
         const GSCOptions& opt,
         const bam_header_info& header);
 
+    /// queue the alignment file regions required to score sv for background reading
+    void
+    prefetchSV(
+        const SVCandidateData& svData,
+        const SVCandidate& sv);
+
     void
     scoreSomaticSV(
         const SVCandidateData& svData,
@@ -47,9 +53,24 @@ struct SVScorer
 
 private:
 
+    /// get the region around breakend used for the depth estimate
+    static
+    known_pos_range2
+    getBreakendDepthRange(const SVBreakend& bp);
+
+    /// index of the alignment file used for breakend depth estimates
+    unsigned
+    getDepthBamIndex() const;
+
     /// determine maximum depth in region around breakend
+    ///
+    /// when a depth index is available this is the max depth of the index bins intersecting
+    /// the region, otherwise depth is taken from the depth collected with the evidence in
+    /// svData, or if the region isn't covered, from the alignments of the first non-tumor file
     unsigned
-    getBreakendMaxMappedDepth(const SVBreakend& bp);
+    getBreakendMaxMappedDepth(
+        const SVCandidateData& svData,
+        const SVBreakend& bp);
 
     const std::vector<bool> _isAlignmentTumor;
     const SomaticCallOptions _somaticOpt;
@@ -22,6 +22,9 @@
 
 #include "svgraph/test/SVLocusTestUtil.hh"
 
+#include <algorithm>
+#include <vector>
+
 
 BOOST_AUTO_TEST_SUITE( test_EdgeRetriever )
 
@@ -150,5 +153,84 @@ BOOST_AUTO_TEST_CASE( test_EdgeRetrieverOddBin )
 }
 
 
+
+
+BOOST_AUTO_TEST_CASE( test_EdgeRetrieverLocalityOrder )
+{
+    // merge loci out of genomic order:
+    SVLocus locus1;
+    locusAddPair(locus1,5,10,20,6,30,40);
+    SVLocus locus2;
+    locusAddPair(locus2,1,10,20,2,30,40);
+    SVLocus locus3;
+    locusAddPair(locus3,3,10,20,4,30,40);
+    SVLocus locus4;
+    locusAddPair(locus4,1,50,60,3,30,40);
+
+    SVLocusSet set1(1);
+    set1.merge(locus1);
+    set1.merge(locus2);
+    set1.merge(locus3);
+    set1.merge(locus4);
+    set1.checkState(true,true);
+
+    const SVLocusSet& cset(set1);
+    std::vector<int> tids;
+    for (unsigned binIndex(0); binIndex<2; ++binIndex)
+    {
+        EdgeRetriever edger(set1,2,binIndex,true);
+        while (edger.next())
+        {
+            const EdgeInfo& edge(edger.getEdge());
+            const SVLocus& locus(cset.getLocus(edge.locusIndex));
+            tids.push_back(std::min(locus.getNode(edge.nodeIndex1).interval.tid,
+                                    locus.getNode(edge.nodeIndex2).interval.tid));
+        }
+    }
+
+    BOOST_REQUIRE_EQUAL(tids.size(),4u);
+    BOOST_REQUIRE_EQUAL(tids[0],1);
+    BOOST_REQUIRE_EQUAL(tids[1],1);
+    BOOST_REQUIRE_EQUAL(tids[2],3);
+    BOOST_REQUIRE_EQUAL(tids[3],5);
+}
+
+
+BOOST_AUTO_TEST_CASE( test_EdgeRetrieverCostBalance )
+{
+    // one edge with a very large search region, followed by several small ones:
+    SVLocus locus1;
+    locusAddPair(locus1,1,10,100000,2,30,40);
+    SVLocus locus2;
+    locusAddPair(locus2,3,10,20,4,30,40);
+    SVLocus locus3;
+    locusAddPair(locus3,5,10,20,6,30,40);
+    SVLocus locus4;
+    locusAddPair(locus4,7,10,20,8,30,40);
+
+    SVLocusSet set1(1);
+    set1.merge(locus1);
+    set1.merge(locus2);
+    set1.merge(locus3);
+    set1.merge(locus4);
+    set1.checkState(true,true);
+
+    // the expensive edge should get a bin to itself:
+    EdgeRetriever edger0(set1,2,0);
+    BOOST_REQUIRE( edger0.next() );
+    BOOST_REQUIRE_EQUAL(edger0.getEdge().locusIndex, 0u);
+    BOOST_REQUIRE( ! edger0.next() );
+
+    unsigned count(0);
+    EdgeRetriever edger1(set1,2,1);
+    while (edger1.next())
+    {
+        BOOST_REQUIRE(edger1.getEdge().locusIndex != 0u);
+        count++;
+    }
+    BOOST_REQUIRE_EQUAL(count,3u);
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,277 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+///
+/// \author Chris Saunders
+///
+
+#include "boost/test/unit_test.hpp"
+
+#include "applications/GenerateSVCandidates/SVCandidateCluster.hh"
+
+#include "boost/foreach.hpp"
+
+#include <cstdlib>
+
+#include <vector>
+
+
+BOOST_AUTO_TEST_SUITE( test_SVCandidateCluster )
+
+
+static
+SVCandidate
+getCandidate(
+    const int tid1, const pos_t begin1, const pos_t end1,
+    const int tid2, const pos_t begin2, const pos_t end2)
+{
+    SVCandidate cand;
+    cand.bp1.state = SVBreakendState::RIGHT_OPEN;
+    cand.bp1.interval = GenomeInterval(tid1,begin1,end1);
+    cand.bp1.readCount = 1;
+    cand.bp2.state = SVBreakendState::LEFT_OPEN;
+    cand.bp2.interval = GenomeInterval(tid2,begin2,end2);
+    cand.bp2.readCount = 1;
+    return cand;
+}
+
+
+
+BOOST_AUTO_TEST_CASE( test_SVCandidateClusterGrowth )
+{
+    // the third candidate only intersects the merged ranges of the first two:
+    std::vector<SVCandidate> cands;
+    cands.push_back(getCandidate(0,100,150,1,1000,1050));
+    cands.push_back(getCandidate(0,140,200,1,1040,1100));
+    cands.push_back(getCandidate(0,160,170,1,1005,1010));
+    cands.push_back(getCandidate(0,500,600,1,1000,1100));
+
+    // breakend order is the reverse of the first candidate's:
+    SVCandidate cand(getCandidate(0,550,560,1,1050,1060));
+    std::swap(cand.bp1,cand.bp2);
+    cands.push_back(cand);
+
+    std::vector<unsigned> candSVIndex;
+    std::vector<SVCandidate> svs;
+    clusterSVCandidates(cands,candSVIndex,svs);
+
+    BOOST_REQUIRE_EQUAL(svs.size(),2u);
+    BOOST_REQUIRE_EQUAL(candSVIndex.size(),5u);
+    BOOST_REQUIRE_EQUAL(candSVIndex[0],0u);
+    BOOST_REQUIRE_EQUAL(candSVIndex[1],0u);
+    BOOST_REQUIRE_EQUAL(candSVIndex[2],0u);
+    BOOST_REQUIRE_EQUAL(candSVIndex[3],1u);
+    BOOST_REQUIRE_EQUAL(candSVIndex[4],1u);
+
+    BOOST_REQUIRE_EQUAL(svs[0].bp1.interval.range.begin_pos(),100);
+    BOOST_REQUIRE_EQUAL(svs[0].bp1.interval.range.end_pos(),200);
+    BOOST_REQUIRE_EQUAL(svs[0].bp2.interval.range.begin_pos(),1000);
+    BOOST_REQUIRE_EQUAL(svs[0].bp2.interval.range.end_pos(),1100);
+    BOOST_REQUIRE_EQUAL(svs[0].bp1.readCount,3u);
+    BOOST_REQUIRE_EQUAL(svs[1].bp1.interval.tid,0);
+    BOOST_REQUIRE_EQUAL(svs[1].bp1.readCount,2u);
+}
+
+
+
+BOOST_AUTO_TEST_CASE( test_SVCandidateClusterCrossed )
+{
+    // both breakends of these candidates share orientation and chromosome, and they only intersect in crossed order:
+    std::vector<SVCandidate> cands;
+    cands.push_back(getCandidate(0,0,100,0,50,60));
+    cands.push_back(getCandidate(0,55,58,0,90,95));
+    cands.push_back(getCandidate(0,500,600,0,700,800));
+    BOOST_FOREACH(SVCandidate& cand, cands)
+    {
+        cand.bp2.state = SVBreakendState::RIGHT_OPEN;
+    }
+    BOOST_REQUIRE(cands[0].isIntersect(cands[1]));
+
+    std::vector<unsigned> candSVIndex;
+    std::vector<SVCandidate> svs;
+    clusterSVCandidates(cands,candSVIndex,svs);
+
+    BOOST_REQUIRE_EQUAL(svs.size(),2u);
+    BOOST_REQUIRE_EQUAL(candSVIndex[0],0u);
+    BOOST_REQUIRE_EQUAL(candSVIndex[1],0u);
+    BOOST_REQUIRE_EQUAL(candSVIndex[2],1u);
+
+    // the cluster follows the breakend order of the first candidate:
+    BOOST_REQUIRE_EQUAL(svs[0].bp1.interval.range.begin_pos(),0);
+    BOOST_REQUIRE_EQUAL(svs[0].bp1.interval.range.end_pos(),100);
+    BOOST_REQUIRE_EQUAL(svs[0].bp2.interval.range.begin_pos(),50);
+    BOOST_REQUIRE_EQUAL(svs[0].bp2.interval.range.end_pos(),60);
+    BOOST_REQUIRE_EQUAL(svs[0].bp1.readCount,2u);
+}
+
+
+
+static
+bool
+isContained(
+    const SVBreakend& svbp,
+    const SVBreakend& bp)
+{
+    return ((svbp.state == bp.state) &&
+            (svbp.interval.tid == bp.interval.tid) &&
+            (svbp.interval.range.begin_pos() <= bp.interval.range.begin_pos()) &&
+            (svbp.interval.range.end_pos() >= bp.interval.range.end_pos()));
+}
+
+
+
+/// is candidate cand contained in sv, in either breakend order?
+static
+bool
+isContained(
+    const SVCandidate& sv,
+    const SVCandidate& cand)
+{
+    return ((isContained(sv.bp1,cand.bp1) && isContained(sv.bp2,cand.bp2)) ||
+            (isContained(sv.bp1,cand.bp2) && isContained(sv.bp2,cand.bp1)));
+}
+
+
+
+/// check the clusters of candidates which may intersect in crossed breakend order
+///
+/// the merged clusters then depend on the order of merges, so rather than compare to a
+/// reference clustering, check that no clusters intersect and that each candidate is
+/// contained in its cluster
+static
+void
+checkClusters(
+    const std::vector<SVCandidate>& cands,
+    const std::vector<unsigned>& candSVIndex,
+    const std::vector<SVCandidate>& svs)
+{
+    const unsigned svCount(svs.size());
+    for (unsigned svIndex(1); svIndex<svCount; ++svIndex)
+    {
+        for (unsigned svIndex2(0); svIndex2<svIndex; ++svIndex2)
+        {
+            BOOST_REQUIRE(! svs[svIndex].isIntersect(svs[svIndex2]));
+        }
+    }
+
+    BOOST_REQUIRE_EQUAL(candSVIndex.size(),cands.size());
+    unsigned nextSVIndex(0);
+    unsigned readCount(0);
+    for (unsigned candIndex(0); candIndex<cands.size(); ++candIndex)
+    {
+        // clusters are ordered by their first candidate:
+        BOOST_REQUIRE(candSVIndex[candIndex] <= nextSVIndex);
+        if (candSVIndex[candIndex] == nextSVIndex) nextSVIndex++;
+        BOOST_REQUIRE(isContained(svs[candSVIndex[candIndex]],cands[candIndex]));
+        readCount += (cands[candIndex].bp1.readCount + cands[candIndex].bp2.readCount);
+    }
+    BOOST_REQUIRE_EQUAL(nextSVIndex,svCount);
+
+    BOOST_FOREACH(const SVCandidate& sv, svs)
+    {
+        readCount -= (sv.bp1.readCount + sv.bp2.readCount);
+    }
+    BOOST_REQUIRE_EQUAL(readCount,0u);
+}
+
+
+
+/// cluster by repeatedly merging any intersecting pair of clusters
+static
+void
+getReferenceClusters(
+    const std::vector<SVCandidate>& cands,
+    std::vector<unsigned>& candSVIndex,
+    std::vector<SVCandidate>& svs)
+{
+    svs = cands;
+    std::vector<unsigned> clusterIndex(cands.size());
+    for (unsigned i(0); i<cands.size(); ++i) clusterIndex[i] = i;
+
+    bool isMerged(true);
+    while (isMerged)
+    {
+        isMerged=false;
+        for (unsigned j(1); (j<svs.size()) && (! isMerged); ++j)
+        {
+            for (unsigned i(0); i<j; ++i)
+            {
+                if (! svs[i].isIntersect(svs[j])) continue;
+                svs[i].merge(svs[j]);
+                svs.erase(svs.begin()+j);
+                for (unsigned c(0); c<cands.size(); ++c)
+                {
+                    if (clusterIndex[c] == j) clusterIndex[c] = i;
+                    else if (clusterIndex[c] > j) clusterIndex[c]--;
+                }
+                isMerged=true;
+                break;
+            }
+        }
+    }
+    candSVIndex = clusterIndex;
+}
+
+
+
+BOOST_AUTO_TEST_CASE( test_SVCandidateClusterRandom )
+{
+    srand(7);
+    for (unsigned testIndex(0); testIndex<20; ++testIndex)
+    {
+        std::vector<SVCandidate> cands;
+        for (unsigned candIndex(0); candIndex<200; ++candIndex)
+        {
+            const pos_t begin1(rand()%1500);
+            const pos_t begin2(rand()%1500);
+            SVCandidate cand(getCandidate(rand()%2,begin1,begin1+1+rand()%100,2,begin2,begin2+1+rand()%100));
+
+            // in the second half of the tests, add candidates with the same orientation and chromosome
+            // on both breakends, which can also intersect in crossed breakend order:
+            if ((testIndex >= 10) && (rand()%2))
+            {
+                cand.bp2.interval.tid = cand.bp1.interval.tid;
+                cand.bp2.state = cand.bp1.state;
+            }
+            if (rand()%2) std::swap(cand.bp1,cand.bp2);
+            cands.push_back(cand);
+        }
+
+        std::vector<unsigned> candSVIndex;
+        std::vector<SVCandidate> svs;
+        clusterSVCandidates(cands,candSVIndex,svs);
+
+        if (testIndex >= 10)
+        {
+            checkClusters(cands,candSVIndex,svs);
+            continue;
+        }
+
+        std::vector<unsigned> expectCandSVIndex;
+        std::vector<SVCandidate> expectSVs;
+        getReferenceClusters(cands,expectCandSVIndex,expectSVs);
+
+        BOOST_REQUIRE_EQUAL(svs.size(),expectSVs.size());
+        BOOST_REQUIRE(candSVIndex == expectCandSVIndex);
+        for (unsigned svIndex(0); svIndex<svs.size(); ++svIndex)
+        {
+            BOOST_REQUIRE(svs[svIndex].bp1.interval == expectSVs[svIndex].bp1.interval);
+            BOOST_REQUIRE(svs[svIndex].bp2.interval == expectSVs[svIndex].bp2.interval);
+            BOOST_REQUIRE_EQUAL(svs[svIndex].bp1.readCount,expectSVs[svIndex].bp1.readCount);
+            BOOST_REQUIRE_EQUAL(svs[svIndex].bp2.readCount,expectSVs[svIndex].bp2.readCount);
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
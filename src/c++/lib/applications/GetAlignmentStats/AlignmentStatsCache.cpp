@@ -0,0 +1,168 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+/// \file
+
+/// \author Chris Saunders
+///
+
+#include "AlignmentStatsCache.hh"
+
+#include "blt_util/bam_streamer.hh"
+#include "blt_util/hash_util.hh"
+#include "blt_util/log.hh"
+
+#include "boost/archive/binary_iarchive.hpp"
+#include "boost/archive/binary_oarchive.hpp"
+#include "boost/filesystem.hpp"
+
+#include "zlib.h"
+
+#include <stdint.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+
+
+AlignmentStatsCache::
+AlignmentStatsCache(const std::string& cacheDir) :
+    _cacheDir(cacheDir)
+{
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(_cacheDir,ec);
+    if (! boost::filesystem::is_directory(_cacheDir))
+    {
+        log_os << "ERROR: Can't create alignment stats cache directory: " << _cacheDir << "\n";
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+
+std::string
+AlignmentStatsCache::
+getFileKey(const std::string& alignmentFile)
+{
+    namespace bfs = boost::filesystem;
+
+    // checksum the header text and the reference sequence list:
+    uLong headerCrc(crc32(0L, NULL, 0));
+    {
+        const bam_streamer read_stream(alignmentFile.c_str());
+        const bam_header_t& header(*(read_stream.get_header()));
+        headerCrc = crc32(headerCrc, reinterpret_cast<const Bytef*>(header.text), header.l_text);
+        for (int32_t tid(0); tid<header.n_targets; ++tid)
+        {
+            const char* name(header.target_name[tid]);
+            headerCrc = crc32(headerCrc, reinterpret_cast<const Bytef*>(name), strlen(name));
+            headerCrc = crc32(headerCrc, reinterpret_cast<const Bytef*>(&(header.target_len[tid])), sizeof(uint32_t));
+        }
+    }
+
+    std::ostringstream oss;
+    oss << alignmentFile
+        << '\t' << bfs::file_size(alignmentFile)
+        << '\t' << bfs::last_write_time(alignmentFile)
+        << '\t' << std::hex << headerCrc;
+    return oss.str();
+}
+
+
+
+std::string
+AlignmentStatsCache::
+getEntryPath(const std::string& fileKey) const
+{
+    // name entries by two independent 32 bit hashes of the key, the full key is
+    // stored in the entry to catch any remaining collisions:
+    const uint32_t fnvHash(fnv1a_hash(fileKey.c_str(),fileKey.size()));
+    const uLong crcHash(crc32(crc32(0L, NULL, 0), reinterpret_cast<const Bytef*>(fileKey.c_str()), fileKey.size()));
+
+    std::ostringstream oss;
+    oss << std::hex << std::setfill('0') << std::setw(8) << fnvHash << std::setw(8) << crcHash << ".stats";
+    return (boost::filesystem::path(_cacheDir) / oss.str()).string();
+}
+
+
+
+bool
+AlignmentStatsCache::
+get(const std::string& alignmentFile,
+    ReadGroupStatsSet& rstats) const
+{
+    using namespace boost::archive;
+
+    const std::string fileKey(getFileKey(alignmentFile));
+    const std::string entryPath(getEntryPath(fileKey));
+    if (! boost::filesystem::exists(entryPath)) return false;
+
+    try
+    {
+        std::ifstream ifs(entryPath.c_str(), std::ios::binary);
+        binary_iarchive ia(ifs);
+
+        std::string entryKey;
+        ia >> entryKey;
+        if (entryKey != fileKey) return false;
+        ia >> rstats;
+    }
+    catch (const archive_exception&)
+    {
+        // treat an unreadable entry as a cache miss:
+        log_os << "WARNING: Ignoring unreadable alignment stats cache entry: " << entryPath << "\n";
+        rstats.clear();
+        return false;
+    }
+    return true;
+}
+
+
+
+void
+AlignmentStatsCache::
+set(const std::string& alignmentFile,
+    const ReadGroupStatsSet& rstats) const
+{
+    using namespace boost::archive;
+
+    const std::string fileKey(getFileKey(alignmentFile));
+    const std::string entryPath(getEntryPath(fileKey));
+
+    // write to a temporary file and rename so that concurrent runs never read a partial entry:
+    std::ostringstream tmpPath;
+    tmpPath << entryPath << ".tmp." << getpid();
+    {
+        std::ofstream ofs(tmpPath.str().c_str(), std::ios::binary);
+        if (! ofs)
+        {
+            log_os << "WARNING: Can't write alignment stats cache entry: " << tmpPath.str() << "\n";
+            return;
+        }
+        binary_oarchive oa(ofs);
+        oa << fileKey << rstats;
+    }
+
+    boost::system::error_code ec;
+    boost::filesystem::rename(tmpPath.str(),entryPath,ec);
+    if (ec)
+    {
+        log_os << "WARNING: Can't write alignment stats cache entry: " << entryPath << "\n";
+        boost::filesystem::remove(tmpPath.str(),ec);
+    }
+}
@@ -0,0 +1,59 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+/// \file
+
+/// \author Chris Saunders
+///
+
+#pragma once
+
+#include "manta/ReadGroupStatsSet.hh"
+
+#include <string>
+
+
+/// stores alignment stats estimates in a directory so that they can be reused across runs
+///
+/// entries are keyed on the identity of each alignment file: its path, size, modification
+/// time and a checksum of its header, so any change to the file invalidates its entry
+///
+struct AlignmentStatsCache
+{
+    explicit
+    AlignmentStatsCache(const std::string& cacheDir);
+
+    /// if stats for alignmentFile are cached, copy them into rstats
+    ///
+    /// \returns true if a valid entry was found
+    bool
+    get(const std::string& alignmentFile,
+        ReadGroupStatsSet& rstats) const;
+
+    /// store stats for alignmentFile, replacing any existing entry
+    void
+    set(const std::string& alignmentFile,
+        const ReadGroupStatsSet& rstats) const;
+
+private:
+
+    /// get the identity string of an alignment file
+    static
+    std::string
+    getFileKey(const std::string& alignmentFile);
+
+    std::string
+    getEntryPath(const std::string& fileKey) const;
+
+    std::string _cacheDir;
+};
@@ -89,7 +89,15 @@ parseAlignmentStatsOptions(const manta::Program& prog,
     ("tumor-align-file", po::value(&tumorAlignmentFilename),
      "tumor sample alignment file in bam format (may be specified multiple times)")
     ("output-file", po::value(&opt.outputFilename),
-     "write stats to filename (default: stdout)");
+     "write stats to filename (default: stdout)")
+    ("output-binary-file", po::value(&opt.binaryOutputFilename),
+     "also write stats to filename in a binary format which is faster to load (optional)")
+    ("cache-dir", po::value(&opt.cacheDir),
+     "reuse stats from previous runs on the same alignment files stored in this directory, and add new results to it (optional)")
+    ("decompress-threads", po::value(&opt.decompressThreadCount)->default_value(opt.decompressThreadCount),
+     "number of threads used to decompress each alignment file, 0 reads without worker threads")
+    ("threads", po::value(&opt.threadCount)->default_value(opt.threadCount),
+     "number of alignment files processed in parallel");
 
     po::options_description help("help");
     help.add_options()
@@ -132,6 +140,10 @@ parseAlignmentStatsOptions(const manta::Program& prog,
 
 
     // fast check of config state:
+    if (opt.threadCount < 1)
+    {
+        usage(log_os,prog,visible,"threads must be 1 or greater");
+    }
     if (opt.alignmentFilename.empty())
     {
         usage(log_os,prog,visible,"Must specify at least one input alignment file");
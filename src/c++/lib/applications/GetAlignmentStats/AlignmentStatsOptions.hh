@@ -23,9 +23,25 @@
 
 struct AlignmentStatsOptions
 {
+    AlignmentStatsOptions() :
+        decompressThreadCount(0),
+        threadCount(1)
+    {}
 
     std::vector<std::string> alignmentFilename;
     std::string outputFilename;
+
+    /// optionally also write stats in binary format to this file
+    std::string binaryOutputFilename;
+
+    /// directory of cached stats from previous runs, caching is disabled when empty
+    std::string cacheDir;
+
+    /// number of threads used to decompress each alignment file, 0 disables threaded decompression
+    unsigned decompressThreadCount;
+
+    /// number of alignment files processed in parallel
+    unsigned threadCount;
 };
 
 
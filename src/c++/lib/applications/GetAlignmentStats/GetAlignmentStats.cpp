@@ -16,13 +16,73 @@
 #include "AlignmentStatsOptions.hh"
 
 #include "blt_util/log.hh"
+#include "AlignmentStatsCache.hh"
 #include "common/OutStream.hh"
 #include "manta/ReadGroupStatsSet.hh"
 
+#include "boost/bind.hpp"
 #include "boost/foreach.hpp"
+#include "boost/scoped_ptr.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/thread.hpp"
 
 #include <cstdlib>
 
+#include <algorithm>
+#include <map>
+
+
+
+/// estimate stats for one alignment file, including any per read group stats
+static
+void
+estimateFileStats(
+    const AlignmentStatsOptions& opt,
+    const std::string& alignmentFile,
+    ReadGroupStatsSet& fileStats)
+{
+    typedef std::map<std::string,ReadGroupStats> rgstats_t;
+
+    rgstats_t rgStats;
+    fileStats.clear();
+    fileStats.setStats(alignmentFile,ReadGroupStats(alignmentFile,opt.decompressThreadCount,&rgStats));
+    BOOST_FOREACH(const rgstats_t::value_type& val, rgStats)
+    {
+        fileStats.setStats(alignmentFile,val.first,val.second);
+    }
+}
+
+
+
+/// estimate stats for alignment files until none remain, several of these may run in parallel
+static
+void
+alignmentStatsWorker(
+    const AlignmentStatsOptions& opt,
+    std::vector<ReadGroupStatsSet>& fileStats,
+    unsigned& nextFileIndex,
+    boost::mutex& indexMutex)
+{
+    boost::scoped_ptr<AlignmentStatsCache> cache;
+    if (! opt.cacheDir.empty()) cache.reset(new AlignmentStatsCache(opt.cacheDir));
+
+    const unsigned fileCount(opt.alignmentFilename.size());
+    while (true)
+    {
+        unsigned fileIndex(0);
+        {
+            boost::lock_guard<boost::mutex> lock(indexMutex);
+            if (nextFileIndex >= fileCount) return;
+            fileIndex = nextFileIndex++;
+        }
+
+        const std::string& alignmentFile(opt.alignmentFilename[fileIndex]);
+        if (cache && cache->get(alignmentFile,fileStats[fileIndex])) continue;
+
+        estimateFileStats(opt,alignmentFile,fileStats[fileIndex]);
+        if (cache) cache->set(alignmentFile,fileStats[fileIndex]);
+    }
+}
 
 
 static
@@ -42,12 +102,37 @@ runAlignmentStats(const AlignmentStatsOptions& opt)
     }
 
 
-    BOOST_FOREACH(const std::string& file, opt.alignmentFilename)
+    const unsigned fileCount(opt.alignmentFilename.size());
+    std::vector<ReadGroupStatsSet> fileStats(fileCount);
     {
-        rstats.setStats(file,ReadGroupStats(file));
+        unsigned nextFileIndex(0);
+        boost::mutex indexMutex;
+
+        const unsigned threadCount(std::min(opt.threadCount,fileCount));
+        boost::thread_group workers;
+        for (unsigned threadIndex(0); threadIndex<threadCount; ++threadIndex)
+        {
+            workers.create_thread(boost::bind(alignmentStatsWorker,
+                                              boost::cref(opt),
+                                              boost::ref(fileStats),
+                                              boost::ref(nextFileIndex),
+                                              boost::ref(indexMutex)));
+        }
+        workers.join_all();
+    }
+
+    // add stats in input order so that output is independent of thread count:
+    for (unsigned fileIndex(0); fileIndex<fileCount; ++fileIndex)
+    {
+        rstats.merge(fileStats[fileIndex]);
     }
 
     rstats.write(outs.getStream());
+
+    if (! opt.binaryOutputFilename.empty())
+    {
+        rstats.save(opt.binaryOutputFilename.c_str());
+    }
 }
 
 
@@ -61,6 +61,10 @@ parseMSLOptions(const manta::Program& prog,
      "input sv locus graph file (may be specified multiple times)")
     ("output-file", po::value<std::string>(&opt.outputFilename),
      "merged output sv locus graph file")
+    ("depth-index-file", po::value<std::vector<std::string> >(&opt.depthIndexFilename),
+     "input binned depth index file (may be specified multiple times, optional)")
+    ("depth-index-output-file", po::value<std::string>(&opt.depthIndexOutputFilename),
+     "merged output binned depth index file (required if any depth index files are given)")
     ("verbose",
      "provide additional progress logging");
 
@@ -109,6 +113,19 @@ parseMSLOptions(const manta::Program& prog,
     {
         usage(log_os,prog,visible, "Must specify a graph output file");
     }
+    BOOST_FOREACH(const std::string& depthIndexFilename, opt.depthIndexFilename)
+    {
+        if (! boost::filesystem::exists(depthIndexFilename))
+        {
+            std::ostringstream oss;
+            oss << "Depth index file does not exist: '" << depthIndexFilename << "'";
+            usage(log_os,prog,visible,oss.str().c_str());
+        }
+    }
+    if ((! opt.depthIndexFilename.empty()) && opt.depthIndexOutputFilename.empty())
+    {
+        usage(log_os,prog,visible, "Must specify a depth index output file");
+    }
     if (vm.count("verbose")) opt.isVerbose=true;
 }
 
@@ -33,6 +33,11 @@ struct MSLOptions
 
     std::vector<std::string> graphFilename;
     std::string outputFilename;
+
+    /// per-region binned max depth indices from EstimateSVLoci, merged into depthIndexOutputFilename
+    std::vector<std::string> depthIndexFilename;
+    std::string depthIndexOutputFilename;
+
     bool isVerbose;
 };
 
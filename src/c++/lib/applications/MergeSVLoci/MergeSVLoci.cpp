@@ -18,6 +18,7 @@
 #include "MergeSVLoci.hh"
 #include "MSLOptions.hh"
 
+#include "blt_util/depth_bin_index.hh"
 #include "blt_util/log.hh"
 #include "common/OutStream.hh"
 #include "svgraph/SVLocusSet.hh"
@@ -61,6 +62,21 @@ runMSL(const MSLOptions& opt)
 
     mergedSet.finalize();
     mergedSet.save(opt.outputFilename.c_str());
+
+    if (! opt.depthIndexFilename.empty())
+    {
+        depth_bin_index mergedIndex;
+        mergedIndex.load(opt.depthIndexFilename[0].c_str());
+
+        const unsigned indexCount(opt.depthIndexFilename.size());
+        for (unsigned indexIndex(1); indexIndex<indexCount; ++indexIndex)
+        {
+            depth_bin_index inputIndex;
+            inputIndex.load(opt.depthIndexFilename[indexIndex].c_str());
+            mergedIndex.merge(inputIndex);
+        }
+        mergedIndex.save(opt.depthIndexOutputFilename.c_str());
+    }
 }
 
 
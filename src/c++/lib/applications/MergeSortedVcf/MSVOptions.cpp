@@ -0,0 +1,122 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+///
+/// \author Chris Saunders
+///
+
+#include "MSVOptions.hh"
+
+#include "blt_util/log.hh"
+
+#include "boost/filesystem.hpp"
+#include "boost/foreach.hpp"
+#include "boost/program_options.hpp"
+
+#include <iostream>
+#include <sstream>
+
+
+
+static
+void
+usage(
+    std::ostream& os,
+    const manta::Program& prog,
+    const boost::program_options::options_description& visible,
+    const char* msg = NULL)
+{
+    os << "\n" << prog.name() << ": merge vcf files sorted in reference order into one BGZF-compressed, tabix indexed vcf\n\n";
+    os << "version: " << prog.version() << "\n\n";
+    os << "usage: " << prog.name() << " [options]\n\n";
+    os << visible << "\n\n";
+
+    if (NULL != msg)
+    {
+        os << msg << "\n\n";
+    }
+    exit(2);
+}
+
+
+void
+parseMSVOptions(const manta::Program& prog,
+                int argc, char* argv[],
+                MSVOptions& opt)
+{
+    namespace po = boost::program_options;
+    po::options_description req("configuration");
+    req.add_options()
+    ("vcf-file", po::value<std::vector<std::string> >(&opt.vcfFilename),
+     "input vcf file, BGZF-compressed or plain text, with records sorted in reference order (may be specified multiple times)")
+    ("ref", po::value<std::string>(&opt.referenceFilename),
+     "fasta reference sequence, the chromosome order of its fasta index is used to merge records (required)")
+    ("output-file", po::value<std::string>(&opt.outputFilename),
+     "merged BGZF-compressed vcf output file, the tabix index is written to the output filename + '.tbi'");
+
+    po::options_description help("help");
+    help.add_options()
+    ("help,h","print this message");
+
+    po::options_description visible("options");
+    visible.add(req).add(help);
+
+    bool po_parse_fail(false);
+    po::variables_map vm;
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, visible,
+                                         po::command_line_style::unix_style ^ po::command_line_style::allow_short), vm);
+        po::notify(vm);
+    }
+    catch (const boost::program_options::error& e)
+    {
+        // todo:: find out what is the more specific exception class thrown by program options
+        log_os << "\nERROR: Exception thrown by option parser: " << e.what() << "\n";
+        po_parse_fail=true;
+    }
+
+    if ((argc<=1) || (vm.count("help")) || po_parse_fail)
+    {
+        usage(log_os,prog,visible);
+    }
+
+    // fast check of config state:
+    if (opt.vcfFilename.empty())
+    {
+        usage(log_os,prog,visible, "Must specify at least one input vcf file");
+    }
+    BOOST_FOREACH(const std::string& vcfFilename, opt.vcfFilename)
+    {
+        if (! boost::filesystem::exists(vcfFilename))
+        {
+            std::ostringstream oss;
+            oss << "Vcf file does not exist: '" << vcfFilename << "'";
+            usage(log_os,prog,visible,oss.str().c_str());
+        }
+    }
+    if (opt.referenceFilename.empty())
+    {
+        usage(log_os,prog,visible, "Must specify a reference fasta file");
+    }
+    if (! boost::filesystem::exists(opt.referenceFilename+".fai"))
+    {
+        std::ostringstream oss;
+        oss << "Reference fasta index file does not exist: '" << opt.referenceFilename << ".fai'";
+        usage(log_os,prog,visible,oss.str().c_str());
+    }
+    if (opt.outputFilename.empty())
+    {
+        usage(log_os,prog,visible, "Must specify a vcf output file");
+    }
+}
@@ -0,0 +1,293 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+///
+/// \author Chris Saunders
+///
+
+#include "MergeSortedVcf.hh"
+#include "MSVOptions.hh"
+
+#include "blt_util/bgzf_vcf_writer.hh"
+#include "blt_util/log.hh"
+#include "blt_util/loser_tree.hh"
+#include "blt_util/samtools_fasta_util.hh"
+#include "blt_util/tabix_index_builder.hh"
+
+#include "boost/foreach.hpp"
+#include "boost/shared_ptr.hpp"
+#include "boost/utility.hpp"
+
+#include "zlib.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+
+
+/// merge order of a vcf record
+struct VcfMergeKey
+{
+    VcfMergeKey() :
+        tid(0),
+        pos(0)
+    {}
+
+    bool
+    operator<(const VcfMergeKey& rhs) const
+    {
+        if (tid != rhs.tid) return (tid < rhs.tid);
+        return (pos < rhs.pos);
+    }
+
+    int tid;
+    int pos;
+};
+
+
+
+/// reads the header and records of one input vcf file, which may be BGZF-compressed or plain text
+///
+/// only the current line of the file is held in memory
+///
+struct VcfInputFile : private boost::noncopyable
+{
+    explicit
+    VcfInputFile(const std::string& filename) :
+        _filename(filename),
+        _fp(gzopen(filename.c_str(),"r")),
+        _isRecord(false),
+        _tid(0)
+    {
+        if (NULL == _fp)
+        {
+            log_os << "ERROR: Failed to open input vcf file: " << filename << "\n";
+            exit(EXIT_FAILURE);
+        }
+        gzbuffer(_fp,readBufferSize);
+
+        // read the header, leaving the first record as the current line:
+        while (nextLine() && (_line[0] == '#'))
+        {
+            _header += _line;
+        }
+        _isRecord = (! _line.empty());
+    }
+
+    ~VcfInputFile()
+    {
+        gzclose(_fp);
+    }
+
+    const std::string&
+    header() const
+    {
+        return _header;
+    }
+
+    /// true if there is a current record
+    bool
+    isRecord() const
+    {
+        return _isRecord;
+    }
+
+    /// the current record, including its newline
+    const std::string&
+    record() const
+    {
+        return _line;
+    }
+
+    /// get the merge key of the current record, where chromIndex gives the reference order of each chromosome
+    void
+    getKey(
+        const std::map<std::string,int>& chromIndex,
+        VcfMergeKey& key)
+    {
+        assert(_isRecord);
+
+        int endPos(0);
+        if (! get_vcf_record_range(_line.c_str(),_line.size(),_keyChrom,key.pos,endPos))
+        {
+            log_os << "ERROR: Can't parse record in input vcf file: " << _filename << " record: '" << _line << "'\n";
+            exit(EXIT_FAILURE);
+        }
+
+        // records of each chromosome are contiguous, so the chromosome lookup is only needed when it changes:
+        if ((_chrom.empty()) || (_keyChrom != _chrom))
+        {
+            const std::map<std::string,int>::const_iterator iter(chromIndex.find(_keyChrom));
+            if (iter == chromIndex.end())
+            {
+                log_os << "ERROR: Chromosome '" << _keyChrom << "' in input vcf file: " << _filename << " is not found in the reference\n";
+                exit(EXIT_FAILURE);
+            }
+            _chrom = _keyChrom;
+            _tid = iter->second;
+        }
+        key.tid = _tid;
+    }
+
+    /// move to the next record
+    void
+    next()
+    {
+        _isRecord = nextLine();
+    }
+
+    const std::string&
+    filename() const
+    {
+        return _filename;
+    }
+
+private:
+
+    /// read the next line into _line, including its newline
+    ///
+    /// \returns false at the end of the file
+    bool
+    nextLine()
+    {
+        _line.clear();
+        while (NULL != gzgets(_fp,_buffer,sizeof(_buffer)))
+        {
+            _line.append(_buffer);
+            if (_line[_line.size()-1] == '\n') return true;
+        }
+
+        int errnum(0);
+        gzerror(_fp,&errnum);
+        if ((Z_OK != errnum) && (Z_STREAM_END != errnum))
+        {
+            log_os << "ERROR: Failed to read input vcf file: " << _filename << "\n";
+            exit(EXIT_FAILURE);
+        }
+
+        // complete a final line without a newline:
+        if (_line.empty()) return false;
+        _line.push_back('\n');
+        return true;
+    }
+
+    enum { readBufferSize = 128*1024 };
+
+    std::string _filename;
+    gzFile _fp;
+    char _buffer[8192];
+    std::string _header;
+    std::string _line;
+    bool _isRecord;
+
+    // chromosome and index of the last record key:
+    std::string _chrom;
+    int _tid;
+    std::string _keyChrom;
+};
+
+
+
+static
+void
+runMSV(const MSVOptions& opt)
+{
+    std::vector<std::string> chromNames;
+    get_chrom_names(opt.referenceFilename+".fai",chromNames);
+
+    std::map<std::string,int> chromIndex;
+    const unsigned chromCount(chromNames.size());
+    for (unsigned tid(0); tid<chromCount; ++tid)
+    {
+        chromIndex[chromNames[tid]] = tid;
+    }
+
+    typedef boost::shared_ptr<VcfInputFile> inputPtr;
+    std::vector<inputPtr> inputs;
+    BOOST_FOREACH(const std::string& vcfFile, opt.vcfFilename)
+    {
+        // avoid creating shared_ptr temporaries:
+        inputPtr tmp(new VcfInputFile(vcfFile));
+        inputs.push_back(tmp);
+    }
+
+    const unsigned inputCount(inputs.size());
+
+    bgzf_vcf_writer writer(opt.outputFilename);
+
+    // take the header from the first input which has one:
+    for (unsigned inputIndex(0); inputIndex<inputCount; ++inputIndex)
+    {
+        const std::string& header(inputs[inputIndex]->header());
+        if (header.empty()) continue;
+        writer.write_header(header.c_str(),header.size());
+        break;
+    }
+
+    // merge records in reference order, records with the same position are merged in input file order:
+    std::vector<VcfMergeKey> lastKeys(inputCount);
+    loser_tree<VcfMergeKey> mergeTree(inputCount);
+    for (unsigned inputIndex(0); inputIndex<inputCount; ++inputIndex)
+    {
+        VcfInputFile& input(*inputs[inputIndex]);
+        if (! input.isRecord()) continue;
+        input.getKey(chromIndex,lastKeys[inputIndex]);
+        mergeTree.set_source(inputIndex,lastKeys[inputIndex]);
+    }
+    mergeTree.build();
+
+    VcfMergeKey key;
+    while (! mergeTree.empty())
+    {
+        const unsigned inputIndex(mergeTree.top());
+        VcfInputFile& input(*inputs[inputIndex]);
+        writer.write_record(input.record().c_str(),input.record().size());
+
+        input.next();
+        if (! input.isRecord())
+        {
+            mergeTree.pop_top();
+            continue;
+        }
+
+        input.getKey(chromIndex,key);
+        if (key < lastKeys[inputIndex])
+        {
+            log_os << "ERROR: Input vcf file is not sorted in reference order: " << input.filename()
+                   << " at record: '" << input.record() << "'\n";
+            exit(EXIT_FAILURE);
+        }
+        lastKeys[inputIndex] = key;
+        mergeTree.replace_top_run(key);
+    }
+
+    writer.close(opt.outputFilename+".tbi");
+}
+
+
+
+void
+MergeSortedVcf::
+runInternal(int argc, char* argv[]) const
+{
+
+    MSVOptions opt;
+
+    parseMSVOptions(*this,argc,argv,opt);
+    runMSV(opt);
+}
@@ -0,0 +1,36 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+///
+/// \author Chris Saunders
+///
+
+#pragma once
+
+#include "manta/Program.hh"
+
+
+/// merge vcf files, each sorted in reference order, into a single BGZF-compressed and tabix indexed vcf
+///
+struct MergeSortedVcf : public manta::Program
+{
+
+    const char*
+    name() const
+    {
+        return "MergeSortedVcf";
+    }
+
+    void
+    runInternal(int argc, char* argv[]) const;
+};
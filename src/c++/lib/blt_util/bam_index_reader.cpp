@@ -0,0 +1,248 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+/// \file
+
+/// \author Chris Saunders
+///
+
+#include "blt_util/bam_index_reader.hh"
+#include "blt_util/log.hh"
+
+#include "boost/filesystem.hpp"
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+
+
+/// read one little-endian value from the index stream
+template <typename T>
+static
+void
+read_index_value(
+    std::istream& is,
+    const std::string& index_filename,
+    T& val)
+{
+    unsigned char buff[sizeof(T)];
+    is.read(reinterpret_cast<char*>(buff),sizeof(T));
+    if (! is)
+    {
+        log_os << "ERROR: Unexpected end of BAM index file: " << index_filename << "\n";
+        exit(EXIT_FAILURE);
+    }
+    val = 0;
+    for (unsigned i(0); i<sizeof(T); ++i)
+    {
+        val |= (static_cast<T>(buff[i]) << (8*i));
+    }
+}
+
+
+
+/// find the index filename using the same conventions as samtools
+static
+std::string
+get_index_filename(const char* bam_filename)
+{
+    std::string index_filename(bam_filename);
+    index_filename += ".bai";
+    if (boost::filesystem::exists(index_filename)) return index_filename;
+
+    static const std::string bam_ext(".bam");
+    const std::string bam(bam_filename);
+    if ((bam.size() > bam_ext.size()) &&
+        (0 == bam.compare(bam.size()-bam_ext.size(),bam_ext.size(),bam_ext)))
+    {
+        index_filename = bam.substr(0,bam.size()-bam_ext.size()) + ".bai";
+        if (boost::filesystem::exists(index_filename)) return index_filename;
+    }
+
+    log_os << "ERROR: BAM index is not available for file: " << bam_filename << "\n";
+    exit(EXIT_FAILURE);
+}
+
+
+
+bam_index_reader::
+bam_index_reader(const char* bam_filename)
+{
+    const std::string index_filename(get_index_filename(bam_filename));
+
+    std::ifstream is(index_filename.c_str(), std::ios::binary);
+    if (! is)
+    {
+        log_os << "ERROR: Failed to open BAM index file: " << index_filename << "\n";
+        exit(EXIT_FAILURE);
+    }
+
+    char magic[4];
+    is.read(magic,4);
+    if ((! is) || (0 != strncmp(magic,"BAI\1",4)))
+    {
+        log_os << "ERROR: Unexpected BAM index format in file: " << index_filename << "\n";
+        exit(EXIT_FAILURE);
+    }
+
+    int32_t n_ref(0);
+    read_index_value(is,index_filename,n_ref);
+    _refs.resize(n_ref);
+
+    for (int32_t ref(0); ref<n_ref; ++ref)
+    {
+        ref_index& rindex(_refs[ref]);
+
+        int32_t n_bin(0);
+        read_index_value(is,index_filename,n_bin);
+        for (int32_t binIndex(0); binIndex<n_bin; ++binIndex)
+        {
+            uint32_t bin(0);
+            int32_t n_chunk(0);
+            read_index_value(is,index_filename,bin);
+            read_index_value(is,index_filename,n_chunk);
+            std::vector<bam_index_chunk>& chunks(rindex.bins[bin]);
+            chunks.resize(n_chunk);
+            for (int32_t chunkIndex(0); chunkIndex<n_chunk; ++chunkIndex)
+            {
+                read_index_value(is,index_filename,chunks[chunkIndex].beg);
+                read_index_value(is,index_filename,chunks[chunkIndex].end);
+            }
+        }
+
+        int32_t n_intv(0);
+        read_index_value(is,index_filename,n_intv);
+        rindex.linear.resize(n_intv);
+        for (int32_t intvIndex(0); intvIndex<n_intv; ++intvIndex)
+        {
+            read_index_value(is,index_filename,rindex.linear[intvIndex]);
+        }
+    }
+}
+
+
+
+/// list all bins which may hold reads overlapping zero-indexed [beg,end)
+///
+/// follows reg2bins from the SAM specification
+///
+static
+void
+region_to_bins(
+    uint32_t beg,
+    uint32_t end,
+    std::vector<unsigned>& bins)
+{
+    bins.clear();
+    if (beg >= end) return;
+    if (end >= (1u<<29)) end = (1u<<29);
+    --end;
+    bins.push_back(0);
+    for (unsigned k(1 + (beg>>26)); k <= (1 + (end>>26)); ++k) bins.push_back(k);
+    for (unsigned k(9 + (beg>>23)); k <= (9 + (end>>23)); ++k) bins.push_back(k);
+    for (unsigned k(73 + (beg>>20)); k <= (73 + (end>>20)); ++k) bins.push_back(k);
+    for (unsigned k(585 + (beg>>17)); k <= (585 + (end>>17)); ++k) bins.push_back(k);
+    for (unsigned k(4681 + (beg>>14)); k <= (4681 + (end>>14)); ++k) bins.push_back(k);
+}
+
+
+
+void
+bam_index_reader::
+get_region_chunks(
+    const int tid,
+    int beg,
+    const int end,
+    std::vector<bam_index_chunk>& chunks) const
+{
+    chunks.clear();
+
+    if ((tid < 0) || (tid >= static_cast<int>(_refs.size()))) return;
+    if (beg < 0) beg = 0;
+    if (end < beg) return;
+
+    const ref_index& rindex(_refs[tid]);
+
+    // find the minimum offset of any read overlapping beg from the linear index:
+    uint64_t min_off(0);
+    if (! rindex.linear.empty())
+    {
+        const unsigned nlinear(rindex.linear.size());
+        const unsigned window(beg>>linear_shift);
+        min_off = ((window >= nlinear) ? rindex.linear[nlinear-1] : rindex.linear[window]);
+        if (0 == min_off)
+        {
+            // index files without filled linear offsets:
+            for (int i(std::min(window,nlinear)-1); i>=0; --i)
+            {
+                if (0 == rindex.linear[i]) continue;
+                min_off = rindex.linear[i];
+                break;
+            }
+        }
+    }
+
+    std::vector<unsigned> bins;
+    region_to_bins(beg,end,bins);
+
+    const ref_index::bin_map::const_iterator binEnd(rindex.bins.end());
+    for (std::vector<unsigned>::const_iterator biter(bins.begin()); biter!=bins.end(); ++biter)
+    {
+        const ref_index::bin_map::const_iterator binIter(rindex.bins.find(*biter));
+        if (binIter == binEnd) continue;
+        const std::vector<bam_index_chunk>& binChunks(binIter->second);
+        for (std::vector<bam_index_chunk>::const_iterator citer(binChunks.begin()); citer!=binChunks.end(); ++citer)
+        {
+            if (citer->end > min_off) chunks.push_back(*citer);
+        }
+    }
+
+    if (chunks.empty()) return;
+
+    std::sort(chunks.begin(),chunks.end());
+
+    // resolve completely contained adjacent chunks:
+    unsigned last(0);
+    const unsigned chunkCount(chunks.size());
+    for (unsigned i(1); i<chunkCount; ++i)
+    {
+        if (chunks[last].end < chunks[i].end) chunks[++last] = chunks[i];
+    }
+    chunks.resize(last+1);
+
+    // resolve overlaps between adjacent chunks:
+    for (unsigned i(1); i<chunks.size(); ++i)
+    {
+        if (chunks[i-1].end >= chunks[i].beg) chunks[i-1].end = chunks[i].beg;
+    }
+
+    // merge chunks which start and end in the same compressed block:
+    last=0;
+    for (unsigned i(1); i<chunks.size(); ++i)
+    {
+        if ((chunks[last].end>>16) == (chunks[i].beg>>16))
+        {
+            chunks[last].end = chunks[i].end;
+        }
+        else
+        {
+            chunks[++last] = chunks[i];
+        }
+    }
+    chunks.resize(last+1);
+}
@@ -0,0 +1,111 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+/// \file
+
+/// \author Chris Saunders
+///
+
+#pragma once
+
+#include "boost/utility.hpp"
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+
+/// a contiguous section of a bgzf file, given as a pair of virtual file offsets
+///
+/// virtual offsets are formatted as (compressed block address << 16 | offset within the uncompressed block)
+///
+struct bam_index_chunk
+{
+    bam_index_chunk(
+        const uint64_t init_beg = 0,
+        const uint64_t init_end = 0) :
+        beg(init_beg),
+        end(init_end)
+    {}
+
+    bool
+    operator<(const bam_index_chunk& rhs) const
+    {
+        return (beg < rhs.beg);
+    }
+
+    uint64_t beg;
+    uint64_t end;
+};
+
+
+
+/// read the samtools BAM index format directly
+///
+/// This provides the same region to file chunk translation as samtools' bam_iter_query,
+/// but exposes the chunk list and linear index to the client so that reading can be
+/// planned ahead of time
+///
+struct bam_index_reader : private boost::noncopyable
+{
+    /// load the index associated with bam_filename
+    explicit
+    bam_index_reader(const char* bam_filename);
+
+    /// number of reference sequences in the index
+    unsigned
+    ref_count() const
+    {
+        return _refs.size();
+    }
+
+    /// get the ordered, merged list of bam file chunks which may contain reads overlapping
+    /// the zero-indexed region [beg,end) of reference tid
+    void
+    get_region_chunks(
+        const int tid,
+        int beg,
+        const int end,
+        std::vector<bam_index_chunk>& chunks) const;
+
+    /// get the linear index for reference tid, this contains the minimum virtual offset
+    /// of any read overlapping each 16kb window of the reference
+    const std::vector<uint64_t>&
+    get_linear_index(const int tid) const
+    {
+        return _refs[tid].linear;
+    }
+
+    /// size in bases of each linear index window
+    static
+    unsigned
+    linear_window_size()
+    {
+        return (1u << linear_shift);
+    }
+
+private:
+    enum { linear_shift = 14 };
+
+    struct ref_index
+    {
+        typedef std::map<unsigned, std::vector<bam_index_chunk> > bin_map;
+
+        bin_map bins;
+        std::vector<uint64_t> linear;
+    };
+
+    std::vector<ref_index> _refs;
+};
@@ -22,14 +22,18 @@
 #include <cstdlib>
 
 #include <iostream>
+#include <limits>
 
 
 
 bam_streamer::
 bam_streamer(const char* filename,
-             const char* region)
+             const char* region,
+             const unsigned decompress_thread_count)
     : _is_record_set(false), _bfp(NULL), _bidx(NULL), _biter(NULL),
-      _record_no(0), _stream_name(filename), _is_region(false)
+      _record_no(0), _stream_name(filename), _is_region(false),
+      _chunk_index(-1), _curr_off(0), _region_tid(-1), _region_beg(0), _region_end(0),
+      _is_region_finished(false)
 {
 
     assert(NULL != filename);
@@ -43,6 +47,19 @@ bam_streamer(const char* filename,
         exit(EXIT_FAILURE);
     }
 
+    // threaded decompression is only available for local little-endian BAM files, otherwise
+    // fall back to samtools:
+    if ((decompress_thread_count > 0) && (_bfp->type&0x01) && (! bam_is_be))
+    {
+        _preader.reset(new bgzf_parallel_reader(filename,decompress_thread_count));
+
+        // start reading immediately after the header:
+        const uint64_t record_start(bam_tell(_bfp->x.bam));
+        std::vector<bgzf_block_range> plan(1,bgzf_block_range((record_start>>16),std::numeric_limits<int64_t>::max()));
+        _preader->set_plan(plan);
+        _preader->seek(record_start);
+    }
+
 
     if (NULL == region)
     {
@@ -81,6 +98,12 @@ bam_streamer::
 _load_index()
 {
 
+    if (_preader)
+    {
+        if (! _pidx) _pidx.reset(new bam_index_reader(name()));
+        return;
+    }
+
     if (NULL != _bidx) return;
 
     // use the BAM index to read a region of the BAM file
@@ -124,6 +147,7 @@ set_new_region(const int ref, const int beg, const int end)
 {
 
     if (NULL != _biter) bam_iter_destroy(_biter);
+    _biter = NULL;
 
     _load_index();
 
@@ -133,7 +157,27 @@ set_new_region(const int ref, const int beg, const int end)
         exit(EXIT_FAILURE);
     }
 
-    _biter = bam_iter_query(_bidx,ref,beg,end);
+    if (_preader)
+    {
+        _pidx->get_region_chunks(ref,beg,end,_chunks);
+        _chunk_index = -1;
+        _curr_off = 0;
+        _region_tid = ref;
+        _region_beg = std::max(0,beg);
+        _region_end = end;
+        _is_region_finished = (end < beg);
+
+        std::vector<bgzf_block_range> plan;
+        for (std::vector<bam_index_chunk>::const_iterator iter(_chunks.begin()); iter!=_chunks.end(); ++iter)
+        {
+            plan.push_back(bgzf_block_range((iter->beg>>16),(iter->end>>16)));
+        }
+        _preader->set_plan(plan);
+    }
+    else
+    {
+        _biter = bam_iter_query(_bidx,ref,beg,end);
+    }
     _is_region = true;
     _region.clear();
 
@@ -142,23 +186,59 @@ set_new_region(const int ref, const int beg, const int end)
 }
 
 
+void
+bam_streamer::
+prefetch_region(const int ref, const int beg, const int end)
+{
+    if (ref < 0) return;
+    if (! (_bfp->type&0x01)) return;
+
+    if (! _pidx) _pidx.reset(new bam_index_reader(name()));
+    if (! _prefetcher)
+    {
+        const bool is_store_blocks(NULL != _preader.get());
+        _prefetcher.reset(new bgzf_prefetcher(name(),is_store_blocks));
+        if (_preader) _preader->set_prefetcher(_prefetcher.get());
+    }
+
+    std::vector<bam_index_chunk> chunks;
+    _pidx->get_region_chunks(ref,beg,end,chunks);
+
+    std::vector<bgzf_block_range> ranges;
+    for (std::vector<bam_index_chunk>::const_iterator iter(chunks.begin()); iter!=chunks.end(); ++iter)
+    {
+        ranges.push_back(bgzf_block_range((iter->beg>>16),(iter->end>>16)));
+    }
+    _prefetcher->add_request(ranges);
+}
+
+
+
 bool
 bam_streamer::
 next()
 {
     if (NULL==_bfp) return false;
 
-    int ret;
-    if (NULL == _biter)
+    if (_preader)
     {
-        ret = samread(_bfp, _brec._bp);
+        _is_record_set=_next_parallel();
     }
     else
     {
-        ret = bam_iter_read(_bfp->x.bam, _biter, _brec._bp);
+        int ret;
+        if (NULL == _biter)
+        {
+            ret = samread(_bfp, _brec._bp);
+        }
+        else
+        {
+            ret = bam_iter_read(_bfp->x.bam, _biter, _brec._bp);
+        }
+
+        _is_record_set=(ret >= 0);
     }
 
-    _is_record_set=(ret >= 0);
     if (_is_record_set) _record_no++;
 
     return _is_record_set;
@@ -166,6 +246,108 @@ next()
 
 
 
+int
+bam_streamer::
+_read_parallel_record()
+{
+    static const int core_size(32);
+
+    bam1_t& b(*(_brec._bp));
+    bam1_core_t& c(b.core);
+
+    int32_t block_len(0);
+    const int ret(_preader->read(&block_len,4));
+    if (ret != 4)
+    {
+        if (ret == 0) return -1; // normal end-of-file
+        else return -2; // truncated
+    }
+
+    uint32_t x[8];
+    if (_preader->read(x,core_size) != core_size) return -3;
+    c.tid = x[0];
+    c.pos = x[1];
+    c.bin = x[2]>>16;
+    c.qual = x[2]>>8&0xff;
+    c.l_qname = x[2]&0xff;
+    c.flag = x[3]>>16;
+    c.n_cigar = x[3]&0xffff;
+    c.l_qseq = x[4];
+    c.mtid = x[5];
+    c.mpos = x[6];
+    c.isize = x[7];
+
+    b.data_len = block_len - core_size;
+    if (b.m_data < b.data_len)
+    {
+        b.m_data = b.data_len;
+        kroundup32(b.m_data);
+        b.data = (uint8_t*)realloc(b.data, b.m_data);
+    }
+    if (_preader->read(b.data, b.data_len) != b.data_len) return -4;
+    b.l_aux = b.data_len - c.n_cigar * 4 - c.l_qname - c.l_qseq - (c.l_qseq+1)/2;
+    return 4 + block_len;
+}
+
+
+
+bool
+bam_streamer::
+_next_parallel()
+{
+    if (! _is_region)
+    {
+        const int ret(_read_parallel_record());
+        if (ret < -1)
+        {
+            log_os << "ERROR: Failed to read record from BAM file: " << name() << "\n";
+            exit(EXIT_FAILURE);
+        }
+        return (ret >= 0);
+    }
+
+    if (_is_region_finished) return false;
+
+    while (true)
+    {
+        if ((0 == _curr_off) || ((_chunk_index >= 0) && (_curr_off >= _chunks[_chunk_index].end)))
+        {
+            // jump to the next chunk:
+            if ((_chunk_index+1) >= static_cast<int>(_chunks.size())) break;
+            if ((_chunk_index < 0) || (_chunks[_chunk_index].end != _chunks[_chunk_index+1].beg))
+            {
+                _preader->seek(_chunks[_chunk_index+1].beg);
+                _curr_off = _preader->tell();
+            }
+            _chunk_index++;
+        }
+
+        const int ret(_read_parallel_record());
+        if (ret < 0)
+        {
+            if (ret < -1)
+            {
+                log_os << "ERROR: Failed to read record from BAM file: " << name() << "\n";
+                exit(EXIT_FAILURE);
+            }
+            break;
+        }
+
+        _curr_off = _preader->tell();
+        const bam1_t& b(*(_brec._bp));
+        if ((b.core.tid != _region_tid) || (b.core.pos >= _region_end)) break;
+
+        // test for overlap with the region:
+        const int rend(b.core.n_cigar ? bam_calend(&b.core, bam1_cigar(&b)) : (b.core.pos + 1));
+        if ((rend > _region_beg) && (b.core.pos < _region_end)) return true;
+    }
+
+    _is_region_finished = true;
+    return false;
+}
+
+
+
 const char*
 bam_streamer::
 target_id_to_name(const int32_t tid) const
@@ -17,8 +17,12 @@
 ///
 #pragma once
 
+#include "blt_util/bam_index_reader.hh"
 #include "blt_util/bam_record.hh"
+#include "blt_util/bgzf_parallel_reader.hh"
+#include "blt_util/bgzf_prefetcher.hh"
 
+#include "boost/scoped_ptr.hpp"
 #include "boost/utility.hpp"
 
 #include <string>
@@ -37,9 +41,12 @@
 struct bam_streamer : public boost::noncopyable
 {
 
+    /// \param decompress_thread_count if non-zero, bgzf blocks are decompressed ahead
+    ///                                of the read position on this many worker threads
     explicit
     bam_streamer(const char* filename,
-                 const char* region = NULL);
+                 const char* region = NULL,
+                 const unsigned decompress_thread_count = 0);
 
     ~bam_streamer();
 
@@ -54,6 +61,17 @@ struct bam_streamer : public boost::noncopyable
     void
     set_new_region(int reg, int beg, int end);
 
+    /// \brief start reading a region which is expected to be requested soon in the background
+    ///
+    /// this does not change the current region. when threaded decompression is enabled, the
+    /// prefetched blocks are handed directly to the decompression workers, otherwise the
+    /// prefetch only brings the region into the operating system's file cache.
+    ///
+    /// \param beg zero-indexed start pos
+    /// \param end zero-indexed end pos
+    void
+    prefetch_region(int reg, int beg, int end);
+
     bool next();
 
     const bam_record* get_record_ptr() const
@@ -89,6 +107,16 @@ struct bam_streamer : public boost::noncopyable
 private:
     void _load_index();
 
+    /// read the next record using the threaded bgzf reader
+    ///
+    /// follows the logic of samtools bam_iter_read for region iteration
+    bool _next_parallel();
+
+    /// read the next record in file order from the threaded bgzf reader
+    ///
+    /// returns values follow samtools bam_read1
+    int _read_parallel_record();
+
     bool _is_record_set;
     samfile_t* _bfp;
     bam_index_t* _bidx;
@@ -100,5 +128,18 @@ private:
     std::string _stream_name;
     bool _is_region;
     std::string _region;
+
+    // threaded decompression state, the prefetcher must be declared before the parallel reader
+    // which refers to it:
+    boost::scoped_ptr<bam_index_reader> _pidx;
+    boost::scoped_ptr<bgzf_prefetcher> _prefetcher;
+    boost::scoped_ptr<bgzf_parallel_reader> _preader;
+    std::vector<bam_index_chunk> _chunks;
+    int _chunk_index;
+    uint64_t _curr_off;
+    int _region_tid;
+    int _region_beg;
+    int _region_end;
+    bool _is_region_finished;
 };
 
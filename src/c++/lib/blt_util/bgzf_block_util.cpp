@@ -0,0 +1,72 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+/// \file
+
+/// \author Chris Saunders
+///
+
+#include "blt_util/bgzf_block_util.hh"
+#include "blt_util/log.hh"
+
+#include <cassert>
+#include <cstdlib>
+
+#include <iostream>
+
+
+
+static
+unsigned
+unpack_uint16(const unsigned char* buff)
+{
+    return (buff[0] | (buff[1] << 8));
+}
+
+
+
+bool
+read_bgzf_block(
+    FILE* fp,
+    const char* filename,
+    const int64_t address,
+    std::vector<char>& block,
+    int& block_size)
+{
+    using namespace BGZF_BLOCK;
+
+    assert(block.size() >= MAX_SIZE);
+
+    unsigned char* header(reinterpret_cast<unsigned char*>(&(block[0])));
+    const size_t header_size(fread(header,1,HEADER_SIZE,fp));
+    if (0 == header_size) return false;
+
+    const bool is_header_valid((header_size == HEADER_SIZE) &&
+                               (header[0] == 31) && (header[1] == 139) && (header[2] == 8) && (header[3] & 4) &&
+                               (unpack_uint16(header+10) == 6) && (header[12] == 'B') && (header[13] == 'C') &&
+                               (unpack_uint16(header+14) == 2));
+    if (! is_header_valid)
+    {
+        log_os << "ERROR: Invalid bgzf block header in file: " << filename << " at offset: " << address << "\n";
+        exit(EXIT_FAILURE);
+    }
+
+    block_size = (unpack_uint16(header+16)+1);
+    const size_t remaining(block_size-HEADER_SIZE);
+    if (fread(header+HEADER_SIZE,1,remaining,fp) != remaining)
+    {
+        log_os << "ERROR: Unexpected end of bgzf file: " << filename << "\n";
+        exit(EXIT_FAILURE);
+    }
+    return true;
+}
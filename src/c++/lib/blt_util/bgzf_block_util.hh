@@ -0,0 +1,66 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+/// \file
+
+/// \author Chris Saunders
+///
+
+#pragma once
+
+#include <stdint.h>
+
+#include <cstdio>
+#include <vector>
+
+
+namespace BGZF_BLOCK
+{
+enum
+{
+    HEADER_SIZE = 18,
+    MAX_SIZE = 0x10000
+};
+}
+
+
+
+/// an inclusive range of compressed block addresses in a bgzf file
+struct bgzf_block_range
+{
+    bgzf_block_range(
+        const int64_t init_beg = 0,
+        const int64_t init_end = 0) :
+        beg(init_beg),
+        end(init_end)
+    {}
+
+    int64_t beg;
+    int64_t end;
+};
+
+
+
+/// read the compressed bgzf block at the current position of fp into block
+///
+/// block must be at least BGZF_BLOCK::MAX_SIZE long. filename and address
+/// are used for error messages only.
+///
+/// \returns false at end of file
+bool
+read_bgzf_block(
+    FILE* fp,
+    const char* filename,
+    const int64_t address,
+    std::vector<char>& block,
+    int& block_size);
@@ -0,0 +1,410 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+/// \file
+
+/// \author Chris Saunders
+///
+
+#include "blt_util/bgzf_parallel_reader.hh"
+#include "blt_util/log.hh"
+
+#include "boost/bind.hpp"
+
+#include "zlib.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <iostream>
+
+
+
+bgzf_parallel_reader::
+bgzf_parallel_reader(
+    const char* filename,
+    const unsigned thread_count) :
+    _filename(filename),
+    _fp(NULL),
+    _prefetcher(NULL),
+    _plan_index(0),
+    _fetch_address(0),
+    _is_fetch_seek(false),
+    _slots(std::max(2u,thread_count*4)),
+    _head(0),
+    _slot_count(0),
+    _is_current(false),
+    _block_offset(0),
+    _is_stop(false)
+{
+    _fp = fopen(filename,"rb");
+    if (NULL == _fp)
+    {
+        log_os << "ERROR: Failed to open bgzf file: " << filename << "\n";
+        exit(EXIT_FAILURE);
+    }
+
+    for (unsigned slotIndex(0); slotIndex<_slots.size(); ++slotIndex)
+    {
+        _slots[slotIndex].compressed.resize(BGZF_BLOCK::MAX_SIZE);
+        _slots[slotIndex].uncompressed.resize(BGZF_BLOCK::MAX_SIZE);
+    }
+
+    for (unsigned threadIndex(0); threadIndex<thread_count; ++threadIndex)
+    {
+        _workers.create_thread(boost::bind(&bgzf_parallel_reader::worker_loop,this));
+    }
+}
+
+
+
+bgzf_parallel_reader::
+~bgzf_parallel_reader()
+{
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        _is_stop=true;
+    }
+    _work_cond.notify_all();
+    _workers.join_all();
+
+    if (NULL != _fp) fclose(_fp);
+}
+
+
+
+void
+bgzf_parallel_reader::
+set_plan(const std::vector<bgzf_block_range>& ranges)
+{
+    clear_slots();
+
+    // merge overlapping ranges:
+    _plan.clear();
+    for (std::vector<bgzf_block_range>::const_iterator iter(ranges.begin()); iter!=ranges.end(); ++iter)
+    {
+        if ((! _plan.empty()) && (iter->beg <= _plan.back().end))
+        {
+            _plan.back().end = std::max(_plan.back().end,iter->end);
+        }
+        else
+        {
+            _plan.push_back(*iter);
+        }
+    }
+
+    _plan_index=0;
+    _is_fetch_seek=true;
+    if (! _plan.empty()) _fetch_address=_plan[0].beg;
+
+    fill_slots();
+}
+
+
+
+void
+bgzf_parallel_reader::
+seek(const uint64_t voffset)
+{
+    const int64_t address(voffset>>16);
+    const int offset(voffset & 0xFFFF);
+
+    while (true)
+    {
+        if (_is_current)
+        {
+            const block_slot& slot(_slots[_head]);
+            if (slot.address == address)
+            {
+                wait_current();
+                _block_offset = offset;
+                return;
+            }
+            if (slot.address > address) break;
+        }
+        if (! next_block()) break;
+    }
+
+    log_os << "ERROR: Attempting to seek outside of read plan for bgzf file: " << _filename << "\n";
+    exit(EXIT_FAILURE);
+}
+
+
+
+int
+bgzf_parallel_reader::
+read(void* data, const int length)
+{
+    char* out(static_cast<char*>(data));
+    int nread(0);
+    while (nread < length)
+    {
+        if ((! _is_current) || (_block_offset >= _slots[_head].uncompressed_size))
+        {
+            if (! next_block()) break;
+            continue;
+        }
+
+        const block_slot& slot(_slots[_head]);
+        const int ncopy(std::min(length-nread,slot.uncompressed_size-_block_offset));
+        memcpy(out+nread,&(slot.uncompressed[_block_offset]),ncopy);
+        _block_offset += ncopy;
+        nread += ncopy;
+    }
+    return nread;
+}
+
+
+
+uint64_t
+bgzf_parallel_reader::
+tell() const
+{
+    if (! _is_current) return (static_cast<uint64_t>(_fetch_address)<<16);
+
+    const block_slot& slot(_slots[_head]);
+    if (_block_offset >= slot.uncompressed_size)
+    {
+        // follow the samtools convention of pointing to the start of the next block:
+        return (static_cast<uint64_t>(slot.address+slot.compressed_size)<<16);
+    }
+    return ((static_cast<uint64_t>(slot.address)<<16) | _block_offset);
+}
+
+
+
+bool
+bgzf_parallel_reader::
+fetch_block()
+{
+    if (_plan_index >= _plan.size()) return false;
+
+    const unsigned slotIndex((_head+_slot_count)%_slots.size());
+    block_slot& slot(_slots[slotIndex]);
+    assert(slot.state == EMPTY);
+
+    int block_size(0);
+    if ((NULL != _prefetcher) && _prefetcher->get_block(_fetch_address,slot.compressed,block_size))
+    {
+        // the file position no longer matches the fetch address:
+        _is_fetch_seek=true;
+    }
+    else
+    {
+        if (_is_fetch_seek)
+        {
+            if (0 != fseeko(_fp,_fetch_address,SEEK_SET))
+            {
+                log_os << "ERROR: Failed to seek in bgzf file: " << _filename << "\n";
+                exit(EXIT_FAILURE);
+            }
+            _is_fetch_seek=false;
+        }
+
+        if (! read_bgzf_block(_fp,_filename.c_str(),_fetch_address,slot.compressed,block_size))
+        {
+            // end of file:
+            _plan_index=_plan.size();
+            return false;
+        }
+    }
+
+    slot.address=_fetch_address;
+    slot.compressed_size=block_size;
+    slot.uncompressed_size=0;
+    slot.is_error=false;
+    _slot_count++;
+
+    _fetch_address += block_size;
+
+    // move on to the next range of the plan:
+    if (_fetch_address > _plan[_plan_index].end)
+    {
+        _plan_index++;
+        if ((_plan_index < _plan.size()) && (_plan[_plan_index].beg != _fetch_address))
+        {
+            _fetch_address=_plan[_plan_index].beg;
+            _is_fetch_seek=true;
+        }
+    }
+
+    if (_workers.size() == 0)
+    {
+        inflate_block(slot);
+        slot.state=READY;
+    }
+    else
+    {
+        {
+            boost::lock_guard<boost::mutex> lock(_mutex);
+            slot.state=QUEUED;
+            _work_queue.push_back(slotIndex);
+        }
+        _work_cond.notify_one();
+    }
+    return true;
+}
+
+
+
+void
+bgzf_parallel_reader::
+fill_slots()
+{
+    while (_slot_count < _slots.size())
+    {
+        if (! fetch_block()) break;
+    }
+}
+
+
+
+bool
+bgzf_parallel_reader::
+next_block()
+{
+    if (_is_current)
+    {
+        _slots[_head].state=EMPTY;
+        _head=(_head+1)%_slots.size();
+        _slot_count--;
+        _is_current=false;
+    }
+
+    fill_slots();
+    if (0 == _slot_count) return false;
+
+    _is_current=true;
+    _block_offset=0;
+    wait_current();
+    return true;
+}
+
+
+
+void
+bgzf_parallel_reader::
+wait_current()
+{
+    block_slot& slot(_slots[_head]);
+    {
+        boost::unique_lock<boost::mutex> lock(_mutex);
+        while (slot.state != READY)
+        {
+            _ready_cond.wait(lock);
+        }
+    }
+
+    if (slot.is_error)
+    {
+        log_os << "ERROR: Failed to decompress bgzf block in file: " << _filename << " at offset: " << slot.address << "\n";
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+
+void
+bgzf_parallel_reader::
+clear_slots()
+{
+    boost::unique_lock<boost::mutex> lock(_mutex);
+
+    for (std::deque<unsigned>::const_iterator iter(_work_queue.begin()); iter!=_work_queue.end(); ++iter)
+    {
+        _slots[*iter].state=EMPTY;
+    }
+    _work_queue.clear();
+
+    while (true)
+    {
+        bool is_inflating(false);
+        for (unsigned slotIndex(0); slotIndex<_slots.size(); ++slotIndex)
+        {
+            if (_slots[slotIndex].state == INFLATING) is_inflating=true;
+        }
+        if (! is_inflating) break;
+        _ready_cond.wait(lock);
+    }
+
+    for (unsigned slotIndex(0); slotIndex<_slots.size(); ++slotIndex)
+    {
+        _slots[slotIndex].state=EMPTY;
+    }
+    _head=0;
+    _slot_count=0;
+    _is_current=false;
+    _block_offset=0;
+}
+
+
+
+void
+bgzf_parallel_reader::
+worker_loop()
+{
+    while (true)
+    {
+        unsigned slotIndex(0);
+        {
+            boost::unique_lock<boost::mutex> lock(_mutex);
+            while (_work_queue.empty() && (! _is_stop))
+            {
+                _work_cond.wait(lock);
+            }
+            if (_is_stop) return;
+            slotIndex=_work_queue.front();
+            _work_queue.pop_front();
+            _slots[slotIndex].state=INFLATING;
+        }
+
+        inflate_block(_slots[slotIndex]);
+
+        {
+            boost::lock_guard<boost::mutex> lock(_mutex);
+            _slots[slotIndex].state=READY;
+        }
+        _ready_cond.notify_all();
+    }
+}
+
+
+
+void
+bgzf_parallel_reader::
+inflate_block(block_slot& slot)
+{
+    z_stream zs;
+    zs.zalloc = NULL;
+    zs.zfree = NULL;
+    zs.opaque = NULL;
+    zs.next_in = reinterpret_cast<Bytef*>(&(slot.compressed[BGZF_BLOCK::HEADER_SIZE]));
+    zs.avail_in = slot.compressed_size - BGZF_BLOCK::HEADER_SIZE;
+    zs.next_out = reinterpret_cast<Bytef*>(&(slot.uncompressed[0]));
+    zs.avail_out = BGZF_BLOCK::MAX_SIZE;
+
+    // bgzf blocks contain raw deflate data:
+    if (Z_OK != inflateInit2(&zs,-15))
+    {
+        slot.is_error=true;
+        return;
+    }
+    const int status(inflate(&zs,Z_FINISH));
+    slot.uncompressed_size = zs.total_out;
+    if ((Z_OK != inflateEnd(&zs)) || (Z_STREAM_END != status))
+    {
+        slot.is_error=true;
+    }
+}
@@ -0,0 +1,163 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+/// \file
+
+/// \author Chris Saunders
+///
+
+#pragma once
+
+#include "blt_util/bgzf_block_util.hh"
+#include "blt_util/bgzf_prefetcher.hh"
+
+#include "boost/thread/condition_variable.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/thread.hpp"
+#include "boost/utility.hpp"
+
+#include <stdint.h>
+
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+
+
+/// sequential reader for bgzf files which decompresses upcoming blocks on a pool of worker threads
+///
+/// The client provides a read plan as an ordered list of compressed block ranges. The reader thread
+/// fetches compressed blocks within the plan in order, while worker threads inflate them ahead of the
+/// client's read position. Reads and seeks follow samtools bgzf semantics for virtual file offsets.
+///
+struct bgzf_parallel_reader : private boost::noncopyable
+{
+    /// \param thread_count number of decompression worker threads
+    bgzf_parallel_reader(
+        const char* filename,
+        const unsigned thread_count);
+
+    ~bgzf_parallel_reader();
+
+    /// discard all pending blocks and start reading the blocks in ranges, in order
+    ///
+    /// the read position is set to the start of the first range
+    void
+    set_plan(const std::vector<bgzf_block_range>& ranges);
+
+    /// move to virtual offset voffset
+    ///
+    /// the target block must be the current block or a later block in the read plan
+    void
+    seek(const uint64_t voffset);
+
+    /// read up to length bytes into data
+    ///
+    /// \returns the number of bytes read, this is less than length only at the end of the plan
+    int
+    read(void* data, const int length);
+
+    /// virtual offset of the current read position
+    uint64_t
+    tell() const;
+
+    /// take compressed blocks from prefetcher when available, prefetcher must outlive this object
+    void
+    set_prefetcher(bgzf_prefetcher* prefetcher)
+    {
+        _prefetcher = prefetcher;
+    }
+
+private:
+
+    enum block_state
+    {
+        EMPTY,
+        QUEUED,
+        INFLATING,
+        READY
+    };
+
+    struct block_slot
+    {
+        block_slot() :
+            state(EMPTY),
+            is_error(false),
+            address(0),
+            compressed_size(0),
+            uncompressed_size(0)
+        {}
+
+        block_state state;
+        bool is_error;
+        int64_t address;
+        int compressed_size;
+        int uncompressed_size;
+        std::vector<char> compressed;
+        std::vector<char> uncompressed;
+    };
+
+    /// read the next compressed block in the plan into a free slot and queue it for decompression
+    bool
+    fetch_block();
+
+    /// keep the slot ring full of fetched blocks
+    void
+    fill_slots();
+
+    /// make the next block in the ring current
+    ///
+    /// \returns false if there are no more blocks in the plan
+    bool
+    next_block();
+
+    /// wait for the current block to be decompressed
+    void
+    wait_current();
+
+    /// stop all in progress decompression and clear the ring
+    void
+    clear_slots();
+
+    void
+    worker_loop();
+
+    static
+    void
+    inflate_block(block_slot& slot);
+
+    std::string _filename;
+    FILE* _fp;
+    bgzf_prefetcher* _prefetcher;
+
+    // the read plan:
+    std::vector<bgzf_block_range> _plan;
+    unsigned _plan_index;
+    int64_t _fetch_address;
+    bool _is_fetch_seek;
+
+    // block ring, the current block is _slots[_head] when _is_current is set:
+    std::vector<block_slot> _slots;
+    unsigned _head;
+    unsigned _slot_count;
+    bool _is_current;
+    int _block_offset;
+
+    // worker synchronization:
+    boost::mutex _mutex;
+    boost::condition_variable _work_cond;
+    boost::condition_variable _ready_cond;
+    std::deque<unsigned> _work_queue;
+    bool _is_stop;
+    boost::thread_group _workers;
+};
@@ -0,0 +1,195 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+/// \file
+
+/// \author Chris Saunders
+///
+
+#include "blt_util/bgzf_prefetcher.hh"
+#include "blt_util/log.hh"
+
+#include "boost/bind.hpp"
+
+#include <cstdlib>
+
+#include <algorithm>
+#include <iostream>
+
+
+
+bgzf_prefetcher::
+bgzf_prefetcher(
+    const char* filename,
+    const bool is_store_blocks,
+    const unsigned max_store_size) :
+    _filename(filename),
+    _fp(NULL),
+    _is_store_blocks(is_store_blocks),
+    _max_store_size(max_store_size),
+    _buffer(BGZF_BLOCK::MAX_SIZE),
+    _store_size(0),
+    _is_stop(false)
+{
+    _fp = fopen(filename,"rb");
+    if (NULL == _fp)
+    {
+        log_os << "ERROR: Failed to open bgzf file: " << filename << "\n";
+        exit(EXIT_FAILURE);
+    }
+
+    _worker = boost::thread(boost::bind(&bgzf_prefetcher::worker_loop,this));
+}
+
+
+
+bgzf_prefetcher::
+~bgzf_prefetcher()
+{
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        _is_stop=true;
+    }
+    _request_cond.notify_all();
+    _worker.join();
+
+    if (NULL != _fp) fclose(_fp);
+}
+
+
+
+void
+bgzf_prefetcher::
+add_request(const std::vector<bgzf_block_range>& ranges)
+{
+    if (ranges.empty()) return;
+
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        if (_requests.size() >= max_request_count) return;
+        _requests.push_back(ranges);
+    }
+    _request_cond.notify_one();
+}
+
+
+
+bool
+bgzf_prefetcher::
+get_block(
+    const int64_t address,
+    std::vector<char>& block,
+    int& block_size)
+{
+    if (! _is_store_blocks) return false;
+
+    boost::lock_guard<boost::mutex> lock(_mutex);
+    const store_t::iterator iter(_store.find(address));
+    if (iter == _store.end()) return false;
+
+    block_size = iter->second.size();
+    std::copy(iter->second.begin(),iter->second.end(),block.begin());
+    _store_size -= block_size;
+    _store.erase(iter);
+
+    // drop order entries for blocks which have already been taken:
+    while ((! _store_order.empty()) && (0 == _store.count(_store_order.front())))
+    {
+        _store_order.pop_front();
+    }
+    return true;
+}
+
+
+
+void
+bgzf_prefetcher::
+worker_loop()
+{
+    while (true)
+    {
+        request_t request;
+        {
+            boost::unique_lock<boost::mutex> lock(_mutex);
+            while (_requests.empty() && (! _is_stop))
+            {
+                _request_cond.wait(lock);
+            }
+            if (_is_stop) return;
+            request.swap(_requests.front());
+            _requests.pop_front();
+        }
+
+        for (request_t::const_iterator iter(request.begin()); iter!=request.end(); ++iter)
+        {
+            if (! read_range(*iter)) return;
+        }
+    }
+}
+
+
+
+bool
+bgzf_prefetcher::
+read_range(const bgzf_block_range& range)
+{
+    if (0 != fseeko(_fp,range.beg,SEEK_SET))
+    {
+        log_os << "ERROR: Failed to seek in bgzf file: " << _filename << "\n";
+        exit(EXIT_FAILURE);
+    }
+
+    int64_t address(range.beg);
+    while (address <= range.end)
+    {
+        {
+            boost::lock_guard<boost::mutex> lock(_mutex);
+            if (_is_stop) return false;
+        }
+
+        int block_size(0);
+        if (! read_bgzf_block(_fp,_filename.c_str(),address,_buffer,block_size)) break;
+        if (_is_store_blocks) store_block(address,block_size);
+        address += block_size;
+    }
+    return true;
+}
+
+
+
+void
+bgzf_prefetcher::
+store_block(
+    const int64_t address,
+    const int block_size)
+{
+    boost::lock_guard<boost::mutex> lock(_mutex);
+
+    if (_store.count(address)) return;
+
+    // evict the oldest blocks first:
+    while ((! _store_order.empty()) && ((_store_size+block_size) > _max_store_size))
+    {
+        const store_t::iterator iter(_store.find(_store_order.front()));
+        if (iter != _store.end())
+        {
+            _store_size -= iter->second.size();
+            _store.erase(iter);
+        }
+        _store_order.pop_front();
+    }
+
+    _store[address].assign(_buffer.begin(),_buffer.begin()+block_size);
+    _store_order.push_back(address);
+    _store_size += block_size;
+}
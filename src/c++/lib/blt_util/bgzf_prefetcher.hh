@@ -0,0 +1,108 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+/// \file
+
+/// \author Chris Saunders
+///
+
+#pragma once
+
+#include "blt_util/bgzf_block_util.hh"
+
+#include "boost/thread/condition_variable.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/thread.hpp"
+#include "boost/utility.hpp"
+
+#include <stdint.h>
+
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+
+/// reads upcoming sections of a bgzf file on a background thread
+///
+/// The client queues the block ranges it expects to read next, the prefetcher reads these
+/// from its own file handle so that file system latency overlaps with the client's work
+/// on the current region. In store mode, the compressed blocks are kept in a bounded
+/// cache for the client to pick up through get_block, otherwise the reads only serve to
+/// bring the file into the operating system's page cache.
+///
+struct bgzf_prefetcher : private boost::noncopyable
+{
+    /// \param is_store_blocks if true, keep compressed blocks for get_block
+    /// \param max_store_size maximum total size of stored blocks in bytes
+    bgzf_prefetcher(
+        const char* filename,
+        const bool is_store_blocks,
+        const unsigned max_store_size = (32u << 20));
+
+    ~bgzf_prefetcher();
+
+    /// queue a list of block ranges to be read in the background
+    ///
+    /// if the queue is full, the new request is dropped. Pending requests are for the regions the
+    /// client reads next, so these are kept ahead of more speculative later ones.
+    void
+    add_request(const std::vector<bgzf_block_range>& ranges);
+
+    /// if the compressed block at address has been prefetched, copy it to block and
+    /// remove it from the store
+    ///
+    /// \returns true if the block was found
+    bool
+    get_block(
+        const int64_t address,
+        std::vector<char>& block,
+        int& block_size);
+
+private:
+    enum { max_request_count = 16 };
+
+    typedef std::vector<bgzf_block_range> request_t;
+    typedef std::map<int64_t, std::vector<char> > store_t;
+
+    void
+    worker_loop();
+
+    /// read all blocks in range, returns false if the prefetcher is stopping
+    bool
+    read_range(const bgzf_block_range& range);
+
+    /// add block to the store, evicting older blocks as required
+    void
+    store_block(
+        const int64_t address,
+        const int block_size);
+
+    std::string _filename;
+    FILE* _fp;
+    const bool _is_store_blocks;
+    const unsigned _max_store_size;
+
+    // only accessed by the worker thread:
+    std::vector<char> _buffer;
+
+    boost::mutex _mutex;
+    boost::condition_variable _request_cond;
+    std::deque<request_t> _requests;
+    store_t _store;
+    std::deque<int64_t> _store_order;
+    unsigned _store_size;
+    bool _is_stop;
+    boost::thread _worker;
+};
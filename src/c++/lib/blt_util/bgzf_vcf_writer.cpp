@@ -0,0 +1,207 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+///
+/// \author Chris Saunders
+///
+
+#include "blt_util/bgzf_vcf_writer.hh"
+
+#include "blt_util/blt_exception.hh"
+
+#include "boost/foreach.hpp"
+
+#include <cassert>
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <vector>
+
+
+
+bgzf_vcf_writer::
+bgzf_vcf_writer(const std::string& filename) :
+    _filename(filename),
+    _fp(bgzf_open(filename.c_str(),"w"))
+{
+    if (NULL == _fp)
+    {
+        std::ostringstream oss;
+        oss << "ERROR: Failed to open output vcf file: '" << filename << "'\n";
+        throw blt_exception(oss.str().c_str());
+    }
+}
+
+
+
+bgzf_vcf_writer::
+~bgzf_vcf_writer()
+{
+    if (NULL != _fp) bgzf_close(_fp);
+}
+
+
+
+void
+bgzf_vcf_writer::
+write_text(
+    const char* text,
+    const unsigned size)
+{
+    assert(NULL != _fp);
+
+    if (bgzf_write(_fp,text,size) != static_cast<int>(size))
+    {
+        std::ostringstream oss;
+        oss << "ERROR: Failed to write to output vcf file: '" << _filename << "'\n";
+        throw blt_exception(oss.str().c_str());
+    }
+}
+
+
+
+void
+bgzf_vcf_writer::
+write_header(
+    const char* text,
+    const unsigned size)
+{
+    write_text(text,size);
+}
+
+
+
+void
+bgzf_vcf_writer::
+write_record(
+    const char* line,
+    const unsigned size)
+{
+    int begin_pos(0);
+    int end_pos(0);
+    if (! get_vcf_record_range(line,size,_chrom,begin_pos,end_pos))
+    {
+        std::ostringstream oss;
+        oss << "ERROR: Can't parse vcf record: '" << std::string(line,size) << "'\n";
+        throw blt_exception(oss.str().c_str());
+    }
+
+    const uint64_t begin_offset(bgzf_tell(_fp));
+    write_text(line,size);
+    _index.add(_chrom,begin_pos,end_pos,begin_offset,bgzf_tell(_fp));
+}
+
+
+
+void
+bgzf_vcf_writer::
+close(const std::string& index_filename)
+{
+    assert(NULL != _fp);
+
+    const int retval(bgzf_close(_fp));
+    _fp=NULL;
+    if (0 != retval)
+    {
+        std::ostringstream oss;
+        oss << "ERROR: Failed to close output vcf file: '" << _filename << "'\n";
+        throw blt_exception(oss.str().c_str());
+    }
+
+    _index.write(index_filename);
+}
+
+
+
+/// position and location in the input text of a vcf record to be sorted
+struct vcf_record_key
+{
+    bool
+    operator<(const vcf_record_key& rhs) const
+    {
+        if (tid != rhs.tid) return (tid < rhs.tid);
+        return (begin_pos < rhs.begin_pos);
+    }
+
+    int tid;
+    int begin_pos;
+    unsigned offset;
+    unsigned size;
+};
+
+
+
+void
+write_sorted_bgzf_vcf(
+    const std::string& vcf_text,
+    const bam_header_info& header,
+    const std::string& filename,
+    const std::string& index_filename)
+{
+    std::map<std::string,int> chrom_tid;
+    const unsigned chrom_count(header.chrom_data.size());
+    for (unsigned tid(0); tid<chrom_count; ++tid)
+    {
+        chrom_tid[header.chrom_data[tid].label] = tid;
+    }
+
+    // header lines precede all records:
+    std::string::size_type header_size(0);
+    while ((header_size < vcf_text.size()) && (vcf_text[header_size] == '#'))
+    {
+        const std::string::size_type line_end(vcf_text.find('\n',header_size));
+        header_size = ((line_end == std::string::npos) ? vcf_text.size() : (line_end+1));
+    }
+
+    std::vector<vcf_record_key> records;
+    std::string chrom;
+    int end_pos(0);
+    std::string::size_type line_begin(header_size);
+    while (line_begin < vcf_text.size())
+    {
+        std::string::size_type line_end(vcf_text.find('\n',line_begin));
+        line_end = ((line_end == std::string::npos) ? vcf_text.size() : (line_end+1));
+
+        vcf_record_key key;
+        key.offset = line_begin;
+        key.size = (line_end-line_begin);
+        if (! get_vcf_record_range(vcf_text.c_str()+key.offset,key.size,chrom,key.begin_pos,end_pos))
+        {
+            std::ostringstream oss;
+            oss << "ERROR: Can't parse vcf record: '" << vcf_text.substr(key.offset,key.size) << "'\n";
+            throw blt_exception(oss.str().c_str());
+        }
+
+        const std::map<std::string,int>::const_iterator tid_iter(chrom_tid.find(chrom));
+        if (tid_iter == chrom_tid.end())
+        {
+            std::ostringstream oss;
+            oss << "ERROR: vcf record chromosome '" << chrom << "' is not found in the header\n";
+            throw blt_exception(oss.str().c_str());
+        }
+        key.tid = tid_iter->second;
+        records.push_back(key);
+        line_begin = line_end;
+    }
+
+    std::stable_sort(records.begin(),records.end());
+
+    bgzf_vcf_writer writer(filename);
+    writer.write_header(vcf_text.c_str(),header_size);
+    BOOST_FOREACH(const vcf_record_key& key, records)
+    {
+        writer.write_record(vcf_text.c_str()+key.offset,key.size);
+    }
+    writer.close(index_filename);
+}
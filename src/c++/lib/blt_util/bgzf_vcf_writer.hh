@@ -0,0 +1,84 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+///
+/// \author Chris Saunders
+///
+
+#pragma once
+
+#include "blt_util/bam_header_info.hh"
+#include "blt_util/tabix_index_builder.hh"
+
+#include "boost/utility.hpp"
+
+extern "C" {
+#include "bgzf.h"
+}
+
+#include <string>
+
+
+/// write a BGZF-compressed vcf file together with its tabix index
+///
+/// records must be written sorted by position within each chromosome, with each
+/// chromosome in a single block.
+///
+struct bgzf_vcf_writer : private boost::noncopyable
+{
+    explicit
+    bgzf_vcf_writer(const std::string& filename);
+
+    ~bgzf_vcf_writer();
+
+    /// write vcf header lines, these are not indexed
+    void
+    write_header(
+        const char* text,
+        const unsigned size);
+
+    /// write a single vcf record line, including its newline
+    void
+    write_record(
+        const char* line,
+        const unsigned size);
+
+    /// finish the vcf file and write its tabix index to index_filename
+    void
+    close(const std::string& index_filename);
+
+private:
+    void
+    write_text(
+        const char* text,
+        const unsigned size);
+
+    std::string _filename;
+    BGZF* _fp;
+    tabix_index_builder _index;
+    std::string _chrom;
+};
+
+
+
+/// sort the records of vcf_text by position and write them to a BGZF-compressed file with its tabix index
+///
+/// records are sorted by chromosome in header order, then by POS. Records with the
+/// same position are kept in their input order.
+///
+void
+write_sorted_bgzf_vcf(
+    const std::string& vcf_text,
+    const bam_header_info& header,
+    const std::string& filename,
+    const std::string& index_filename);
@@ -0,0 +1,297 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+/// \file
+
+/// \author Chris Saunders
+///
+
+#include "blt_util/depth_bin_index.hh"
+#include "blt_util/log.hh"
+
+#include "boost/archive/binary_iarchive.hpp"
+#include "boost/archive/binary_oarchive.hpp"
+#include "boost/serialization/vector.hpp"
+
+#include <cassert>
+#include <cstdlib>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+
+
+depth_bin_index::
+depth_bin_index(const unsigned init_bin_size) :
+    _bin_size(init_bin_size)
+{
+    assert(_bin_size>0);
+}
+
+
+
+uint16_t&
+depth_bin_index::
+get_bin(const int tid,
+        const unsigned bin)
+{
+    assert(tid>=0);
+    if (tid >= static_cast<int>(_chroms.size())) _chroms.resize(tid+1);
+
+    chrom_bins& cb(_chroms[tid]);
+    if (cb.max_depth.empty())
+    {
+        cb.begin_bin=bin;
+    }
+    else if (bin < cb.begin_bin)
+    {
+        cb.max_depth.insert(cb.max_depth.begin(),(cb.begin_bin-bin),0);
+        cb.begin_bin=bin;
+    }
+
+    const unsigned offset(bin-cb.begin_bin);
+    if (offset >= cb.max_depth.size()) cb.max_depth.resize(offset+1,0);
+    return cb.max_depth[offset];
+}
+
+
+
+void
+depth_bin_index::
+update(const int tid,
+       const pos_t pos,
+       const unsigned depth)
+{
+    assert(pos>=0);
+    static const unsigned max_stored_depth(0xFFFF);
+    uint16_t& bin_depth(get_bin(tid,pos/_bin_size));
+    const unsigned stored_depth(std::min(depth,max_stored_depth));
+    if (stored_depth > bin_depth) bin_depth=stored_depth;
+}
+
+
+
+unsigned
+depth_bin_index::
+get_max_depth(const int tid,
+              const pos_t begin_pos,
+              const pos_t end_pos) const
+{
+    if ((tid < 0) || (tid >= static_cast<int>(_chroms.size()))) return 0;
+    if (end_pos <= begin_pos) return 0;
+
+    const chrom_bins& cb(_chroms[tid]);
+    if (cb.max_depth.empty()) return 0;
+
+    // translate the query to the range of stored bins:
+    const unsigned begin_bin(std::max(0,begin_pos)/_bin_size);
+    const unsigned end_bin((end_pos-1)/_bin_size+1);
+    const unsigned stored_end_bin(cb.begin_bin+cb.max_depth.size());
+    if ((end_bin <= cb.begin_bin) || (begin_bin >= stored_end_bin)) return 0;
+
+    const std::vector<uint16_t>::const_iterator first(cb.max_depth.begin()+(std::max(begin_bin,cb.begin_bin)-cb.begin_bin));
+    const std::vector<uint16_t>::const_iterator last(cb.max_depth.begin()+(std::min(end_bin,stored_end_bin)-cb.begin_bin));
+    return *(std::max_element(first,last));
+}
+
+
+
+void
+depth_bin_index::
+merge(const depth_bin_index& rhs)
+{
+    if (rhs._bin_size != _bin_size)
+    {
+        log_os << "ERROR: Can't merge depth indices with different bin sizes: " << _bin_size << " " << rhs._bin_size << "\n";
+        exit(EXIT_FAILURE);
+    }
+
+    const unsigned chrom_count(rhs._chroms.size());
+    for (unsigned tid(0); tid<chrom_count; ++tid)
+    {
+        const chrom_bins& rcb(rhs._chroms[tid]);
+        const unsigned bin_count(rcb.max_depth.size());
+        if (0 == bin_count) continue;
+
+        // extend the stored range to cover rhs first, so that the bin loop doesn't move data:
+        get_bin(tid,rcb.begin_bin);
+        get_bin(tid,rcb.begin_bin+bin_count-1);
+
+        chrom_bins& cb(_chroms[tid]);
+        const unsigned offset(rcb.begin_bin-cb.begin_bin);
+        for (unsigned i(0); i<bin_count; ++i)
+        {
+            uint16_t& bin_depth(cb.max_depth[offset+i]);
+            bin_depth=std::max(bin_depth,rcb.max_depth[i]);
+        }
+    }
+}
+
+
+
+void
+depth_bin_index::
+save(const char* filename) const
+{
+    using namespace boost::archive;
+
+    assert(NULL != filename);
+    std::ofstream ofs(filename, std::ios::binary);
+    if (! ofs)
+    {
+        log_os << "ERROR: Failed to open depth index file for writing: " << filename << "\n";
+        exit(EXIT_FAILURE);
+    }
+    binary_oarchive oa(ofs);
+
+    const unsigned chrom_count(_chroms.size());
+    oa << _bin_size;
+    oa << chrom_count;
+    for (unsigned tid(0); tid<chrom_count; ++tid)
+    {
+        oa << _chroms[tid].begin_bin;
+        oa << _chroms[tid].max_depth;
+    }
+}
+
+
+
+void
+depth_bin_index::
+load(const char* filename)
+{
+    using namespace boost::archive;
+
+    assert(NULL != filename);
+    std::ifstream ifs(filename, std::ios::binary);
+    if (! ifs)
+    {
+        log_os << "ERROR: Failed to open depth index file: " << filename << "\n";
+        exit(EXIT_FAILURE);
+    }
+    binary_iarchive ia(ifs);
+
+    unsigned chrom_count(0);
+    ia >> _bin_size;
+    ia >> chrom_count;
+    _chroms.clear();
+    _chroms.resize(chrom_count);
+    for (unsigned tid(0); tid<chrom_count; ++tid)
+    {
+        ia >> _chroms[tid].begin_bin;
+        ia >> _chroms[tid].max_depth;
+    }
+}
+
+
+
+depth_bin_index_builder::
+depth_bin_index_builder(
+    depth_bin_index& index,
+    const int region_tid,
+    const pos_t region_begin_pos,
+    const pos_t region_end_pos) :
+    _index(index),
+    _tid(region_tid),
+    _begin_pos(region_begin_pos),
+    _end_pos(region_end_pos),
+    _next_bin_pos(region_begin_pos)
+{}
+
+
+
+void
+depth_bin_index_builder::
+record_bin_starts(const pos_t pos)
+{
+    const pos_t bin_size(_index.bin_size());
+    const pos_t end_pos(std::min(pos,_end_pos));
+    while (_next_bin_pos < end_pos)
+    {
+        // depth only falls between reads, so skip ahead once no reads remain:
+        const unsigned depth(_depth.advance(_next_bin_pos));
+        if (0 == depth)
+        {
+            _next_bin_pos=end_pos;
+            break;
+        }
+        _index.update(_tid,_next_bin_pos,depth);
+        _next_bin_pos=((_next_bin_pos/bin_size)+1)*bin_size;
+    }
+}
+
+
+
+void
+depth_bin_index_builder::
+add(const pos_t begin_pos,
+    const pos_t end_pos)
+{
+    record_bin_starts(begin_pos+1);
+
+    const unsigned depth(_depth.add(begin_pos,end_pos));
+    if ((begin_pos >= _begin_pos) && (begin_pos < _end_pos))
+    {
+        _index.update(_tid,begin_pos,depth);
+    }
+}
+
+
+
+void
+depth_bin_index_builder::
+add_segments(const pos_t pos)
+{
+    while ((! _segments.empty()) && (_segments.top().first <= pos))
+    {
+        const segment_t segment(_segments.top());
+        _segments.pop();
+        add(segment.first,segment.second);
+    }
+}
+
+
+
+void
+depth_bin_index_builder::
+add_alignment(const pos_t pos,
+              const ALIGNPATH::path_t& apath)
+{
+    using namespace ALIGNPATH;
+
+    pos_t segment_pos(pos);
+    const unsigned as(apath.size());
+    for (unsigned i(0); i<as; ++i)
+    {
+        const path_segment& ps(apath[i]);
+        if (MATCH == ps.type)
+        {
+            _segments.push(segment_t(segment_pos,(segment_pos+static_cast<pos_t>(ps.length))));
+        }
+        if (is_segment_type_ref_length(ps.type)) segment_pos += ps.length;
+    }
+
+    // all later alignments begin at pos or after:
+    add_segments(pos);
+}
+
+
+
+void
+depth_bin_index_builder::
+finish()
+{
+    add_segments(_end_pos);
+    record_bin_starts(_end_pos);
+}
@@ -0,0 +1,152 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+/// \file
+
+/// \author Chris Saunders
+///
+
+#pragma once
+
+#include "blt_util/align_path.hh"
+#include "blt_util/blt_types.hh"
+#include "blt_util/stream_depth_tracker.hh"
+
+#include <stdint.h>
+
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+
+/// maximum read depth in fixed size bins over the genome
+///
+/// A query returns the maximum over all bins intersecting the query range, which is an
+/// upper bound of the maximum depth within the range itself. Bins are stored from the first
+/// to the last bin updated on each chromosome, so an index built over a single region stays
+/// small. Depths are capped at the maximum value of uint16_t.
+///
+struct depth_bin_index
+{
+    explicit
+    depth_bin_index(const unsigned init_bin_size = 100);
+
+    unsigned
+    bin_size() const
+    {
+        return _bin_size;
+    }
+
+    /// raise the max depth of the bin containing zero-indexed position pos of chromosome tid to depth
+    void
+    update(const int tid,
+           const pos_t pos,
+           const unsigned depth);
+
+    /// max depth of the bins intersecting the zero-indexed range [begin_pos,end_pos) of chromosome tid
+    unsigned
+    get_max_depth(const int tid,
+                  const pos_t begin_pos,
+                  const pos_t end_pos) const;
+
+    /// combine with an index of the same bin size, taking the max depth of each bin
+    void
+    merge(const depth_bin_index& rhs);
+
+    void
+    save(const char* filename) const;
+
+    void
+    load(const char* filename);
+
+private:
+
+    struct chrom_bins
+    {
+        chrom_bins() :
+            begin_bin(0)
+        {}
+
+        unsigned begin_bin;
+        std::vector<uint16_t> max_depth;
+    };
+
+    /// get the depth of bin on chromosome tid, extending the stored bins to include it
+    uint16_t&
+    get_bin(const int tid,
+            const unsigned bin);
+
+    unsigned _bin_size;
+    std::vector<chrom_bins> _chroms;
+};
+
+
+
+/// build a depth_bin_index over one chromosome region from a position sorted read stream
+///
+/// only positions within the region are recorded, but reads starting before the region
+/// must be added for the depth at the start of the region to be correct
+///
+struct depth_bin_index_builder
+{
+    /// \param region_tid,region_begin_pos,region_end_pos the zero-indexed region [begin_pos,end_pos)
+    depth_bin_index_builder(
+        depth_bin_index& index,
+        const int region_tid,
+        const pos_t region_begin_pos,
+        const pos_t region_end_pos);
+
+    /// add a read covering the zero-indexed range [begin_pos,end_pos)
+    ///
+    /// reads must be added in begin_pos order
+    void
+    add(const pos_t begin_pos,
+        const pos_t end_pos);
+
+    /// add the match segments of a read alignment starting at zero-indexed position pos
+    ///
+    /// depth is counted with the same rule as window_depth_counter::add_alignment. Alignments
+    /// must be added in pos order, and can't be mixed with reads added as a single range.
+    void
+    add_alignment(const pos_t pos,
+                  const ALIGNPATH::path_t& apath);
+
+    /// record the depth of all remaining bins in the region
+    void
+    finish();
+
+private:
+
+    /// add all pending alignment segments which begin at or before pos
+    void
+    add_segments(const pos_t pos);
+
+    /// record the depth at each bin start before pos, before any reads starting at pos are added
+    void
+    record_bin_starts(const pos_t pos);
+
+    depth_bin_index& _index;
+    const int _tid;
+    const pos_t _begin_pos;
+    const pos_t _end_pos;
+
+    // the next bin start position where depth has not been recorded:
+    pos_t _next_bin_pos;
+    stream_depth_tracker _depth;
+
+    // match segments following a deletion or skip can begin after later alignments, so
+    // these are held until no alignment added afterwards can begin before them:
+    typedef std::pair<pos_t,pos_t> segment_t;
+    std::priority_queue<segment_t, std::vector<segment_t>, std::greater<segment_t> > _segments;
+};
@@ -0,0 +1,54 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+/// \file
+
+/// \author Chris Saunders
+///
+
+#pragma once
+
+#include <stdint.h>
+
+#include <cstddef>
+
+
+/// 32 bit FNV-1a hash of a null terminated string
+inline
+uint32_t
+fnv1a_hash(const char* str)
+{
+    uint32_t hash(2166136261u);
+    for (; *str != '\0'; ++str)
+    {
+        hash ^= static_cast<unsigned char>(*str);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+
+/// 32 bit FNV-1a hash of the size bytes starting at data
+inline
+uint32_t
+fnv1a_hash(const char* data,
+           const std::size_t size)
+{
+    uint32_t hash(2166136261u);
+    for (std::size_t i(0); i<size; ++i)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
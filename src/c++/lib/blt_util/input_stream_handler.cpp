@@ -63,18 +63,26 @@ register_error(const char* label,
 
 input_stream_handler::
 input_stream_handler(
-    const input_stream_data& data)
+    const input_stream_data& data,
+    const bool is_batch_streams)
     : _data(data)
+    , _is_batch_streams(is_batch_streams)
     , _is_end(false)
     , _is_head_pos(false)
     , _head_pos(0)
+    , _stream_merge(data._reads.size())
 {
-    // initial loading for _stream_queue:
+    // initial loading for _stream_merge:
     const unsigned rs(_data._reads.size());
     for (unsigned i(0); i<rs; ++i)
     {
-        push_next(INPUT_TYPE::READ,_data._reads.get_key(i),i);
+        input_record_info next_rec;
+        if (get_next(INPUT_TYPE::READ,_data._reads.get_key(i),i,next_rec))
+        {
+            _stream_merge.set_source(i,next_rec);
+        }
     }
+    _stream_merge.build();
 }
 
 
@@ -89,20 +97,28 @@ next()
     {
         if (_current.itype != INPUT_TYPE::NONE)
         {
-            // reload stream_queue with current type and sample_no;
-            push_next(_current.itype,_current.sample_no,_current._order);
+            // reload stream_merge with current type and sample_no;
+            input_record_info next_rec;
+            if (get_next(_current.itype,_current.sample_no,_current._order,next_rec))
+            {
+                if (_is_batch_streams) _stream_merge.replace_top_run(next_rec);
+                else                   _stream_merge.replace_top(next_rec);
+            }
+            else
+            {
+                _stream_merge.pop_top();
+            }
             _last=_current;
         }
 
-        if (_stream_queue.empty())
+        if (_stream_merge.empty())
         {
             _current=input_record_info();
             _is_end=true;
             return false;
         }
         bool is_usable(true);
-        _current=_stream_queue.top();
-        _stream_queue.pop();
+        _current=_stream_merge.top_key();
 
         if (_is_head_pos &&
             (_current.pos < _head_pos))
@@ -163,11 +179,12 @@ get_next_read_pos(bool& is_next_read,
 
 
 
-void
+bool
 input_stream_handler::
-push_next(const INPUT_TYPE::index_t itype,
-          const int sample_no,
-          const unsigned order)
+get_next(const INPUT_TYPE::index_t itype,
+         const int sample_no,
+         const unsigned order,
+         input_record_info& next_rec)
 {
 
     bool is_next(false);
@@ -183,7 +200,8 @@ push_next(const INPUT_TYPE::index_t itype,
         oss << "ERROR: unexpected input type: " << itype << "\n";
         throw blt_exception(oss.str().c_str());
     }
-    if (! is_next) return;
-    _stream_queue.push(input_record_info(next_pos,itype,sample_no,order));
+    if (! is_next) return false;
+    next_rec=input_record_info(next_pos,itype,sample_no,order);
+    return true;
 }
 
@@ -25,9 +25,9 @@
 
 #include "blt_util/id_map.hh"
 #include "blt_util/bam_streamer.hh"
+#include "blt_util/loser_tree.hh"
 
 #include <map>
-#include <queue>
 #include <utility>
 
 
@@ -117,6 +117,19 @@ private:
 
 
 
+/// merge order of input records, the reverse of input_record_info::operator<
+struct input_record_merge_order
+{
+    bool
+    operator()(const input_record_info& a,
+               const input_record_info& b) const
+    {
+        return (b < a);
+    }
+};
+
+
+
 // streams multiple bam (and vcf) files to present the data
 // in positional order (but with offsets for vcfs to
 // run ahead of the bam reads)
@@ -124,8 +137,12 @@ private:
 struct input_stream_handler
 {
 
+    /// \param is_batch_streams if true, consecutive records from the same stream are
+    ///                         returned without a full merge update while that stream
+    ///                         remains ahead of all others
     input_stream_handler(
-        const input_stream_data& data);
+        const input_stream_data& data,
+        const bool is_batch_streams = true);
 
     bool next();
 
@@ -143,14 +160,19 @@ struct input_stream_handler
 
 private:
 
-    void
-    push_next(const INPUT_TYPE::index_t itype,
-              const int sample_no,
-              const unsigned order);
+    /// get the next record from the given input stream
+    ///
+    /// \returns false if the stream is finished
+    bool
+    get_next(const INPUT_TYPE::index_t itype,
+             const int sample_no,
+             const unsigned order,
+             input_record_info& next_rec);
 
 
 ///////////////////////////////// data:
     const input_stream_data _data;
+    const bool _is_batch_streams;
 
     input_record_info _current;
     input_record_info _last;
@@ -160,5 +182,6 @@ private:
     bool _is_head_pos;
     pos_t _head_pos;
 
-    std::priority_queue<input_record_info> _stream_queue;
+    // the next record of each input stream, indexed by order:
+    loser_tree<input_record_info,input_record_merge_order> _stream_merge;
 };
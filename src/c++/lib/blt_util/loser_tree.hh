@@ -0,0 +1,214 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+/// \file
+
+/// \author Chris Saunders
+///
+
+#pragma once
+
+#include <cassert>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+
+/// tournament tree of losers used to merge many sorted sources
+///
+/// each source contributes its current head key. Replacing the winning key costs
+/// one comparison per tree level, compared to the ~2 log(k) comparisons and
+/// element moves of a binary heap. Keys are compared with comp(a,b), which should
+/// return true when a must be merged before b, ties are broken by source index.
+///
+/// Example use:
+///
+/// loser_tree<int> lt(sourceCount);
+/// for each source i with data: lt.set_source(i,head_key(i));
+/// lt.build();
+/// while (! lt.empty()) {
+///     use(lt.top(),lt.top_key());
+///     if (next key of source lt.top() exists) lt.replace_top(key);
+///     else                                     lt.pop_top();
+/// }
+///
+template <typename Key, typename Compare = std::less<Key> >
+struct loser_tree
+{
+    explicit
+    loser_tree(
+        const unsigned source_count,
+        const Compare& comp = Compare()) :
+        _size(1),
+        _comp(comp),
+        _winner(0),
+        _is_runner_up(false),
+        _runner_up(0)
+    {
+        while (_size < source_count) _size *= 2;
+        _keys.resize(_size);
+        _is_active.resize(_size,false);
+        _tree.resize(_size,0);
+    }
+
+    /// set the initial head key of a source, all sources must be set before build()
+    void
+    set_source(
+        const unsigned index,
+        const Key& key)
+    {
+        assert(index < _size);
+        _keys[index] = key;
+        _is_active[index] = true;
+    }
+
+    /// play the initial tournament
+    void
+    build()
+    {
+        _winner = build_node(1);
+        _is_runner_up = false;
+    }
+
+    /// true when all sources are exhausted
+    bool
+    empty() const
+    {
+        return (! _is_active[_winner]);
+    }
+
+    /// index of the source with the winning key
+    unsigned
+    top() const
+    {
+        return _winner;
+    }
+
+    const Key&
+    top_key() const
+    {
+        return _keys[_winner];
+    }
+
+    /// replace the key of the winning source and replay its path to the root
+    void
+    replace_top(const Key& key)
+    {
+        _keys[_winner] = key;
+        replay();
+    }
+
+    /// replace the key of the winning source, skipping the replay when the
+    /// new key is still ahead of every other source
+    ///
+    /// this amortizes one replay over a run of consecutive keys from the same source
+    void
+    replace_top_run(const Key& key)
+    {
+        if (_size > 1)
+        {
+            if (! _is_runner_up) update_runner_up();
+        }
+
+        // equivalent to is_before(_winner,_runner_up) with the new key:
+        if ((_size == 1) || (! _is_active[_runner_up]) || _comp(key,_keys[_runner_up]) ||
+            ((! _comp(_keys[_runner_up],key)) && (_winner < _runner_up)))
+        {
+            _keys[_winner] = key;
+            return;
+        }
+        replace_top(key);
+    }
+
+    /// remove the winning source
+    void
+    pop_top()
+    {
+        _is_active[_winner] = false;
+        replay();
+    }
+
+private:
+
+    /// true if source a is merged before source b
+    bool
+    is_before(
+        const unsigned a,
+        const unsigned b) const
+    {
+        if (! _is_active[a]) return false;
+        if (! _is_active[b]) return true;
+        if (_comp(_keys[a],_keys[b])) return true;
+        if (_comp(_keys[b],_keys[a])) return false;
+        return (a < b);
+    }
+
+    /// play the subtree rooted at node, returns the winning source
+    unsigned
+    build_node(const unsigned node)
+    {
+        if (node >= _size) return (node - _size);
+
+        const unsigned left(build_node(node*2));
+        const unsigned right(build_node(node*2+1));
+        if (is_before(left,right))
+        {
+            _tree[node] = right;
+            return left;
+        }
+        else
+        {
+            _tree[node] = left;
+            return right;
+        }
+    }
+
+    void
+    replay()
+    {
+        unsigned winner(_winner);
+        for (unsigned node((_winner+_size)/2); node>0; node /= 2)
+        {
+            if (is_before(_tree[node],winner)) std::swap(_tree[node],winner);
+        }
+        _winner = winner;
+        _is_runner_up = false;
+    }
+
+    /// the runner-up only lost to the winner, so it is the best loser on the winner's path
+    void
+    update_runner_up()
+    {
+        assert(_size > 1);
+        unsigned node((_winner+_size)/2);
+        _runner_up = _tree[node];
+        for (node /= 2; node>0; node /= 2)
+        {
+            if (is_before(_tree[node],_runner_up)) _runner_up = _tree[node];
+        }
+        _is_runner_up = true;
+    }
+
+    unsigned _size;
+    Compare _comp;
+    std::vector<Key> _keys;
+    std::vector<bool> _is_active;
+
+    // _tree[node] is the source which lost the match at node:
+    std::vector<unsigned> _tree;
+    unsigned _winner;
+
+    bool _is_runner_up;
+    unsigned _runner_up;
+};
@@ -0,0 +1,175 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+
+///
+/// \author Chris Saunders
+///
+
+#include "blt_util/reference_window_cache.hh"
+
+#include "blt_util/blt_exception.hh"
+#include "blt_util/parse_util.hh"
+#include "blt_util/seq_util.hh"
+#include "blt_util/string_util.hh"
+
+#include <cassert>
+#include <cstdlib>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+
+
+reference_window_cache::
+reference_window_cache(
+    const std::string& ref_file,
+    const unsigned window_size,
+    const unsigned max_window_count) :
+    _ref_file(ref_file),
+    _window_size(window_size),
+    _max_window_count(max_window_count),
+    _fai(fai_load(ref_file.c_str()))
+{
+    assert(_window_size > 0);
+    assert(_max_window_count > 0);
+
+    if (NULL == _fai)
+    {
+        std::ostringstream oss;
+        oss << "ERROR: Can't load index of reference file: '" << ref_file << "'\n";
+        throw blt_exception(oss.str().c_str());
+    }
+
+    // fai_load has created the fasta index if it did not already exist:
+    const std::string fai_file(ref_file+".fai");
+    std::ifstream fis(fai_file.c_str());
+    std::string line;
+    std::vector<std::string> word;
+    while (std::getline(fis,line))
+    {
+        if (line.empty()) continue;
+        split_string(line,'\t',word);
+        if (word.size() < 2)
+        {
+            std::ostringstream oss;
+            oss << "ERROR: Unexpected line in fasta index file: '" << fai_file << "'\n";
+            throw blt_exception(oss.str().c_str());
+        }
+        _chrom_length[word[0]]=illumina::blt_util::parse_int_str(word[1]);
+    }
+}
+
+
+
+reference_window_cache::
+~reference_window_cache()
+{
+    fai_destroy(_fai);
+}
+
+
+
+pos_t
+reference_window_cache::
+get_chrom_length(const std::string& chrom) const
+{
+    const chrom_length_map::const_iterator iter(_chrom_length.find(chrom));
+    if (iter == _chrom_length.end())
+    {
+        std::ostringstream oss;
+        oss << "ERROR: Can't find sequence '" << chrom << "' in reference file: '" << _ref_file << "'\n";
+        throw blt_exception(oss.str().c_str());
+    }
+    return iter->second;
+}
+
+
+
+const reference_contig_segment&
+reference_window_cache::
+get_window(
+    const std::string& chrom,
+    const int window_index)
+{
+    const window_key key(chrom,window_index);
+    const window_map::iterator iter(_window_index.find(key));
+    if (iter != _window_index.end())
+    {
+        _windows.splice(_windows.begin(),_windows,iter->second);
+        return _windows.front().seq;
+    }
+
+    // windows are clipped to the end of chrom, because the fasta index clamps
+    // requests beyond the end of a sequence to its last base:
+    const pos_t begin_pos(window_index*static_cast<pos_t>(_window_size));
+    const pos_t end_pos(std::min(begin_pos+static_cast<pos_t>(_window_size),get_chrom_length(chrom)));
+
+    // reuse the storage of the least recently used window once the cache is full:
+    if (_windows.size() >= _max_window_count)
+    {
+        _window_index.erase(_windows.back().key);
+        _windows.splice(_windows.begin(),_windows,--_windows.end());
+    }
+    else
+    {
+        _windows.push_front(window());
+    }
+
+    window& win(_windows.front());
+    win.key=key;
+    _window_index[key]=_windows.begin();
+
+    win.seq.seq().clear();
+    if (begin_pos < end_pos)
+    {
+        int len; // throwaway...
+        char* ref_tmp(faidx_fetch_seq(_fai,const_cast<char*>(chrom.c_str()), begin_pos, (end_pos-1), &len));
+        assert(NULL != ref_tmp);
+        win.seq.seq().assign(ref_tmp);
+        free(ref_tmp);
+    }
+    win.seq.set_offset(begin_pos);
+    standardize_ref_seq(_ref_file.c_str(), chrom.c_str(), win.seq.seq(), begin_pos);
+
+    return win.seq;
+}
+
+
+
+void
+reference_window_cache::
+get_seq(
+    const std::string& chrom,
+    const pos_t begin_pos,
+    const pos_t end_pos,
+    std::string& seq)
+{
+    seq.clear();
+
+    // positions before the start of chrom:
+    pos_t pos(begin_pos);
+    for (; (pos<end_pos) && (pos<0); ++pos) seq.push_back('N');
+
+    std::string subseq;
+    while (pos<end_pos)
+    {
+        const int window_index(pos/_window_size);
+        const pos_t window_end(std::min(end_pos,static_cast<pos_t>((window_index+1)*_window_size)));
+        get_window(chrom,window_index).get_substring(pos,(window_end-pos),subseq);
+        seq += subseq;
+        pos=window_end;
+    }
+}
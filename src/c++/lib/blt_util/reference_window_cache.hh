@@ -0,0 +1,101 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+
+///
+/// \author Chris Saunders
+///
+
+#pragma once
+
+#include "blt_util/blt_types.hh"
+#include "blt_util/reference_contig_segment.hh"
+
+#include "boost/utility.hpp"
+
+extern "C" {
+#include "faidx.h"
+}
+
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+
+
+/// long-lived reference sequence accessor
+///
+/// the fasta index is loaded once, and sequence is served from a least-recently-used cache
+/// of fixed size reference windows, so that many small lookups near each other in the genome
+/// do not each require a fasta index load and file read. Window sequence is standardized
+/// when it is loaded.
+///
+struct reference_window_cache : private boost::noncopyable
+{
+    explicit
+    reference_window_cache(
+        const std::string& ref_file,
+        const unsigned window_size = 65536,
+        const unsigned max_window_count = 16);
+
+    ~reference_window_cache();
+
+    const std::string&
+    ref_file() const
+    {
+        return _ref_file;
+    }
+
+    /// get the standardized reference sequence of the zero-indexed range [begin_pos,end_pos) of chrom,
+    /// positions off the end of chrom are returned as 'N'
+    void
+    get_seq(
+        const std::string& chrom,
+        const pos_t begin_pos,
+        const pos_t end_pos,
+        std::string& seq);
+
+private:
+    typedef std::pair<std::string,int> window_key;
+
+    struct window
+    {
+        window_key key;
+        reference_contig_segment seq;
+    };
+
+    typedef std::list<window> window_list;
+    typedef std::map<window_key,window_list::iterator> window_map;
+
+    /// get the length of chrom from the fasta index
+    pos_t
+    get_chrom_length(const std::string& chrom) const;
+
+    /// get a window, loading it if it isn't cached, and mark it as most recently used
+    const reference_contig_segment&
+    get_window(
+        const std::string& chrom,
+        const int window_index);
+
+    const std::string _ref_file;
+    const unsigned _window_size;
+    const unsigned _max_window_count;
+    faidx_t* _fai;
+
+    typedef std::map<std::string,pos_t> chrom_length_map;
+    chrom_length_map _chrom_length;
+
+    // windows ordered from most to least recently used:
+    window_list _windows;
+    window_map _window_index;
+};
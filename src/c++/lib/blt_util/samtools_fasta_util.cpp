@@ -68,6 +68,33 @@ get_chrom_sizes(const std::string& fai_file,
 
 
 
+void
+get_chrom_names(const std::string& fai_file,
+                std::vector<std::string>& chrom_names)
+{
+    static const char delim('\t');
+
+    chrom_names.clear();
+    std::ifstream fis(fai_file.c_str());
+    if (! fis)
+    {
+        std::ostringstream oss;
+        oss << "ERROR: Can't open fasta index file: '" << fai_file << "'\n";
+        throw blt_exception(oss.str().c_str());
+    }
+
+    std::string line;
+    std::vector<std::string> word;
+    while (getline(fis, line))
+    {
+        if (line.empty()) continue;
+        split_string(line, delim, word);
+        chrom_names.push_back(word[0]);
+    }
+}
+
+
+
 unsigned
 get_chrom_length(const std::string& fai_file,
                  const std::string& chrom_name)
@@ -19,6 +19,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 
 /// retrieve a map of chromosome sizes from the fasta index
@@ -29,6 +30,14 @@ get_chrom_sizes(
     std::map<std::string,unsigned>& chrom_sizes);
 
 
+/// retrieve the chromosome names from the fasta index, in reference order
+///
+void
+get_chrom_names(
+    const std::string& fai_file,
+    std::vector<std::string>& chrom_names);
+
+
 /// retrieve size of specific chromosome from the fasta index
 ///
 unsigned
@@ -0,0 +1,124 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+/// \file
+
+/// \author Chris Saunders
+///
+
+#include "blt_util/size_distribution.hh"
+#include "blt_util/blt_exception.hh"
+#include "blt_util/parse_util.hh"
+
+#include <cmath>
+
+#include <iostream>
+#include <sstream>
+
+
+
+int
+size_distribution::
+quantile(const double prob) const
+{
+    if (0 == _total_count) return 0;
+
+    // number of observations required at or below the quantile, this matches indexing the
+    // sorted observation vector at floor(prob*n), as fragment size stats have always done:
+    double target(std::floor(prob*_total_count)+1.);
+    if (target > _total_count) target = _total_count;
+    if (target < 1.) target = 1.;
+
+    double cumulative(0.);
+    const unsigned nbins(_count.size());
+    for (unsigned size(0); size<nbins; ++size)
+    {
+        cumulative += _count[size];
+        if (cumulative >= target) return size;
+    }
+    return (nbins-1);
+}
+
+
+
+void
+size_distribution::
+quantile_table(const unsigned step_count,
+               std::vector<int>& table) const
+{
+    table.assign(step_count+1,0);
+    if (0 == _total_count) return;
+
+    const unsigned nbins(_count.size());
+    unsigned size(0);
+    double cumulative(_count[0]);
+    for (unsigned step(0); step<=step_count; ++step)
+    {
+        // the same observation count as quantile(), with the product taken before
+        // the division so that exact steps are not subject to rounding:
+        double target(std::floor((static_cast<double>(step)*_total_count)/step_count)+1.);
+        if (target > _total_count) target = _total_count;
+
+        while ((cumulative < target) && ((size+1) < nbins))
+        {
+            size++;
+            cumulative += _count[size];
+        }
+        table[step] = size;
+    }
+}
+
+
+
+void
+size_distribution::
+write(std::ostream& os) const
+{
+    bool is_first(true);
+    const unsigned nbins(_count.size());
+    for (unsigned size(0); size<nbins; ++size)
+    {
+        if (0 == _count[size]) continue;
+        if (! is_first) os << ',';
+        os << size << ':' << _count[size];
+        is_first=false;
+    }
+}
+
+
+
+void
+size_distribution::
+read(const std::string& str)
+{
+    using namespace illumina::blt_util;
+
+    clear();
+
+    const char* s(str.c_str());
+    while (*s != '\0')
+    {
+        const int size(parse_int(s));
+        if (*s != ':')
+        {
+            std::ostringstream oss;
+            oss << "ERROR: Unexpected format in size distribution string: '" << str << "'";
+            throw blt_exception(oss.str().c_str());
+        }
+        ++s;
+        const unsigned count(parse_unsigned(s));
+        if (*s == ',') ++s;
+
+        add_observations(size,count);
+    }
+}
@@ -0,0 +1,162 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+/// \file
+
+/// \author Chris Saunders
+///
+
+#pragma once
+
+#include "boost/serialization/split_member.hpp"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+
+/// histogram of non-negative integer sizes, such as read pair fragment lengths
+///
+/// each size up to max_size() has its own bin, larger sizes are counted in the
+/// max_size() bin, so memory use is bounded regardless of the observation count
+///
+struct size_distribution
+{
+    size_distribution() :
+        _total_count(0)
+    {}
+
+    void
+    clear()
+    {
+        _count.clear();
+        _total_count=0;
+    }
+
+    /// add one observation in O(1)
+    void
+    add_observation(const int size)
+    {
+        add_observations(size,1);
+    }
+
+    /// add count observations of the same size
+    void
+    add_observations(int size,
+                     const unsigned count)
+    {
+        if (size < 0) size = 0;
+        if (size > max_size()) size = max_size();
+        const unsigned usize(size);
+        if (usize >= _count.size()) _count.resize(usize+1,0);
+        _count[usize] += count;
+        _total_count += count;
+    }
+
+    unsigned
+    total_observations() const
+    {
+        return _total_count;
+    }
+
+    /// number of observations of size
+    unsigned
+    count(const int size) const
+    {
+        if ((size < 0) || (size >= static_cast<int>(_count.size()))) return 0;
+        return _count[size];
+    }
+
+    /// largest size with at least one observation
+    ///
+    /// \returns 0 if there are no observations
+    int
+    max_observed_size() const
+    {
+        for (int size(_count.size()-1); size>0; --size)
+        {
+            if (_count[size] != 0) return size;
+        }
+        return 0;
+    }
+
+    /// size of the observation at (zero-based) index floor(prob*n) in the sorted list of
+    /// all n observations, or the largest observation if this index is n or more
+    ///
+    /// \returns 0 if there are no observations
+    int
+    quantile(const double prob) const;
+
+    /// get the quantile of each probability step i/step_count, for i in [0,step_count]
+    ///
+    /// table[i] is quantile(i/step_count), with the observation index floor(i*n/step_count)
+    /// computed exactly. All steps are found in a single pass over the bins.
+    void
+    quantile_table(const unsigned step_count,
+                   std::vector<int>& table) const;
+
+    /// largest size which bins are kept for
+    static
+    int
+    max_size()
+    {
+        return 50000;
+    }
+
+    /// write all non-zero bins as a comma-separated list of size:count pairs
+    void
+    write(std::ostream& os) const;
+
+    /// read the format produced by write()
+    void
+    read(const std::string& str);
+
+    /// only non-zero bins are stored
+    template<class Archive>
+    void save(Archive& ar, const unsigned /* version */) const
+    {
+        unsigned nonzero_bins(0);
+        const unsigned nbins(_count.size());
+        for (unsigned size(0); size<nbins; ++size)
+        {
+            if (0 != _count[size]) nonzero_bins++;
+        }
+        ar << nonzero_bins;
+        for (unsigned size(0); size<nbins; ++size)
+        {
+            if (0 == _count[size]) continue;
+            ar << size << _count[size];
+        }
+    }
+
+    template<class Archive>
+    void load(Archive& ar, const unsigned /* version */)
+    {
+        clear();
+        unsigned nonzero_bins(0);
+        ar >> nonzero_bins;
+        for (unsigned i(0); i<nonzero_bins; ++i)
+        {
+            unsigned size(0);
+            unsigned count(0);
+            ar >> size >> count;
+            add_observations(size,count);
+        }
+    }
+
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
+
+private:
+    std::vector<unsigned> _count;
+    unsigned _total_count;
+};
@@ -0,0 +1,47 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+/// \file
+
+/// \author Chris Saunders
+///
+
+#include "blt_util/stream_depth_tracker.hh"
+
+
+
+unsigned
+stream_depth_tracker::
+advance(const pos_t pos)
+{
+    // remove reads which end at or before pos:
+    while ((! _ends.empty()) && (_ends.top() <= pos))
+    {
+        _ends.pop();
+    }
+    return _ends.size();
+}
+
+
+
+unsigned
+stream_depth_tracker::
+add(const pos_t begin_pos,
+    const pos_t end_pos)
+{
+    // remove reads which end before this one starts:
+    advance(begin_pos);
+
+    if (end_pos > begin_pos) _ends.push(end_pos);
+    return _ends.size();
+}
@@ -0,0 +1,69 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+/// \file
+
+/// \author Chris Saunders
+///
+
+#pragma once
+
+#include "blt_util/blt_types.hh"
+
+#include <functional>
+#include <queue>
+#include <vector>
+
+
+/// track read depth at the leading edge of a position sorted read stream
+///
+/// only the end positions of the reads overlapping the current position are
+/// stored, so memory is proportional to the local depth
+///
+struct stream_depth_tracker
+{
+    /// add a read covering the zero-indexed range [begin_pos,end_pos)
+    ///
+    /// reads must be added in begin_pos order
+    ///
+    /// \returns depth at begin_pos, including this read
+    unsigned
+    add(const pos_t begin_pos,
+        const pos_t end_pos);
+
+    /// move the tracked position forward to pos without adding a read
+    ///
+    /// pos must not be less than the begin_pos of the last read added
+    ///
+    /// \returns depth at pos
+    unsigned
+    advance(const pos_t pos);
+
+    /// depth at the begin_pos of the last read added
+    unsigned
+    depth() const
+    {
+        return _ends.size();
+    }
+
+    void
+    clear()
+    {
+        while (! _ends.empty()) _ends.pop();
+    }
+
+private:
+    typedef std::priority_queue<pos_t, std::vector<pos_t>, std::greater<pos_t> > end_queue_t;
+
+    end_queue_t _ends;
+};
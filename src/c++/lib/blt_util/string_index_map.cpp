@@ -0,0 +1,103 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+/// \file
+
+/// \author Chris Saunders
+///
+
+#include "blt_util/string_index_map.hh"
+#include "blt_util/hash_util.hh"
+
+#include <cassert>
+#include <cstring>
+
+#include <algorithm>
+
+
+
+unsigned
+string_index_map::
+find_slot(const char* key,
+          const uint32_t hash) const
+{
+    assert(! _table.empty());
+
+    const unsigned mask(_table.size()-1);
+    unsigned slot(hash & mask);
+    while (true)
+    {
+        const entry& e(_table[slot]);
+        if (! e.is_set) return slot;
+        if ((e.hash == hash) && (0 == strcmp(e.key.c_str(),key))) return slot;
+        slot = (slot+1) & mask;
+    }
+}
+
+
+
+void
+string_index_map::
+resize_table(const unsigned table_size)
+{
+    std::vector<entry> old_table(table_size);
+    _table.swap(old_table);
+
+    const unsigned old_table_size(old_table.size());
+    for (unsigned i(0); i<old_table_size; ++i)
+    {
+        const entry& e(old_table[i]);
+        if (! e.is_set) continue;
+        _table[find_slot(e.key.c_str(),e.hash)] = e;
+    }
+}
+
+
+
+void
+string_index_map::
+insert(const char* key,
+       const unsigned index)
+{
+    // keep the load factor at or below one half:
+    if ((_size+1)*2 > _table.size())
+    {
+        resize_table(std::max(8u,static_cast<unsigned>(_table.size()*2)));
+    }
+
+    const uint32_t hash(fnv1a_hash(key));
+    entry& e(_table[find_slot(key,hash)]);
+    if (! e.is_set)
+    {
+        e.is_set=true;
+        e.hash=hash;
+        e.key=key;
+        _size++;
+    }
+    e.index=index;
+}
+
+
+
+bool
+string_index_map::
+find(const char* key,
+     unsigned& index) const
+{
+    if (_table.empty()) return false;
+
+    const entry& e(_table[find_slot(key,fnv1a_hash(key))]);
+    if (! e.is_set) return false;
+    index=e.index;
+    return true;
+}
@@ -0,0 +1,87 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+/// \file
+
+/// \author Chris Saunders
+///
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+
+/// map from strings to index numbers, optimized for fast lookup of C-string keys
+///
+/// keys are stored with their hash in a flat open-addressing table, so that a lookup
+/// costs one hash of the query and usually a single string comparison, with no
+/// allocation
+///
+struct string_index_map
+{
+    string_index_map() :
+        _size(0)
+    {}
+
+    bool
+    empty() const
+    {
+        return (0 == _size);
+    }
+
+    unsigned
+    size() const
+    {
+        return _size;
+    }
+
+    /// add key with index, or replace the index of an existing key
+    void
+    insert(const char* key,
+           const unsigned index);
+
+    /// \returns true and set index if key is found
+    bool
+    find(const char* key,
+         unsigned& index) const;
+
+private:
+
+    struct entry
+    {
+        entry() :
+            is_set(false),
+            hash(0),
+            index(0)
+        {}
+
+        bool is_set;
+        uint32_t hash;
+        unsigned index;
+        std::string key;
+    };
+
+    /// find the slot for key, which is either unset or holds key
+    unsigned
+    find_slot(const char* key,
+              const uint32_t hash) const;
+
+    void
+    resize_table(const unsigned table_size);
+
+    std::vector<entry> _table;
+    unsigned _size;
+};
@@ -0,0 +1,349 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+///
+/// \author Chris Saunders
+///
+
+#include "blt_util/tabix_index_builder.hh"
+
+#include "blt_util/blt_exception.hh"
+
+extern "C" {
+#include "bgzf.h"
+}
+
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <sstream>
+
+
+
+// size in bases of each linear index window, as a shift:
+static const int linear_shift(14);
+
+
+
+/// get the smallest UCSC bin containing the zero-indexed range [beg,end)
+static
+uint32_t
+reg2bin(
+    const uint32_t beg,
+    uint32_t end)
+{
+    --end;
+    if (beg>>14 == end>>14) return 4681 + (beg>>14);
+    if (beg>>17 == end>>17) return  585 + (beg>>17);
+    if (beg>>20 == end>>20) return   73 + (beg>>20);
+    if (beg>>23 == end>>23) return    9 + (beg>>23);
+    if (beg>>26 == end>>26) return    1 + (beg>>26);
+    return 0;
+}
+
+
+
+tabix_index_builder::
+tabix_index_builder() :
+    _last_pos(0),
+    _is_bin(false),
+    _bin(0),
+    _bin_begin_offset(0),
+    _last_end_offset(0),
+    _is_first_offset_record(false),
+    _first_offset_begin_window(0),
+    _first_offset_end_window(0)
+{}
+
+
+
+void
+tabix_index_builder::
+save_bin_chunk(const uint64_t end_offset)
+{
+    if (! _is_bin) return;
+    _refs.back().bins[_bin].push_back(bam_index_chunk(_bin_begin_offset,end_offset));
+    _is_bin=false;
+}
+
+
+
+void
+tabix_index_builder::
+add(const std::string& chrom,
+    const int begin_pos,
+    const int init_end_pos,
+    const uint64_t begin_offset,
+    const uint64_t end_offset)
+{
+    const int end_pos(std::max(init_end_pos,(begin_pos+1)));
+
+    if (_refs.empty() || (_refs.back().name != chrom))
+    {
+        for (unsigned ref_idx(0); ref_idx<_refs.size(); ++ref_idx)
+        {
+            if (_refs[ref_idx].name != chrom) continue;
+            std::ostringstream oss;
+            oss << "ERROR: Records of chromosome '" << chrom << "' are not in a single block in indexed vcf file\n";
+            throw blt_exception(oss.str().c_str());
+        }
+
+        save_bin_chunk(_last_end_offset);
+        _refs.resize(_refs.size()+1);
+        _refs.back().name = chrom;
+    }
+    else if (begin_pos < _last_pos)
+    {
+        std::ostringstream oss;
+        oss << "ERROR: Records are not sorted by position in indexed vcf file at: " << chrom << ":" << (begin_pos+1) << "\n";
+        throw blt_exception(oss.str().c_str());
+    }
+
+    // linear index:
+    std::vector<uint64_t>& linear(_refs.back().linear);
+    const int begin_window(begin_pos >> linear_shift);
+    const int end_window((end_pos-1) >> linear_shift);
+    if (static_cast<int>(linear.size()) <= end_window) linear.resize(end_window+1,0);
+    for (int window(begin_window); window<=end_window; ++window)
+    {
+        if (0 == linear[window]) linear[window] = begin_offset;
+    }
+    if (0 == begin_offset)
+    {
+        _is_first_offset_record=true;
+        _first_offset_begin_window=begin_window;
+        _first_offset_end_window=end_window;
+    }
+
+    // binning index, each run of consecutive records in the same bin is one chunk:
+    const uint32_t bin(reg2bin(begin_pos,end_pos));
+    if ((! _is_bin) || (bin != _bin))
+    {
+        save_bin_chunk(begin_offset);
+        _is_bin=true;
+        _bin=bin;
+        _bin_begin_offset=begin_offset;
+    }
+
+    _last_pos=begin_pos;
+    _last_end_offset=end_offset;
+}
+
+
+
+static
+void
+put_int32(
+    const uint32_t val,
+    std::string& buffer)
+{
+    for (unsigned i(0); i<4; ++i) buffer.push_back(static_cast<char>((val >> (8*i)) & 0xff));
+}
+
+
+
+static
+void
+put_uint64(
+    const uint64_t val,
+    std::string& buffer)
+{
+    for (unsigned i(0); i<8; ++i) buffer.push_back(static_cast<char>((val >> (8*i)) & 0xff));
+}
+
+
+
+void
+tabix_index_builder::
+write(const std::string& filename)
+{
+    save_bin_chunk(_last_end_offset);
+
+    // merge chunks which end and begin in the same compressed block:
+    for (unsigned ref_idx(0); ref_idx<_refs.size(); ++ref_idx)
+    {
+        ref_data::bin_map& bins(_refs[ref_idx].bins);
+        for (ref_data::bin_map::iterator iter(bins.begin()); iter != bins.end(); ++iter)
+        {
+            std::vector<bam_index_chunk>& chunks(iter->second);
+            unsigned merge_index(0);
+            for (unsigned chunk_index(1); chunk_index<chunks.size(); ++chunk_index)
+            {
+                if ((chunks[merge_index].end >> 16) == (chunks[chunk_index].beg >> 16))
+                {
+                    chunks[merge_index].end = chunks[chunk_index].end;
+                }
+                else
+                {
+                    chunks[++merge_index] = chunks[chunk_index];
+                }
+            }
+            chunks.resize(merge_index+1);
+        }
+
+        // windows without records point to the previous window's offset:
+        std::vector<uint64_t>& linear(_refs[ref_idx].linear);
+        for (unsigned window(1); window<linear.size(); ++window)
+        {
+            if (0 == linear[window]) linear[window] = linear[window-1];
+        }
+    }
+
+    if (_is_first_offset_record && (! _refs.empty()))
+    {
+        std::vector<uint64_t>& linear(_refs.front().linear);
+        for (int window(_first_offset_begin_window); window<=_first_offset_end_window; ++window)
+        {
+            linear[window] = 0;
+        }
+    }
+
+    std::string buffer("TBI\1");
+    put_int32(_refs.size(),buffer);
+
+    // vcf preset: format, sequence column, begin column, end column, comment char, skipped lines
+    static const uint32_t vcf_conf[] = { 2, 1, 2, 0, '#', 0 };
+    for (unsigned i(0); i<6; ++i) put_int32(vcf_conf[i],buffer);
+
+    std::string names;
+    for (unsigned ref_idx(0); ref_idx<_refs.size(); ++ref_idx)
+    {
+        names += _refs[ref_idx].name;
+        names.push_back('\0');
+    }
+    put_int32(names.size(),buffer);
+    buffer += names;
+
+    for (unsigned ref_idx(0); ref_idx<_refs.size(); ++ref_idx)
+    {
+        const ref_data& ref(_refs[ref_idx]);
+        put_int32(ref.bins.size(),buffer);
+        for (ref_data::bin_map::const_iterator iter(ref.bins.begin()); iter != ref.bins.end(); ++iter)
+        {
+            put_int32(iter->first,buffer);
+            put_int32(iter->second.size(),buffer);
+            for (unsigned chunk_index(0); chunk_index<iter->second.size(); ++chunk_index)
+            {
+                put_uint64(iter->second[chunk_index].beg,buffer);
+                put_uint64(iter->second[chunk_index].end,buffer);
+            }
+        }
+        put_int32(ref.linear.size(),buffer);
+        for (unsigned window(0); window<ref.linear.size(); ++window)
+        {
+            put_uint64(ref.linear[window],buffer);
+        }
+    }
+
+    BGZF* fp(bgzf_open(filename.c_str(),"w"));
+    if ((NULL == fp) ||
+        (bgzf_write(fp,buffer.c_str(),buffer.size()) != static_cast<int>(buffer.size())) ||
+        (bgzf_close(fp) != 0))
+    {
+        std::ostringstream oss;
+        oss << "ERROR: Failed to write tabix index file: '" << filename << "'\n";
+        throw blt_exception(oss.str().c_str());
+    }
+}
+
+
+
+/// parse the leading decimal integer of [begin,end), the result is zero if there is none
+///
+/// \returns false if there are no digits
+static
+bool
+parse_bounded_int(
+    const char* begin,
+    const char* end,
+    long& val)
+{
+    bool is_negative(false);
+    if ((begin != end) && (*begin == '-'))
+    {
+        is_negative=true;
+        ++begin;
+    }
+    val=0;
+    const char* digit(begin);
+    for (; (digit != end) && (*digit >= '0') && (*digit <= '9'); ++digit)
+    {
+        val = val*10 + (*digit-'0');
+    }
+    if (is_negative) val = -val;
+    return (digit != begin);
+}
+
+
+
+bool
+get_vcf_record_range(
+    const char* line,
+    unsigned size,
+    std::string& chrom,
+    int& begin_pos,
+    int& end_pos)
+{
+    static const char info_end_key[] = "END=";
+    static const char info_tag_end_key[] = ";END=";
+
+    while ((size > 0) && ((line[size-1] == '\n') || (line[size-1] == '\r'))) --size;
+    const char* line_end(line+size);
+
+    bool is_pos(false);
+    const char* field_begin(line);
+    for (unsigned field_index(0); true; ++field_index)
+    {
+        const char* field_end(std::find(field_begin,line_end,'\t'));
+        if (0 == field_index)
+        {
+            chrom.assign(field_begin,field_end);
+        }
+        else if (1 == field_index)
+        {
+            long pos(0);
+            if (! parse_bounded_int(field_begin,field_end,pos)) return false;
+            begin_pos = std::max(0L,pos-1);
+            end_pos = std::max(1L,pos);
+            is_pos=true;
+        }
+        else if (3 == field_index)
+        {
+            if (field_end > field_begin) end_pos = begin_pos + (field_end-field_begin);
+        }
+        else if (7 == field_index)
+        {
+            // an END tag at the start of INFO, or else following a ';', replaces the REF end:
+            const char* key(std::search(field_begin,field_end,info_end_key,info_end_key+strlen(info_end_key)));
+            const char* val(NULL);
+            if (key == field_begin)
+            {
+                val = key+strlen(info_end_key);
+            }
+            else if (key != field_end)
+            {
+                key = std::search(field_begin,field_end,info_tag_end_key,info_tag_end_key+strlen(info_tag_end_key));
+                if (key != field_end) val = key+strlen(info_tag_end_key);
+            }
+
+            long info_end_pos(0);
+            if ((NULL != val) && parse_bounded_int(val,field_end,info_end_pos)) end_pos = info_end_pos;
+            break;
+        }
+
+        if (field_end == line_end) break;
+        field_begin = field_end+1;
+    }
+    return is_pos;
+}
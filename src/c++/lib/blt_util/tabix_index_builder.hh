@@ -0,0 +1,98 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+///
+/// \author Chris Saunders
+///
+
+#pragma once
+
+#include "blt_util/bam_index_reader.hh"
+
+#include "boost/utility.hpp"
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+
+/// build a tabix index of a BGZF-compressed VCF file as its records are written
+///
+/// records must be added in file order, sorted by position within each chromosome, with
+/// each chromosome in a single block. The index is the same as the one produced by
+/// 'tabix -p vcf' for the file.
+///
+struct tabix_index_builder : private boost::noncopyable
+{
+    tabix_index_builder();
+
+    /// add a record
+    ///
+    /// \param chrom record chromosome
+    /// \param begin_pos,end_pos zero-indexed range [begin_pos,end_pos) covered by the record
+    /// \param begin_offset,end_offset virtual file offsets of the start and end of the record
+    void
+    add(const std::string& chrom,
+        const int begin_pos,
+        const int end_pos,
+        const uint64_t begin_offset,
+        const uint64_t end_offset);
+
+    /// complete the index and write it to filename in BGZF-compressed tabix format
+    void
+    write(const std::string& filename);
+
+private:
+    struct ref_data
+    {
+        typedef std::map<uint32_t, std::vector<bam_index_chunk> > bin_map;
+
+        std::string name;
+        bin_map bins;
+        std::vector<uint64_t> linear;
+    };
+
+    /// add the chunk of consecutive records in the current bin to the binning index
+    void
+    save_bin_chunk(const uint64_t end_offset);
+
+    std::vector<ref_data> _refs;
+
+    int _last_pos;
+    bool _is_bin;
+    uint32_t _bin;
+    uint64_t _bin_begin_offset;
+    uint64_t _last_end_offset;
+
+    // tabix clears the linear index range of a record starting at the first byte of the file:
+    bool _is_first_offset_record;
+    int _first_offset_begin_window;
+    int _first_offset_end_window;
+};
+
+
+
+/// get the zero-indexed range of a VCF record line, using the same rules as 'tabix -p vcf'
+///
+/// the range begins at POS and ends at the end of REF, or at the INFO END value if present
+///
+/// \returns false if the CHROM and POS fields can't be parsed
+bool
+get_vcf_record_range(
+    const char* line,
+    unsigned size,
+    std::string& chrom,
+    int& begin_pos,
+    int& end_pos);
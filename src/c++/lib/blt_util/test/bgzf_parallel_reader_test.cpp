@@ -0,0 +1,216 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+#include "boost/test/unit_test.hpp"
+
+#include "bgzf_parallel_reader.hh"
+
+#include "boost/filesystem.hpp"
+
+#include "zlib.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+BOOST_AUTO_TEST_SUITE( test_bgzf_parallel_reader )
+
+
+/// write a single bgzf block containing data
+///
+/// \returns the compressed block size
+static
+unsigned
+writeBgzfBlock(std::ostream& os, const std::string& data)
+{
+    std::vector<unsigned char> cdata(compressBound(data.size())+64);
+
+    z_stream zs;
+    zs.zalloc = NULL;
+    zs.zfree = NULL;
+    zs.opaque = NULL;
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.c_str()));
+    zs.avail_in = data.size();
+    zs.next_out = &(cdata[0]);
+    zs.avail_out = cdata.size();
+    deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    deflate(&zs, Z_FINISH);
+    deflateEnd(&zs);
+
+    const unsigned blockSize(18+zs.total_out+8);
+    const unsigned char header[18] = { 31, 139, 8, 4, 0, 0, 0, 0, 0, 255, 6, 0, 'B', 'C', 2, 0,
+                                       static_cast<unsigned char>((blockSize-1) & 0xff),
+                                       static_cast<unsigned char>((blockSize-1) >> 8)
+                                     };
+    os.write(reinterpret_cast<const char*>(header),18);
+    os.write(reinterpret_cast<const char*>(&(cdata[0])),zs.total_out);
+
+    const uint32_t crc(crc32(crc32(0L, NULL, 0L), reinterpret_cast<const Bytef*>(data.c_str()), data.size()));
+    const uint32_t isize(data.size());
+    for (unsigned i(0); i<4; ++i) os.put(static_cast<char>((crc >> (8*i)) & 0xff));
+    for (unsigned i(0); i<4; ++i) os.put(static_cast<char>((isize >> (8*i)) & 0xff));
+    return blockSize;
+}
+
+
+
+struct BgzfTestFile
+{
+    BgzfTestFile() :
+        filename((boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string())
+    {
+        std::ofstream ofs(filename.c_str(), std::ios::binary);
+        int64_t address(0);
+        for (unsigned blockIndex(0); blockIndex<20; ++blockIndex)
+        {
+            std::string data;
+            for (unsigned i(0); i<(1000+blockIndex*100); ++i)
+            {
+                data.push_back('a'+((blockIndex+i)%26));
+            }
+            blockAddress.push_back(address);
+            blockData.push_back(data);
+            address += writeBgzfBlock(ofs,data);
+        }
+        // empty eof block:
+        writeBgzfBlock(ofs,"");
+    }
+
+    ~BgzfTestFile()
+    {
+        boost::filesystem::remove(filename);
+    }
+
+    std::string
+    getAll() const
+    {
+        std::string all;
+        for (unsigned blockIndex(0); blockIndex<blockData.size(); ++blockIndex)
+        {
+            all += blockData[blockIndex];
+        }
+        return all;
+    }
+
+    std::string filename;
+    std::vector<int64_t> blockAddress;
+    std::vector<std::string> blockData;
+};
+
+
+
+static
+void
+testReadAll(const unsigned threadCount)
+{
+    BgzfTestFile tf;
+    bgzf_parallel_reader reader(tf.filename.c_str(),threadCount);
+
+    std::vector<bgzf_block_range> plan(1,bgzf_block_range(0,tf.blockAddress.back()+100000));
+    reader.set_plan(plan);
+
+    const std::string expect(tf.getAll());
+    std::vector<char> buff(expect.size()+10);
+    BOOST_REQUIRE_EQUAL(reader.read(&(buff[0]),buff.size()),static_cast<int>(expect.size()));
+    BOOST_REQUIRE_EQUAL(std::string(&(buff[0]),expect.size()),expect);
+}
+
+
+
+BOOST_AUTO_TEST_CASE( test_bgzf_parallel_reader_read_all )
+{
+    testReadAll(0);
+    testReadAll(3);
+}
+
+
+
+static
+void
+testSeekPlan(const unsigned threadCount)
+{
+    BgzfTestFile tf;
+    bgzf_parallel_reader reader(tf.filename.c_str(),threadCount);
+
+    // plan to read blocks 2-3 and 10:
+    std::vector<bgzf_block_range> plan;
+    plan.push_back(bgzf_block_range(tf.blockAddress[2],tf.blockAddress[3]));
+    plan.push_back(bgzf_block_range(tf.blockAddress[10],tf.blockAddress[10]));
+    reader.set_plan(plan);
+
+    char buff[10];
+    reader.seek((static_cast<uint64_t>(tf.blockAddress[2])<<16) | 5);
+    BOOST_REQUIRE_EQUAL(reader.read(buff,10),10);
+    BOOST_REQUIRE_EQUAL(std::string(buff,10),tf.blockData[2].substr(5,10));
+    BOOST_REQUIRE_EQUAL(reader.tell(),((static_cast<uint64_t>(tf.blockAddress[2])<<16) | 15));
+
+    // read across block boundary:
+    const unsigned offset(tf.blockData[3].size()-4);
+    reader.seek((static_cast<uint64_t>(tf.blockAddress[3])<<16) | offset);
+    BOOST_REQUIRE_EQUAL(reader.read(buff,4),4);
+    BOOST_REQUIRE_EQUAL(std::string(buff,4),tf.blockData[3].substr(offset));
+    BOOST_REQUIRE_EQUAL(reader.tell(),(static_cast<uint64_t>(tf.blockAddress[4])<<16));
+
+    reader.seek((static_cast<uint64_t>(tf.blockAddress[10])<<16) | 1);
+    BOOST_REQUIRE_EQUAL(reader.read(buff,10),10);
+    BOOST_REQUIRE_EQUAL(std::string(buff,10),tf.blockData[10].substr(1,10));
+
+    // reading stops at the end of the plan:
+    std::vector<char> rest(100000);
+    BOOST_REQUIRE_EQUAL(reader.read(&(rest[0]),rest.size()),static_cast<int>(tf.blockData[10].size()-11));
+}
+
+
+
+BOOST_AUTO_TEST_CASE( test_bgzf_parallel_reader_seek_plan )
+{
+    testSeekPlan(0);
+    testSeekPlan(2);
+}
+
+
+static
+void
+testPrefetchRead(const unsigned threadCount)
+{
+    BgzfTestFile tf;
+    bgzf_prefetcher prefetcher(tf.filename.c_str(),true);
+    bgzf_parallel_reader reader(tf.filename.c_str(),threadCount);
+    reader.set_prefetcher(&prefetcher);
+
+    // results must be the same whether or not blocks are taken from the prefetcher:
+    std::vector<bgzf_block_range> plan(1,bgzf_block_range(tf.blockAddress[5],tf.blockAddress[15]));
+    prefetcher.add_request(plan);
+    reader.set_plan(plan);
+
+    std::string expect;
+    for (unsigned blockIndex(5); blockIndex<=15; ++blockIndex)
+    {
+        expect += tf.blockData[blockIndex];
+    }
+    std::vector<char> buff(expect.size()+10);
+    BOOST_REQUIRE_EQUAL(reader.read(&(buff[0]),buff.size()),static_cast<int>(expect.size()));
+    BOOST_REQUIRE_EQUAL(std::string(&(buff[0]),expect.size()),expect);
+}
+
+
+
+BOOST_AUTO_TEST_CASE( test_bgzf_parallel_reader_prefetch )
+{
+    testPrefetchRead(0);
+    testPrefetchRead(2);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,99 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+#include "boost/test/unit_test.hpp"
+
+#include "bgzf_vcf_writer.hh"
+
+#include "blt_util/blt_exception.hh"
+
+#include "boost/filesystem.hpp"
+
+#include <string>
+
+
+BOOST_AUTO_TEST_SUITE( test_bgzf_vcf_writer )
+
+
+struct VcfTestFile
+{
+    VcfTestFile() :
+        filename((boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string()+".vcf.gz"),
+        indexFilename(filename+".tbi")
+    {
+        header.chrom_data.push_back(bam_header_info::chrom_info("chr2",1000));
+        header.chrom_data.push_back(bam_header_info::chrom_info("chr10",1000));
+    }
+
+    ~VcfTestFile()
+    {
+        boost::filesystem::remove(filename);
+        boost::filesystem::remove(indexFilename);
+    }
+
+    std::string filename;
+    std::string indexFilename;
+    bam_header_info header;
+};
+
+
+
+static
+std::string
+readBgzfFile(const std::string& filename)
+{
+    BGZF* fp(bgzf_open(filename.c_str(),"r"));
+    BOOST_REQUIRE(NULL != fp);
+    std::string text;
+    char buffer[1024];
+    int readSize(0);
+    while ((readSize = bgzf_read(fp,buffer,sizeof(buffer))) > 0)
+    {
+        text.append(buffer,readSize);
+    }
+    bgzf_close(fp);
+    return text;
+}
+
+
+
+BOOST_AUTO_TEST_CASE( test_write_sorted_bgzf_vcf )
+{
+    VcfTestFile vcf;
+
+    static const std::string header("##fileformat=VCFv4.1\n#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\n");
+    static const std::string rec1("chr2\t10\ta\tA\t<DEL>\t.\tPASS\tEND=20\n");
+    static const std::string rec2("chr2\t30\tb\tA\t<DEL>\t.\tPASS\tEND=40\n");
+    static const std::string rec3("chr2\t30\tc\tA\t<DEL>\t.\tPASS\tEND=35\n");
+    static const std::string rec4("chr10\t5\td\tA\t<DEL>\t.\tPASS\tEND=50\n");
+
+    // chromosomes follow the header order, and records at the same position keep their input order:
+    write_sorted_bgzf_vcf(header+rec4+rec2+rec3+rec1,vcf.header,vcf.filename,vcf.indexFilename);
+
+    BOOST_REQUIRE_EQUAL(readBgzfFile(vcf.filename),(header+rec1+rec2+rec3+rec4));
+    BOOST_REQUIRE(boost::filesystem::exists(vcf.indexFilename));
+}
+
+
+
+BOOST_AUTO_TEST_CASE( test_write_sorted_bgzf_vcf_unknown_chrom )
+{
+    VcfTestFile vcf;
+
+    static const std::string text("#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\nchr3\t10\t.\tA\t<DEL>\t.\tPASS\t.\n");
+    BOOST_REQUIRE_THROW(write_sorted_bgzf_vcf(text,vcf.header,vcf.filename,vcf.indexFilename),blt_exception);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
+
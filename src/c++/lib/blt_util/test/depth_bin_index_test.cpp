@@ -0,0 +1,148 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+#include "boost/test/unit_test.hpp"
+
+#include "depth_bin_index.hh"
+
+#include "boost/filesystem.hpp"
+
+#include <cstdlib>
+
+#include <algorithm>
+#include <vector>
+
+
+BOOST_AUTO_TEST_SUITE( test_depth_bin_index )
+
+
+BOOST_AUTO_TEST_CASE( test_depth_bin_index_query )
+{
+    depth_bin_index dbi(10);
+    dbi.update(1,15,3);
+    dbi.update(1,42,5);
+    dbi.update(1,5,2);
+
+    BOOST_REQUIRE_EQUAL(dbi.get_max_depth(1,0,10),2u);
+    BOOST_REQUIRE_EQUAL(dbi.get_max_depth(1,0,11),3u);
+    BOOST_REQUIRE_EQUAL(dbi.get_max_depth(1,20,40),0u);
+    BOOST_REQUIRE_EQUAL(dbi.get_max_depth(1,39,41),5u);
+    BOOST_REQUIRE_EQUAL(dbi.get_max_depth(1,100,200),0u);
+    BOOST_REQUIRE_EQUAL(dbi.get_max_depth(0,0,100),0u);
+    BOOST_REQUIRE_EQUAL(dbi.get_max_depth(2,0,100),0u);
+
+    depth_bin_index dbi2(10);
+    dbi2.update(1,48,4);
+    dbi2.update(1,55,7);
+    dbi2.update(3,0,1);
+    dbi.merge(dbi2);
+
+    BOOST_REQUIRE_EQUAL(dbi.get_max_depth(1,40,50),5u);
+    BOOST_REQUIRE_EQUAL(dbi.get_max_depth(1,50,60),7u);
+    BOOST_REQUIRE_EQUAL(dbi.get_max_depth(3,0,60),1u);
+
+    const std::string filename((boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string());
+    dbi.save(filename.c_str());
+    depth_bin_index dbi3;
+    dbi3.load(filename.c_str());
+    boost::filesystem::remove(filename);
+
+    BOOST_REQUIRE_EQUAL(dbi3.bin_size(),10u);
+    BOOST_REQUIRE_EQUAL(dbi3.get_max_depth(1,0,11),3u);
+    BOOST_REQUIRE_EQUAL(dbi3.get_max_depth(1,50,60),7u);
+    BOOST_REQUIRE_EQUAL(dbi3.get_max_depth(3,0,60),1u);
+}
+
+
+
+BOOST_AUTO_TEST_CASE( test_depth_bin_index_builder )
+{
+    static const unsigned binSize(10);
+    static const pos_t chromSize(1000);
+
+    srand(11);
+    std::vector<std::pair<pos_t,pos_t> > reads;
+    for (unsigned i(0); i<300; ++i)
+    {
+        const pos_t begin(rand()%chromSize);
+        reads.push_back(std::make_pair(begin,begin+1+rand()%50));
+    }
+    std::sort(reads.begin(),reads.end());
+
+    std::vector<unsigned> depth(chromSize+100,0);
+    for (unsigned i(0); i<reads.size(); ++i)
+    {
+        for (pos_t pos(reads[i].first); pos<reads[i].second; ++pos) depth[pos]++;
+    }
+
+    // build the index over two regions, split within a bin:
+    static const pos_t splitPos(505);
+    depth_bin_index dbi(binSize);
+    {
+        depth_bin_index_builder builder(dbi,0,0,splitPos);
+        for (unsigned i(0); i<reads.size(); ++i)
+        {
+            if (reads[i].first >= splitPos) break;
+            builder.add(reads[i].first,reads[i].second);
+        }
+        builder.finish();
+    }
+    {
+        depth_bin_index dbi2(binSize);
+        depth_bin_index_builder builder(dbi2,0,splitPos,chromSize);
+        for (unsigned i(0); i<reads.size(); ++i)
+        {
+            if (reads[i].second <= splitPos) continue;
+            builder.add(reads[i].first,reads[i].second);
+        }
+        builder.finish();
+        dbi.merge(dbi2);
+    }
+
+    for (pos_t binBegin(0); binBegin<chromSize; binBegin += binSize)
+    {
+        const unsigned expect(*(std::max_element(depth.begin()+binBegin,depth.begin()+binBegin+binSize)));
+        BOOST_REQUIRE_EQUAL(dbi.get_max_depth(0,binBegin,binBegin+binSize),expect);
+    }
+}
+
+
+
+BOOST_AUTO_TEST_CASE( test_depth_bin_index_builder_alignment )
+{
+    // the second alignment begins within the deletion of the first, so that
+    // the match segment after the deletion is added out of alignment order:
+    ALIGNPATH::path_t apath1;
+    cigar_to_apath("10M30D10M",apath1);
+    ALIGNPATH::path_t apath2;
+    cigar_to_apath("15M",apath2);
+    ALIGNPATH::path_t apath3;
+    cigar_to_apath("5M",apath3);
+
+    depth_bin_index dbi(10);
+    depth_bin_index_builder builder(dbi,0,0,100);
+    builder.add_alignment(0,apath1);
+    builder.add_alignment(12,apath2);
+    builder.add_alignment(42,apath3);
+    builder.finish();
+
+    BOOST_REQUIRE_EQUAL(dbi.get_max_depth(0,0,10),1u);
+    BOOST_REQUIRE_EQUAL(dbi.get_max_depth(0,10,20),1u);
+    BOOST_REQUIRE_EQUAL(dbi.get_max_depth(0,20,30),1u);
+    BOOST_REQUIRE_EQUAL(dbi.get_max_depth(0,30,40),0u);
+    BOOST_REQUIRE_EQUAL(dbi.get_max_depth(0,40,50),2u);
+    BOOST_REQUIRE_EQUAL(dbi.get_max_depth(0,50,60),0u);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,38 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+#include "boost/test/unit_test.hpp"
+#include "boost/test/unit_test.hpp"
+
+#include "hash_util.hh"
+
+#include <cstring>
+
+
+BOOST_AUTO_TEST_SUITE( test_hash_util )
+
+
+BOOST_AUTO_TEST_CASE( test_fnv1a_hash )
+{
+    // published FNV-1a 32 bit test vectors:
+    BOOST_REQUIRE_EQUAL(fnv1a_hash(""),0x811c9dc5u);
+    BOOST_REQUIRE_EQUAL(fnv1a_hash("a"),0xe40c292cu);
+    BOOST_REQUIRE_EQUAL(fnv1a_hash("foobar"),0xbf9cf968u);
+
+    const char* key("foobar");
+    BOOST_REQUIRE_EQUAL(fnv1a_hash(key,strlen(key)),fnv1a_hash(key));
+    BOOST_REQUIRE_EQUAL(fnv1a_hash(key,0),fnv1a_hash(""));
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
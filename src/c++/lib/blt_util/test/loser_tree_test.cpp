@@ -0,0 +1,123 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+#include "boost/test/unit_test.hpp"
+
+#include "loser_tree.hh"
+
+#include <cstdlib>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+
+BOOST_AUTO_TEST_SUITE( test_loser_tree )
+
+
+typedef std::vector<std::vector<int> > sources_t;
+
+
+/// merge sources and return (key,source) pairs in merge order
+static
+std::vector<std::pair<int,unsigned> >
+mergeSources(
+    const sources_t& sources,
+    const bool isRun)
+{
+    std::vector<unsigned> head(sources.size(),0);
+    loser_tree<int> lt(sources.size());
+    for (unsigned i(0); i<sources.size(); ++i)
+    {
+        if (! sources[i].empty()) lt.set_source(i,sources[i][0]);
+    }
+    lt.build();
+
+    std::vector<std::pair<int,unsigned> > result;
+    while (! lt.empty())
+    {
+        const unsigned index(lt.top());
+        result.push_back(std::make_pair(lt.top_key(),index));
+        head[index]++;
+        if (head[index] < sources[index].size())
+        {
+            if (isRun) lt.replace_top_run(sources[index][head[index]]);
+            else       lt.replace_top(sources[index][head[index]]);
+        }
+        else
+        {
+            lt.pop_top();
+        }
+    }
+    return result;
+}
+
+
+
+static
+void
+testMerge(const sources_t& sources)
+{
+    std::vector<std::pair<int,unsigned> > expect;
+    for (unsigned i(0); i<sources.size(); ++i)
+    {
+        for (unsigned j(0); j<sources[i].size(); ++j)
+        {
+            expect.push_back(std::make_pair(sources[i][j],i));
+        }
+    }
+    std::stable_sort(expect.begin(),expect.end());
+
+    BOOST_REQUIRE(mergeSources(sources,false) == expect);
+    BOOST_REQUIRE(mergeSources(sources,true) == expect);
+}
+
+
+
+BOOST_AUTO_TEST_CASE( test_loser_tree_small )
+{
+    sources_t sources;
+    testMerge(sources);
+
+    sources.resize(1);
+    sources[0].push_back(3);
+    sources[0].push_back(5);
+    testMerge(sources);
+
+    sources.resize(3);
+    sources[2].push_back(1);
+    sources[2].push_back(3);
+    sources[2].push_back(4);
+    testMerge(sources);
+}
+
+
+
+BOOST_AUTO_TEST_CASE( test_loser_tree_random )
+{
+    srand(11);
+    for (unsigned sourceCount(1); sourceCount<20; ++sourceCount)
+    {
+        sources_t sources(sourceCount);
+        for (unsigned i(0); i<sourceCount; ++i)
+        {
+            const unsigned size(rand()%50);
+            for (unsigned j(0); j<size; ++j) sources[i].push_back(rand()%100);
+            std::sort(sources[i].begin(),sources[i].end());
+        }
+        testMerge(sources);
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,104 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+
+#include "boost/test/unit_test.hpp"
+
+#include "reference_window_cache.hh"
+
+#include "blt_util/blt_exception.hh"
+
+#include "boost/filesystem.hpp"
+
+#include <fstream>
+#include <string>
+
+
+BOOST_AUTO_TEST_SUITE( test_reference_window_cache )
+
+
+struct FastaTestFile
+{
+    FastaTestFile() :
+        filename((boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string()+".fa"),
+        chr1("ACGTAcgtNNaaccggttACGTRYACGTACGTAAACCCGGGTTT"),
+        chr2("GATTACAgattaca")
+    {
+        std::ofstream ofs(filename.c_str());
+        ofs << ">chr1 description\n";
+        for (unsigned i(0); i<chr1.size(); i+=10) ofs << chr1.substr(i,10) << "\n";
+        ofs << ">chr2\n" << chr2 << "\n";
+    }
+
+    ~FastaTestFile()
+    {
+        boost::filesystem::remove(filename);
+        boost::filesystem::remove(filename+".fai");
+    }
+
+    std::string filename;
+    std::string chr1;
+    std::string chr2;
+};
+
+
+
+static
+std::string
+getExpectSeq(
+    const std::string& chrom,
+    const int beginPos,
+    const int endPos)
+{
+    std::string expect;
+    for (int pos(beginPos); pos<endPos; ++pos)
+    {
+        if ((pos<0) || (pos>=static_cast<int>(chrom.size())))
+        {
+            expect.push_back('N');
+            continue;
+        }
+        char c(toupper(chrom[pos]));
+        if ((c=='R') || (c=='Y')) c='N';
+        expect.push_back(c);
+    }
+    return expect;
+}
+
+
+
+BOOST_AUTO_TEST_CASE( test_reference_window_cache_seq )
+{
+    FastaTestFile tf;
+
+    // a small window size and count exercises window boundaries and eviction:
+    reference_window_cache ref(tf.filename,7,2);
+
+    std::string seq;
+    for (int beginPos(-3); beginPos<static_cast<int>(tf.chr1.size())+3; ++beginPos)
+    {
+        for (int size(0); size<16; ++size)
+        {
+            ref.get_seq("chr1",beginPos,beginPos+size,seq);
+            BOOST_REQUIRE_EQUAL(seq,getExpectSeq(tf.chr1,beginPos,beginPos+size));
+
+            ref.get_seq("chr2",beginPos,beginPos+size,seq);
+            BOOST_REQUIRE_EQUAL(seq,getExpectSeq(tf.chr2,beginPos,beginPos+size));
+        }
+    }
+
+    BOOST_CHECK_THROW(ref.get_seq("chr3",0,1,seq), blt_exception);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,144 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+#include "boost/test/unit_test.hpp"
+
+#include "size_distribution.hh"
+
+#include "boost/archive/binary_iarchive.hpp"
+#include "boost/archive/binary_oarchive.hpp"
+
+#include <sstream>
+#include <vector>
+
+
+BOOST_AUTO_TEST_SUITE( test_size_distribution )
+
+
+BOOST_AUTO_TEST_CASE( test_size_distribution_quantile )
+{
+    size_distribution sd;
+    BOOST_REQUIRE_EQUAL(sd.quantile(0.5),0);
+
+    for (int i(1); i<=100; ++i) sd.add_observation(i);
+    BOOST_REQUIRE_EQUAL(sd.total_observations(),100u);
+    BOOST_REQUIRE_EQUAL(sd.quantile(0.25),26);
+    BOOST_REQUIRE_EQUAL(sd.quantile(0.5),51);
+    BOOST_REQUIRE_EQUAL(sd.quantile(0.75),76);
+    BOOST_REQUIRE_EQUAL(sd.quantile(1.0),100);
+    BOOST_REQUIRE_EQUAL(sd.quantile(0.0),1);
+
+    // even sample size, quantiles match indexing the sorted sample at floor(prob*n):
+    size_distribution sd4;
+    for (int i(1); i<=4; ++i) sd4.add_observation(i*10);
+    BOOST_REQUIRE_EQUAL(sd4.quantile(0.25),20);
+    BOOST_REQUIRE_EQUAL(sd4.quantile(0.5),30);
+    BOOST_REQUIRE_EQUAL(sd4.quantile(0.75),40);
+
+    // out of range values are clamped:
+    sd.add_observation(-5);
+    sd.add_observation(size_distribution::max_size()+10);
+    BOOST_REQUIRE_EQUAL(sd.quantile(0.0),0);
+    BOOST_REQUIRE_EQUAL(sd.quantile(1.0),size_distribution::max_size());
+}
+
+
+
+BOOST_AUTO_TEST_CASE( test_size_distribution_quantile_table )
+{
+    size_distribution sd;
+    std::vector<int> table;
+    sd.quantile_table(4,table);
+    BOOST_REQUIRE_EQUAL(table.size(),5u);
+    BOOST_REQUIRE_EQUAL(table[2],0);
+
+    for (int i(1); i<=4; ++i) sd.add_observation(i*10);
+    sd.quantile_table(4,table);
+    static const int expect[] = {10,20,30,40,40};
+    for (unsigned i(0); i<5; ++i)
+    {
+        BOOST_REQUIRE_EQUAL(table[i],expect[i]);
+        BOOST_REQUIRE_EQUAL(table[i],sd.quantile(i/4.));
+    }
+
+    for (int i(1); i<=100; ++i) sd.add_observation(i);
+    sd.quantile_table(8,table);
+    for (unsigned i(0); i<=8; ++i)
+    {
+        BOOST_REQUIRE_EQUAL(table[i],sd.quantile(i/8.));
+    }
+}
+
+
+
+BOOST_AUTO_TEST_CASE( test_size_distribution_write_read )
+{
+    size_distribution sd;
+    sd.add_observation(300);
+    sd.add_observation(300);
+    sd.add_observation(10);
+
+    std::ostringstream oss;
+    sd.write(oss);
+    BOOST_REQUIRE_EQUAL(oss.str(),std::string("10:1,300:2"));
+
+    size_distribution sd2;
+    sd2.read(oss.str());
+    BOOST_REQUIRE_EQUAL(sd2.total_observations(),3u);
+    BOOST_REQUIRE_EQUAL(sd2.quantile(0.5),300);
+}
+
+
+
+BOOST_AUTO_TEST_CASE( test_size_distribution_count )
+{
+    size_distribution sd;
+    BOOST_REQUIRE_EQUAL(sd.max_observed_size(),0);
+
+    sd.add_observations(250,3);
+    sd.add_observation(120);
+    BOOST_REQUIRE_EQUAL(sd.count(250),3u);
+    BOOST_REQUIRE_EQUAL(sd.count(120),1u);
+    BOOST_REQUIRE_EQUAL(sd.count(121),0u);
+    BOOST_REQUIRE_EQUAL(sd.count(-1),0u);
+    BOOST_REQUIRE_EQUAL(sd.count(100000),0u);
+    BOOST_REQUIRE_EQUAL(sd.max_observed_size(),250);
+}
+
+
+
+BOOST_AUTO_TEST_CASE( test_size_distribution_serialize )
+{
+    size_distribution sd;
+    sd.add_observations(300,4);
+    sd.add_observation(10);
+
+    std::stringstream ss;
+    {
+        boost::archive::binary_oarchive oa(ss);
+        oa << sd;
+    }
+
+    size_distribution sd2;
+    {
+        boost::archive::binary_iarchive ia(ss);
+        ia >> sd2;
+    }
+    BOOST_REQUIRE_EQUAL(sd2.total_observations(),5u);
+    BOOST_REQUIRE_EQUAL(sd2.count(300),4u);
+    BOOST_REQUIRE_EQUAL(sd2.count(10),1u);
+    BOOST_REQUIRE_EQUAL(sd2.max_observed_size(),300);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
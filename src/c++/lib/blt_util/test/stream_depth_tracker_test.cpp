@@ -0,0 +1,46 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+#include "boost/test/unit_test.hpp"
+
+#include "stream_depth_tracker.hh"
+
+
+BOOST_AUTO_TEST_SUITE( test_stream_depth_tracker )
+
+
+BOOST_AUTO_TEST_CASE( test_stream_depth_tracker_add )
+{
+    stream_depth_tracker sdt;
+
+    BOOST_REQUIRE_EQUAL(sdt.add(10,20),1u);
+    BOOST_REQUIRE_EQUAL(sdt.add(12,15),2u);
+    BOOST_REQUIRE_EQUAL(sdt.add(14,30),3u);
+
+    // the read ending at 15 no longer overlaps:
+    BOOST_REQUIRE_EQUAL(sdt.add(15,25),3u);
+
+    // reads ending at 20 and 25 no longer overlap:
+    BOOST_REQUIRE_EQUAL(sdt.add(25,26),2u);
+    BOOST_REQUIRE_EQUAL(sdt.depth(),2u);
+
+    BOOST_REQUIRE_EQUAL(sdt.advance(25),2u);
+    BOOST_REQUIRE_EQUAL(sdt.advance(26),1u);
+    BOOST_REQUIRE_EQUAL(sdt.add(100,110),1u);
+
+    sdt.clear();
+    BOOST_REQUIRE_EQUAL(sdt.depth(),0u);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
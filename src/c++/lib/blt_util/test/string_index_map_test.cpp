@@ -0,0 +1,72 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+#include "boost/test/unit_test.hpp"
+
+#include "string_index_map.hh"
+
+#include <sstream>
+
+
+BOOST_AUTO_TEST_SUITE( test_string_index_map )
+
+
+BOOST_AUTO_TEST_CASE( test_string_index_map_find )
+{
+    string_index_map sim;
+    unsigned index(0);
+    BOOST_REQUIRE(sim.empty());
+    BOOST_REQUIRE(! sim.find("lib1",index));
+
+    sim.insert("lib1",3);
+    sim.insert("lib2",5);
+    BOOST_REQUIRE_EQUAL(sim.size(),2u);
+    BOOST_REQUIRE(sim.find("lib1",index));
+    BOOST_REQUIRE_EQUAL(index,3u);
+    BOOST_REQUIRE(sim.find("lib2",index));
+    BOOST_REQUIRE_EQUAL(index,5u);
+    BOOST_REQUIRE(! sim.find("lib",index));
+    BOOST_REQUIRE(! sim.find("",index));
+
+    // replace existing key:
+    sim.insert("lib1",7);
+    BOOST_REQUIRE_EQUAL(sim.size(),2u);
+    BOOST_REQUIRE(sim.find("lib1",index));
+    BOOST_REQUIRE_EQUAL(index,7u);
+}
+
+
+
+BOOST_AUTO_TEST_CASE( test_string_index_map_resize )
+{
+    string_index_map sim;
+    for (unsigned i(0); i<1000; ++i)
+    {
+        std::ostringstream oss;
+        oss << "rg" << i;
+        sim.insert(oss.str().c_str(),i);
+    }
+    BOOST_REQUIRE_EQUAL(sim.size(),1000u);
+
+    for (unsigned i(0); i<1000; ++i)
+    {
+        std::ostringstream oss;
+        oss << "rg" << i;
+        unsigned index(0);
+        BOOST_REQUIRE(sim.find(oss.str().c_str(),index));
+        BOOST_REQUIRE_EQUAL(index,i);
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,85 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+#include "boost/test/unit_test.hpp"
+
+#include "tabix_index_builder.hh"
+
+#include "blt_util/blt_exception.hh"
+
+#include <cstring>
+
+
+BOOST_AUTO_TEST_SUITE( test_tabix_index_builder )
+
+
+static
+void
+testRange(
+    const char* line,
+    const char* expectChrom,
+    const int expectBegin,
+    const int expectEnd)
+{
+    std::string chrom;
+    int beginPos(0);
+    int endPos(0);
+    BOOST_REQUIRE(get_vcf_record_range(line,strlen(line),chrom,beginPos,endPos));
+    BOOST_REQUIRE_EQUAL(chrom,std::string(expectChrom));
+    BOOST_REQUIRE_EQUAL(beginPos,expectBegin);
+    BOOST_REQUIRE_EQUAL(endPos,expectEnd);
+}
+
+
+
+BOOST_AUTO_TEST_CASE( test_vcf_record_range )
+{
+    // the range ends at the end of REF:
+    testRange("chr1\t100\t.\tACG\t<DEL>\t.\tPASS\tSVTYPE=DEL\n","chr1",99,102);
+
+    // or at an INFO END value:
+    testRange("chr1\t100\t.\tA\t<DEL>\t.\tPASS\tEND=1000;SVTYPE=DEL\n","chr1",99,1000);
+    testRange("chr2\t100\t.\tA\t<DEL>\t.\tPASS\tSVTYPE=DEL;END=2000\tGT\t0/1\n","chr2",99,2000);
+
+    // other tags ending in END are ignored:
+    testRange("chr1\t100\t.\tA\t<DEL>\t.\tPASS\tSVTYPE=DEL;CIEND=-5,5\n","chr1",99,100);
+
+    // a record without the optional fields:
+    testRange("chr1\t1","chr1",0,1);
+
+    std::string chrom;
+    int beginPos(0);
+    int endPos(0);
+    static const char badLine[] = "chr1\tpos\t.\tA\n";
+    BOOST_REQUIRE(! get_vcf_record_range(badLine,strlen(badLine),chrom,beginPos,endPos));
+}
+
+
+
+BOOST_AUTO_TEST_CASE( test_tabix_index_builder_order )
+{
+    tabix_index_builder index;
+    index.add("chr1",100,200,10,20);
+    index.add("chr1",100,150,20,30);
+    index.add("chr2",50,51,30,40);
+
+    // records out of order within a chromosome:
+    BOOST_REQUIRE_THROW(index.add("chr2",10,11,40,50),blt_exception);
+
+    // chromosomes split into several blocks:
+    BOOST_REQUIRE_THROW(index.add("chr1",300,301,40,50),blt_exception);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
+
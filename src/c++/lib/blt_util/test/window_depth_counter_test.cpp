@@ -0,0 +1,101 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+#include "boost/test/unit_test.hpp"
+
+#include "window_depth_counter.hh"
+
+#include <cstdlib>
+
+#include <algorithm>
+#include <vector>
+
+
+BOOST_AUTO_TEST_SUITE( test_window_depth_counter )
+
+
+BOOST_AUTO_TEST_CASE( test_window_depth_counter_add )
+{
+    window_depth_counter wdc(10,10);
+    BOOST_REQUIRE_EQUAL(wdc.max_depth(),0u);
+
+    wdc.add(5,12);
+    wdc.add(11,15);
+    wdc.add(14,30);
+    wdc.add(19,20);
+    wdc.add(20,25);
+
+    std::vector<unsigned> depth;
+    wdc.get_depth(depth);
+    static const unsigned expect[] = {1,2,1,1,2,1,1,1,1,2};
+    BOOST_REQUIRE_EQUAL(depth.size(),10u);
+    for (unsigned i(0); i<10; ++i)
+    {
+        BOOST_REQUIRE_EQUAL(depth[i],expect[i]);
+    }
+    BOOST_REQUIRE_EQUAL(wdc.max_depth(),2u);
+
+    wdc.reset(100,5);
+    BOOST_REQUIRE_EQUAL(wdc.max_depth(),0u);
+}
+
+
+
+BOOST_AUTO_TEST_CASE( test_window_depth_counter_add_alignment )
+{
+    // only match segments add depth, deletions and skips still advance the position:
+    ALIGNPATH::path_t apath;
+    cigar_to_apath("2S3M2D2M1I2M3N2M",apath);
+
+    window_depth_counter wdc(10,20);
+    wdc.add_alignment(9,apath);
+
+    std::vector<unsigned> depth;
+    wdc.get_depth(depth);
+    static const unsigned expect[] = {1,1,0,0,1,1,1,1,0,0,0,1,1,0,0,0,0,0,0,0};
+    BOOST_REQUIRE_EQUAL(depth.size(),20u);
+    for (unsigned i(0); i<20; ++i)
+    {
+        BOOST_REQUIRE_EQUAL(depth[i],expect[i]);
+    }
+}
+
+
+
+BOOST_AUTO_TEST_CASE( test_window_depth_counter_random )
+{
+    static const pos_t beginPos(200);
+    static const unsigned size(100);
+
+    srand(3);
+    window_depth_counter wdc(beginPos,size);
+    std::vector<unsigned> expect(size,0);
+    for (unsigned i(0); i<500; ++i)
+    {
+        const pos_t begin(rand()%500);
+        const pos_t end(begin+rand()%80);
+        wdc.add(begin,end);
+        for (pos_t pos(std::max(begin,beginPos)); pos<std::min(end,beginPos+static_cast<pos_t>(size)); ++pos)
+        {
+            expect[pos-beginPos]++;
+        }
+    }
+
+    std::vector<unsigned> depth;
+    wdc.get_depth(depth);
+    BOOST_REQUIRE(depth == expect);
+    BOOST_REQUIRE_EQUAL(wdc.max_depth(),*(std::max_element(expect.begin(),expect.end())));
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,105 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+/// \file
+
+/// \author Chris Saunders
+///
+
+#include "blt_util/window_depth_counter.hh"
+
+#include <algorithm>
+
+
+
+void
+window_depth_counter::
+reset(const pos_t begin_pos,
+      const unsigned size)
+{
+    _begin_pos=begin_pos;
+    _end_pos=begin_pos+size;
+    _diff.assign(size+1,0);
+}
+
+
+
+void
+window_depth_counter::
+add(pos_t begin_pos,
+    pos_t end_pos)
+{
+    begin_pos=std::max(begin_pos,_begin_pos);
+    end_pos=std::min(end_pos,_end_pos);
+    if (begin_pos >= end_pos) return;
+
+    _diff[begin_pos-_begin_pos]++;
+    _diff[end_pos-_begin_pos]--;
+}
+
+
+
+void
+window_depth_counter::
+add_alignment(pos_t pos,
+              const ALIGNPATH::path_t& apath)
+{
+    using namespace ALIGNPATH;
+
+    const unsigned as(apath.size());
+    for (unsigned i(0); i<as; ++i)
+    {
+        const path_segment& ps(apath[i]);
+        if (MATCH == ps.type)
+        {
+            add(pos,(pos+static_cast<pos_t>(ps.length)));
+        }
+        if (is_segment_type_ref_length(ps.type)) pos += ps.length;
+    }
+}
+
+
+
+unsigned
+window_depth_counter::
+max_depth() const
+{
+    // the prefix sum and max are fused into one branch-free pass:
+    const unsigned size(_end_pos-_begin_pos);
+    const int* diff(_diff.empty() ? NULL : &(_diff[0]));
+    int depth(0);
+    int max(0);
+    for (unsigned i(0); i<size; ++i)
+    {
+        depth += diff[i];
+        max = std::max(max,depth);
+    }
+    return max;
+}
+
+
+
+void
+window_depth_counter::
+get_depth(std::vector<unsigned>& depth) const
+{
+    const unsigned size(_end_pos-_begin_pos);
+    depth.resize(size);
+
+    int sum(0);
+    for (unsigned i(0); i<size; ++i)
+    {
+        sum += _diff[i];
+        depth[i] = sum;
+    }
+}
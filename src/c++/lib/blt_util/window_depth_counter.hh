@@ -0,0 +1,72 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+/// \file
+
+/// \author Chris Saunders
+///
+
+#pragma once
+
+#include "blt_util/align_path.hh"
+#include "blt_util/blt_types.hh"
+
+#include <vector>
+
+
+/// accumulate read depth over a fixed window of positions
+///
+/// each covered range is recorded as a +1 at its start and a -1 at its end in a difference
+/// array, so adding a range costs O(1) regardless of its length. Depth is resolved with a
+/// single prefix sum over the window when it is queried.
+///
+struct window_depth_counter
+{
+    window_depth_counter(
+        const pos_t begin_pos = 0,
+        const unsigned size = 0)
+    {
+        reset(begin_pos,size);
+    }
+
+    /// clear all depth and move the window to the zero-indexed range [begin_pos,begin_pos+size)
+    void
+    reset(const pos_t begin_pos,
+          const unsigned size);
+
+    /// add one to the depth of the zero-indexed range [begin_pos,end_pos), clipped to the window
+    void
+    add(pos_t begin_pos,
+        pos_t end_pos);
+
+    /// add one to the depth of each aligned (match) segment of an alignment starting at
+    /// zero-indexed pos, clipped to the window
+    void
+    add_alignment(pos_t pos,
+                  const ALIGNPATH::path_t& apath);
+
+    /// max depth over the window
+    unsigned
+    max_depth() const;
+
+    /// get the depth at each position of the window
+    void
+    get_depth(std::vector<unsigned>& depth) const;
+
+private:
+    pos_t _begin_pos;
+    pos_t _end_pos;
+
+    // one extra element holds the ends of ranges reaching past the window:
+    std::vector<int> _diff;
+};
@@ -106,6 +106,12 @@ struct ReadPairOrient
         _val=new_val;
     }
 
+    template<class Archive>
+    void serialize(Archive& ar, const unsigned /* version */)
+    {
+        ar& _val;
+    }
+
 private:
     PAIR_ORIENT::index_t _val;
 };
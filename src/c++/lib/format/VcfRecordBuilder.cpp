@@ -0,0 +1,54 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+
+///
+/// \author Chris Saunders
+///
+
+#include "format/VcfRecordBuilder.hh"
+
+#include <iostream>
+
+
+
+void
+VcfRecordBuilder::
+appendInt(const long val)
+{
+    // digits are written backwards into a local buffer, which holds the digits of any long:
+    char digits[24];
+    char* end(digits+sizeof(digits));
+    char* begin(end);
+
+    unsigned long uval(val<0 ? (0ul-static_cast<unsigned long>(val)) : static_cast<unsigned long>(val));
+    do
+    {
+        *(--begin) = ('0'+static_cast<char>(uval%10));
+        uval /= 10;
+    }
+    while (uval != 0);
+    if (val<0) *(--begin) = '-';
+
+    _buffer.append(begin,end);
+}
+
+
+
+void
+VcfRecordBuilder::
+write(std::ostream& os)
+{
+    _buffer.push_back('\n');
+    os.write(_buffer.data(),_buffer.size());
+}
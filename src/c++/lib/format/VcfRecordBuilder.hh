@@ -0,0 +1,170 @@
+// -*- mode: c++; indent-tabs-mode: nil; -*-
+//
+// Manta
+// Copyright (c) 2013 Illumina, Inc.
+//
+// This software is provided under the terms and conditions of the
+// Illumina Open Source Software License 1.
+//
+// You should have received a copy of the Illumina Open Source
+// Software License 1 along with this program. If not, see
+// <https://github.com/downloads/sequencing/licenses/>.
+//
+
+
+///
+/// \author Chris Saunders
+///
+
+#pragma once
+
+#include <iosfwd>
+#include <string>
+
+
+/// builds the text of one VCF record in a reusable buffer
+///
+/// fields are tab separated and INFO tags are ';' separated as they are added, integers
+/// are converted to text directly into the buffer, and clear() keeps the buffer storage,
+/// so that formatting a record doesn't allocate once the buffer has grown to the size of
+/// a typical record.
+///
+struct VcfRecordBuilder
+{
+    VcfRecordBuilder() :
+        _isFirstField(true),
+        _isFirstInfo(true)
+    {}
+
+    /// start a new record, buffer storage is kept
+    void
+    clear()
+    {
+        _buffer.clear();
+        _isFirstField=true;
+        _isFirstInfo=true;
+    }
+
+    /// start a new field, which can be filled in with the append methods
+    void
+    beginField()
+    {
+        if (! _isFirstField) _buffer.push_back('\t');
+        _isFirstField=false;
+    }
+
+    void
+    append(const char c)
+    {
+        _buffer.push_back(c);
+    }
+
+    void
+    append(const char* s)
+    {
+        _buffer.append(s);
+    }
+
+    void
+    append(const std::string& s)
+    {
+        _buffer.append(s);
+    }
+
+    void
+    appendInt(const long val);
+
+    void
+    addField(const char val)
+    {
+        beginField();
+        append(val);
+    }
+
+    void
+    addField(const char* val)
+    {
+        beginField();
+        append(val);
+    }
+
+    void
+    addField(const std::string& val)
+    {
+        beginField();
+        append(val);
+    }
+
+    void
+    addIntField(const long val)
+    {
+        beginField();
+        appendInt(val);
+    }
+
+    /// start the INFO field, INFO tags are added to this field until the next field is started
+    void
+    beginInfo()
+    {
+        beginField();
+        _isFirstInfo=true;
+    }
+
+    /// start a new INFO tag "key=", or the flag "key" if isFlag is true
+    void
+    beginInfoTag(
+        const char* key,
+        const bool isFlag = false)
+    {
+        if (! _isFirstInfo) _buffer.push_back(';');
+        _isFirstInfo=false;
+        _buffer.append(key);
+        if (! isFlag) _buffer.push_back('=');
+    }
+
+    void
+    addInfoFlag(const char* key)
+    {
+        beginInfoTag(key,true);
+    }
+
+    void
+    addInfo(
+        const char* key,
+        const std::string& val)
+    {
+        beginInfoTag(key);
+        append(val);
+    }
+
+    void
+    addIntInfo(
+        const char* key,
+        const long val)
+    {
+        beginInfoTag(key);
+        appendInt(val);
+    }
+
+    /// add the INFO tag "key=val1,val2"
+    void
+    addIntInfo(
+        const char* key,
+        const long val1,
+        const long val2)
+    {
+        beginInfoTag(key);
+        appendInt(val1);
+        append(',');
+        appendInt(val2);
+    }
+
+    /// end the record and write it to os
+    void
+    write(std::ostream& os);
+
+private:
+    std::string _buffer;
+    bool _isFirstField;
+    bool _isFirstInfo;
+};
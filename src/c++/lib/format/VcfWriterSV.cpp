@@ -17,8 +17,6 @@
 
 #include "format/VcfWriterSV.hh"
 
-#include "blt_util/samtools_fasta_util.hh"
-#include "blt_util/string_util.hh"
 #include "blt_util/vcf_util.hh"
 
 #include <iostream>
@@ -33,7 +31,7 @@ VcfWriterSV(
     _minPairCount(set.getMinMergeEdgeCount()),
     _header(set.header),
     _os(os),
-    _idFormatter("MantaBND:%i:%i:%i:%i:")
+    _refCache(referenceFilename)
 {
 }
 
@@ -87,20 +85,25 @@ writeHeaderSuffix()
 
 
 
+/// add the breakend ID "MantaBND:locus:node1:node2:svIndex:bndIndex" to the current field of record
 static
 void
-makeInfoField(
-    const std::vector<std::string>& info,
-    std::ostream& os)
+appendBndId(
+    const EdgeInfo& edge,
+    const unsigned svIndex,
+    const bool isFirstBnd,
+    VcfRecordBuilder& record)
 {
-    static const char sep(';');
-    bool isFirst(true);
-    BOOST_FOREACH(const std::string& is, info)
-    {
-        if (! isFirst) os << sep;
-        else          isFirst = false;
-        os << is;
-    }
+    record.append("MantaBND:");
+    record.appendInt(edge.locusIndex);
+    record.append(':');
+    record.appendInt(edge.nodeIndex1);
+    record.append(':');
+    record.appendInt(edge.nodeIndex2);
+    record.append(':');
+    record.appendInt(svIndex);
+    record.append(':');
+    record.append(isFirstBnd ? '0' : '1');
 }
 
 
@@ -110,11 +113,10 @@ VcfWriterSV::
 writeTransloc(
     const SVBreakend& bp1,
     const SVBreakend& bp2,
-    const std::string& idPrefix,
+    const EdgeInfo& edge,
+    const unsigned svIndex,
     const bool isFirstOfPair)
 {
-    std::vector<std::string> infotags;
-
     // get CHROM
     const std::string& chrom(_header.chrom_data[bp1.interval.tid].label);
     const std::string& mate_chrom(_header.chrom_data[bp2.interval.tid].label);
@@ -126,35 +128,23 @@ writeTransloc(
     const pos_t pos(bp1range.center_pos()+1);
     const pos_t mate_pos(bp2range.center_pos()+1);
 
-    // get ID
-    const std::string localId(idPrefix + (isFirstOfPair ? '0' : '1'));
-    const std::string mateId(idPrefix + (isFirstOfPair ? '1' : '0'));
-
     // get REF
-    std::string ref;
-    get_standardized_region_seq(_referenceFilename,chrom,pos-1,pos-1,ref);
+    _refCache.get_seq(chrom,pos-1,pos,_ref);
 
-    assert(1 == ref.size());
+    assert(1 == _ref.size());
 
-    // build alt:
-    boost::format altFormat("%4%%3%%1%:%2%%3%%5%");
-    {
-        std::string altPrefix;
-        std::string altSuffix;
-        if     (bp1.state == SVBreakendState::RIGHT_OPEN)
-        {
-            altPrefix=ref;
-        }
-        else if (bp1.state == SVBreakendState::LEFT_OPEN)
-        {
-            altSuffix=ref;
-        }
-        else
-        {
-            assert(! "Unexpected bp2.state");
-        }
+    _record.clear();
+    _record.addField(chrom);
+    _record.addIntField(pos);
+
+    // ID:
+    _record.beginField();
+    appendBndId(edge,svIndex,isFirstOfPair,_record);
 
+    _record.addField(_ref);
 
+    // ALT:
+    {
         char altSep('?');
         if     (bp2.state == SVBreakendState::RIGHT_OPEN)
         {
@@ -169,33 +159,41 @@ writeTransloc(
             assert(! "Unexpected bp2.state");
         }
 
-        altFormat % mate_chrom % mate_pos % altSep % altPrefix % altSuffix;
+        const bool isRefPrefix(bp1.state == SVBreakendState::RIGHT_OPEN);
+        if (! (isRefPrefix || (bp1.state == SVBreakendState::LEFT_OPEN)))
+        {
+            assert(! "Unexpected bp1.state");
+        }
+
+        _record.beginField();
+        if (isRefPrefix) _record.append(_ref);
+        _record.append(altSep);
+        _record.append(mate_chrom);
+        _record.append(':');
+        _record.appendInt(mate_pos);
+        _record.append(altSep);
+        if (! isRefPrefix) _record.append(_ref);
     }
 
-    // build INFO field
-    infotags.push_back("SVTYPE=BND");
-    infotags.push_back("MATEID="+mateId);
-    infotags.push_back( str(boost::format("BND_PAIR_SUPPORT=%i") % bp1.readCount) );
-    infotags.push_back( str(boost::format("PAIR_SUPPORT=%i") % bp1.pairCount) );
+    _record.addField('.'); // QUAL
+    addFilterField(_record); // FILTER
+
+    // INFO:
+    _record.beginInfo();
+    _record.addInfo("SVTYPE","BND");
+    _record.beginInfoTag("MATEID");
+    appendBndId(edge,svIndex,(! isFirstOfPair),_record);
+    _record.addIntInfo("BND_PAIR_SUPPORT",bp1.readCount);
+    _record.addIntInfo("PAIR_SUPPORT",bp1.pairCount);
     if (! bp1.isPrecise())
     {
-        infotags.push_back("IMPRECISE");
-        infotags.push_back( str( boost::format("CIPOS=%i,%i") % (bp1range.begin_pos()+1) % bp1range.end_pos() ) );
+        _record.addInfoFlag("IMPRECISE");
+        _record.addIntInfo("CIPOS",(bp1range.begin_pos()+1),bp1range.end_pos());
     }
 
-    modifyInfo(isFirstOfPair, infotags);
-
-    // write out record:
-    _os << chrom
-        << '\t' << pos
-        << '\t' << localId // ID
-        << '\t' << ref // REF
-        << '\t' << str( altFormat ) // ALT
-        << '\t' << '.' // QUAL
-        << '\t' << getFilter() // FILTER
-        << '\t';
-    makeInfoField(infotags,_os); // INFO
-    _os << '\n';
+    modifyInfo(isFirstOfPair, _record);
+
+    _record.write(_os);
 }
 
 
@@ -207,10 +205,8 @@ writeTranslocPair(
     const unsigned svIndex,
     const SVCandidate& sv)
 {
-    const std::string idPrefix( str(_idFormatter % edge.locusIndex % edge.nodeIndex1 % edge.nodeIndex2 % svIndex ) );
-
-    writeTransloc(sv.bp1, sv.bp2, idPrefix, true);
-    writeTransloc(sv.bp2, sv.bp1, idPrefix, false);
+    writeTransloc(sv.bp1, sv.bp2, edge, svIndex, true);
+    writeTransloc(sv.bp2, sv.bp1, edge, svIndex, false);
 }
 
 
@@ -218,15 +214,13 @@ void
 VcfWriterSV::
 writeInvdel(
     const SVCandidate& sv,
-    const std::string& label)
+    const char* label)
 {
     const bool isBp1First(sv.bp1.interval.range.end_pos()<sv.bp2.interval.range.begin_pos());
 
     const SVBreakend& bpA(isBp1First ? sv.bp1 : sv.bp2);
     const SVBreakend& bpB(isBp1First ? sv.bp2 : sv.bp1);
 
-    std::vector<std::string> infotags;
-
     // get CHROM
     const std::string& chrom(_header.chrom_data[sv.bp1.interval.tid].label);
 
@@ -239,55 +233,55 @@ writeInvdel(
 
     const pos_t endPos(bpBrange.center_pos()+1);
 
-    // get ID
-    static const std::string localId(".");
-
     // get REF
-    std::string ref;
-    get_standardized_region_seq(_referenceFilename,chrom,pos-1,pos-1,ref);
-
-    assert(1 == ref.size());
-
-    // build alt:
-    const std::string alt( str( boost::format("<%s>") % label));
-
-    // build INFO field
-    std::vector<std::string> words;
-    split_string(label,':',words);
-    infotags.push_back( str(boost::format("SVTYPE=%s") % words[0]));
-    infotags.push_back( str(boost::format("END=%i") % endPos));
-    infotags.push_back( str(boost::format("SVLEN=%i") % (endPos-pos+1)));
-    infotags.push_back( str(boost::format("UPSTREAM_PAIR_SUPPORT=%i") % bpA.readCount) );
-    infotags.push_back( str(boost::format("DOWNSTREAM_PAIR_SUPPORT=%i") % bpB.readCount) );
-    infotags.push_back( str(boost::format("PAIR_SUPPORT=%i") % bpA.pairCount) );
+    _refCache.get_seq(chrom,pos-1,pos,_ref);
+
+    assert(1 == _ref.size());
+
+    _record.clear();
+    _record.addField(chrom);
+    _record.addIntField(pos);
+    _record.addField('.'); // ID
+    _record.addField(_ref);
+
+    // ALT:
+    _record.beginField();
+    _record.append('<');
+    _record.append(label);
+    _record.append('>');
+
+    _record.addField('.'); // QUAL
+    addFilterField(_record); // FILTER
+
+    // INFO:
+    _record.beginInfo();
+
+    // SVTYPE is the label up to any ':' subtype:
+    _record.beginInfoTag("SVTYPE");
+    for (const char* c(label); ((*c != '\0') && (*c != ':')); ++c) _record.append(*c);
+
+    _record.addIntInfo("END",endPos);
+    _record.addIntInfo("SVLEN",(endPos-pos+1));
+    _record.addIntInfo("UPSTREAM_PAIR_SUPPORT",bpA.readCount);
+    _record.addIntInfo("DOWNSTREAM_PAIR_SUPPORT",bpB.readCount);
+    _record.addIntInfo("PAIR_SUPPORT",bpA.pairCount);
     if ((! bpA.isPrecise()) || (! bpB.isPrecise()))
     {
-        infotags.push_back("IMPRECISE");
+        _record.addInfoFlag("IMPRECISE");
     }
 
     if (! bpA.isPrecise())
     {
-        infotags.push_back( str( boost::format("CIPOS=%i,%i") % (bpArange.begin_pos()+1) % bpArange.end_pos() ) );
+        _record.addIntInfo("CIPOS",(bpArange.begin_pos()+1),bpArange.end_pos());
     }
     if (! bpB.isPrecise())
     {
-        infotags.push_back( str( boost::format("CIEND=%i,%i") % (bpBrange.begin_pos()+1) % bpBrange.end_pos() ) );
+        _record.addIntInfo("CIEND",(bpBrange.begin_pos()+1),bpBrange.end_pos());
     }
 
-    //modifyInfo(isFirstOfPair, infotags);
-
-    // write out record:
-    _os << chrom
-        << '\t' << pos
-        << '\t' << localId // ID
-        << '\t' << ref // REF
-        << '\t' << alt // ALT
-        << '\t' << '.' // QUAL
-        << '\t' << getFilter() // FILTER
-        << '\t';
-    makeInfoField(infotags,_os); // INFO
-    _os << '\n';
+    //modifyInfo(isFirstOfPair, _record);
 
+    _record.write(_os);
 }
 
 
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include "blt_util/reference_window_cache.hh"
+#include "format/VcfRecordBuilder.hh"
 #include "svgraph/EdgeInfo.hh"
 #include "manta/SVCandidate.hh"
 #include "manta/SVCandidateData.hh"
@@ -24,8 +26,6 @@
 #include "manta/SomaticSVScoreInfo.hh"
 #include "options/SomaticCallOptions.hh"
 
-#include "boost/format.hpp"
-
 #include <iosfwd>
 
 
@@ -71,18 +71,20 @@ protected:
         const unsigned svIndex,
         const SVCandidate& sv);
 
+    /// add any additional INFO tags to the current record
     virtual
     void
     modifyInfo(
         const bool /*isFirstOfPair*/,
-        std::vector<std::string>& /*infotags*/) const
+        VcfRecordBuilder& /*record*/) const
     {}
 
+    /// add the FILTER field to the current record
     virtual
-    std::string
-    getFilter() const
+    void
+    addFilterField(VcfRecordBuilder& record) const
     {
-        return ".";
+        record.addField('.');
     }
 
 private:
@@ -91,7 +93,8 @@ private:
     writeTransloc(
         const SVBreakend& bp1,
         const SVBreakend& bp2,
-        const std::string& idPrefix,
+        const EdgeInfo& edge,
+        const unsigned svIndex,
         const bool isFirstOfPair);
 
     void
@@ -103,7 +106,7 @@ private:
     void
     writeInvdel(
         const SVCandidate& sv,
-        const std::string& label);
+        const char* label);
 
     void
     writeInversion(
@@ -130,6 +133,11 @@ private:
 protected:
     std::ostream& _os;
 private:
-    boost::format _idFormatter;
+    /// reference bases for each record are read through a cache of reference windows
+    reference_window_cache _refCache;
+
+    // record text and reference bases are built in buffers reused for every record:
+    VcfRecordBuilder _record;
+    std::string _ref;
 };
 
@@ -17,7 +17,7 @@
 
 #include "format/VcfWriterSomaticSV.hh"
 
-#include "boost/algorithm/string/join.hpp"
+#include "boost/foreach.hpp"
 
 
 
@@ -46,39 +46,46 @@ void
 VcfWriterSomaticSV::
 modifyInfo(
     const bool isFirstOfPair,
-    std::vector<std::string>& infotags) const
+    VcfRecordBuilder& record) const
 {
     assert(_ssInfoPtr != NULL);
     const SomaticSVScoreInfo& ssInfo(*_ssInfoPtr);
 
-    infotags.push_back( str(boost::format("SOMATICSCORE=%i") % ssInfo.somaticScore) );
-    infotags.push_back( str(boost::format("NORMAL_PAIR_SUPPORT=%i") % ssInfo.normal.spanPairs) );
-    infotags.push_back( str(boost::format("TUMOR_PAIR_SUPPORT=%i") % ssInfo.tumor.spanPairs) );
-    infotags.push_back( str(boost::format("NORMAL_BND_PAIR_SUPPORT=%i") %
-                            (isFirstOfPair ? ssInfo.normal.bp1SpanReads : ssInfo.normal.bp2SpanReads) ) );
-    infotags.push_back( str(boost::format("TUMOR_BND_PAIR_SUPPORT=%i") %
-                            (isFirstOfPair ? ssInfo.tumor.bp1SpanReads : ssInfo.tumor.bp2SpanReads) ) );
-    infotags.push_back( str(boost::format("BND_DEPTH=%i") %
-                            (isFirstOfPair ? ssInfo.bp1MaxDepth : ssInfo.bp2MaxDepth) ) );
-    infotags.push_back( str(boost::format("MATE_BND_DEPTH=%i") %
-                            (isFirstOfPair ? ssInfo.bp2MaxDepth : ssInfo.bp1MaxDepth) ) );
+    record.addIntInfo("SOMATICSCORE",ssInfo.somaticScore);
+    record.addIntInfo("NORMAL_PAIR_SUPPORT",ssInfo.normal.spanPairs);
+    record.addIntInfo("TUMOR_PAIR_SUPPORT",ssInfo.tumor.spanPairs);
+    record.addIntInfo("NORMAL_BND_PAIR_SUPPORT",
+                      (isFirstOfPair ? ssInfo.normal.bp1SpanReads : ssInfo.normal.bp2SpanReads));
+    record.addIntInfo("TUMOR_BND_PAIR_SUPPORT",
+                      (isFirstOfPair ? ssInfo.tumor.bp1SpanReads : ssInfo.tumor.bp2SpanReads));
+    record.addIntInfo("BND_DEPTH",
+                      (isFirstOfPair ? ssInfo.bp1MaxDepth : ssInfo.bp2MaxDepth));
+    record.addIntInfo("MATE_BND_DEPTH",
+                      (isFirstOfPair ? ssInfo.bp2MaxDepth : ssInfo.bp1MaxDepth));
 }
 
 
-std::string
+void
 VcfWriterSomaticSV::
-getFilter() const
+addFilterField(VcfRecordBuilder& record) const
 {
     assert(_ssInfoPtr != NULL);
     const SomaticSVScoreInfo& ssInfo(*_ssInfoPtr);
 
     if (ssInfo.filters.empty())
     {
-        return "PASS";
+        record.addField("PASS");
     }
     else
     {
-        return boost::algorithm::join(ssInfo.filters, ";");
+        record.beginField();
+        bool isFirst(true);
+        BOOST_FOREACH(const std::string& filter, ssInfo.filters)
+        {
+            if (! isFirst) record.append(';');
+            else          isFirst = false;
+            record.append(filter);
+        }
     }
 }
 
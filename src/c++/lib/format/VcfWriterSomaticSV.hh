@@ -55,10 +55,10 @@ private:
     void
     modifyInfo(
         const bool isFirstOfPair,
-        std::vector<std::string>& infotags) const;
+        VcfRecordBuilder& record) const;
 
-    std::string
-    getFilter() const;
+    void
+    addFilterField(VcfRecordBuilder& record) const;
 
     const SomaticCallOptions& _somaticOpt;
     const bool _isMaxDepthFilter;
@@ -28,11 +28,15 @@ ChromDepthFilterUtil::
 ChromDepthFilterUtil(
     const std::string& chromDepthFile,
     const double maxDepthFactor,
-    const bam_header_info& header) :
-    _isMaxDepthFilter(! chromDepthFile.empty())
+    const bam_header_info& header,
+    const std::string& depthIndexFile) :
+    _isMaxDepthFilter(! chromDepthFile.empty()),
+    _isDepthIndex(! depthIndexFile.empty())
 {
     using namespace illumina::common;
 
+    if (_isDepthIndex) _depthIndex.load(depthIndexFile.c_str());
+
     // read in chrom depth file if one is specified:
     if (! _isMaxDepthFilter) return;
 
@@ -19,6 +19,8 @@
 
 #include "blt_util/bam_header_info.hh"
 #include "blt_util/chrom_depth_map.hh"
+#include "blt_util/depth_bin_index.hh"
+#include "blt_util/known_pos_range2.hh"
 
 #include <cassert>
 
@@ -30,12 +32,16 @@
 /// preprocess the chrom depth file so that the filter value can be
 /// efficiently looked up by bam tid
 ///
+/// when a binned depth index file is given, local max depth queries can also be
+/// answered from memory
+///
 struct ChromDepthFilterUtil
 {
     ChromDepthFilterUtil(
         const std::string& chromDepthFile,
         const double maxDepthFactor,
-        const bam_header_info& header);
+        const bam_header_info& header,
+        const std::string& depthIndexFile = "");
 
     bool
     isMaxDepthFilter() const
@@ -50,7 +56,26 @@ struct ChromDepthFilterUtil
         return _maxDepthFilter[tid];
     }
 
+    bool
+    isDepthIndex() const
+    {
+        return _isDepthIndex;
+    }
+
+    /// max depth over the depth index bins intersecting range of chromosome tid
+    unsigned
+    indexMaxDepth(
+        const int32_t tid,
+        const known_pos_range2& range) const
+    {
+        assert(_isDepthIndex);
+        return _depthIndex.get_max_depth(tid,range.begin_pos(),range.end_pos());
+    }
+
 private:
     bool _isMaxDepthFilter;
     std::vector<double> _maxDepthFilter;
+
+    bool _isDepthIndex;
+    depth_bin_index _depthIndex;
 };
@@ -15,13 +15,18 @@
 #include "ReadGroupStats.hh"
 
 #include "blt_util/bam_streamer.hh"
+#include "blt_util/bam_index_reader.hh"
 #include "blt_util/log.hh"
 #include "blt_util/parse_util.hh"
 
+#include <boost/foreach.hpp>
 #include <boost/math/distributions/normal.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/random_number_generator.hpp>
 
 #include <cmath>
 
+#include <algorithm>
 #include <iostream>
 #include <vector>
 
@@ -39,6 +44,10 @@ const unsigned STAT_INS_SIZE_SD_IDX        = 1;
 const unsigned STAT_INS_SIZE_MEDIAN_IDX    = 2;
 
 const unsigned STAT_REL_ORIENT_IDX         = 3;
+const unsigned STAT_FRAG_SIZE_DIST_IDX     = 4;
+
+// minimum number of sampled read pairs used to estimate stats:
+const unsigned MIN_PAIR_OBSERVATIONS       = 1000;
 
 
 /* ----- ----- ----- ----- ----- -----
@@ -51,23 +60,19 @@ const unsigned STAT_REL_ORIENT_IDX         = 3;
 
 static
 bool
-calcStats(std::vector<int32_t>& data,
+calcStats(const size_distribution& data,
           PairStatSet& stats)
 {
-
-    const unsigned n(data.size());
-    if (n == 0)
+    if (data.total_observations() == 0)
     {
         stats.clear();
         return false;
     }
 
-    // First we'll sort to calculate the median
-    sort(data.begin(), data.end());
-    stats.median=(data[(uint32_t)(n * 0.5)]);
+    stats.median=data.quantile(0.5);
 
     // this is iqr, but we call it sd:
-    stats.sd=(data[(uint32_t)(n * 0.75)] - data[(uint32_t)(n * 0.25)]);
+    stats.sd=(data.quantile(0.75) - data.quantile(0.25));
 
     return true;
 }
@@ -114,29 +119,160 @@ getRelOrient(const bam_record& br)
 
 
 
+/// a section of the genome to sample reads from
+struct SampleWindow
+{
+    SampleWindow(
+        const int32_t initTid = 0,
+        const int32_t initBeginPos = 0) :
+        tid(initTid),
+        beginPos(initBeginPos)
+    {}
+
+    int32_t tid;
+    int32_t beginPos;
+};
+
+
+
+/// get all bam linear index windows which contain read start positions, in random order
+///
+/// a fixed random seed is used so that the stats estimate is reproducible
+///
+static
+void
+getShuffledSampleWindows(
+    const std::string& statsBamFile,
+    std::vector<SampleWindow>& windows)
+{
+    windows.clear();
+
+    const bam_index_reader index(statsBamFile.c_str());
+    const int32_t windowSize(bam_index_reader::linear_window_size());
+
+    const unsigned refCount(index.ref_count());
+    for (unsigned tid(0); tid<refCount; ++tid)
+    {
+        const std::vector<uint64_t>& linear(index.get_linear_index(tid));
+        const unsigned linearSize(linear.size());
+        for (unsigned i(0); i<linearSize; ++i)
+        {
+            if (0 == linear[i]) continue;
+
+            // a window sharing its minimum offset with the next window holds few if any read starts:
+            if (((i+1) < linearSize) && (linear[i+1] == linear[i])) continue;
+            windows.push_back(SampleWindow(tid,i*windowSize));
+        }
+    }
+
+    boost::mt19937 rng(42);
+    boost::random_number_generator<boost::mt19937> gen(rng);
+    std::random_shuffle(windows.begin(),windows.end(),gen);
+}
+
+
+
 /* ----- ----- ----- ----- ----- -----
  * ----- PairStatSet  -----
  * ----- ----- ----- ----- ----- ----- */
+
+// resolution of the quantile lookup table, the read scanner trim probabilities
+// are multiples of 1e-4 so these are represented exactly:
+static const unsigned quantileTableSize(10000);
+
+
+
+void
+PairStatSet::
+setDistribution(const size_distribution& dist)
+{
+    distribution = dist;
+    _pmf.clear();
+    _cdf.clear();
+    _quantile.clear();
+
+    const unsigned total(dist.total_observations());
+    if (0 == total) return;
+
+    const int maxSize(dist.max_observed_size());
+    _pmf.resize(maxSize+1,0.);
+    _cdf.resize(maxSize+1,0.);
+
+    double cumulative(0.);
+    for (int size(0); size<=maxSize; ++size)
+    {
+        const unsigned count(dist.count(size));
+        cumulative += count;
+        _pmf[size] = static_cast<float>(static_cast<double>(count)/total);
+        _cdf[size] = static_cast<float>(cumulative/total);
+    }
+    _cdf[maxSize] = 1.;
+
+    // use the same quantile definition as the median and sd estimates:
+    dist.quantile_table(quantileTableSize,_quantile);
+}
+
+
+
 double
 PairStatSet::
 quantile(const double p) const
 {
+    if (_quantile.empty())
+    {
+        // stats files without a stored distribution:
+        boost::math::normal dist(median,sd);
+        return boost::math::quantile(dist, p);
+    }
 
-    // put in hack temporary implementation:
-    boost::math::normal dist(median,sd);
-    return boost::math::quantile(dist, p);
+    if (p <= 0.) return _quantile.front();
+    if (p >= 1.) return _quantile.back();
+
+    // the scanner trim probabilities are multiples of 1e-4, so rounding to the nearest
+    // table step only removes float representation error from p:
+    return _quantile[static_cast<unsigned>((p*quantileTableSize)+0.5)];
 }
 
+
+
 double
 PairStatSet::
 cdf(const double x) const
 {
+    if (_cdf.empty())
+    {
+        // stats files without a stored distribution:
+        boost::math::normal dist(median,sd);
+        return boost::math::cdf(dist, x);
+    }
+
+    if (x < 0.) return 0.;
+    const unsigned size(static_cast<unsigned>(x));
+    if (size >= _cdf.size()) return 1.;
+    return _cdf[size];
+}
+
+
+
+double
+PairStatSet::
+pdf(const double x) const
+{
+    if (_pmf.empty())
+    {
+        // stats files without a stored distribution:
+        boost::math::normal dist(median,sd);
+        return boost::math::pdf(dist, x);
+    }
 
-    // put in hack temporary implementation:
-    boost::math::normal dist(median,sd);
-    return boost::math::cdf(dist, x);
+    if (x < 0.) return 0.;
+    const unsigned size(static_cast<unsigned>(x+0.5));
+    if (size >= _pmf.size()) return 0.;
+    return _pmf[size];
 }
 
+
+
 std::ostream&
 operator<<(std::ostream& os, const PairStatSet& pss)
 {
@@ -162,6 +298,14 @@ ReadGroupStats(const std::vector<std::string>& data)
     fragSize.median = parse_double_str(data[STAT_INS_SIZE_MEDIAN_IDX]);
 
     relOrients.setVal(PAIR_ORIENT::get_index(data[STAT_REL_ORIENT_IDX].c_str()));
+
+    // stats files written before the full distribution was stored only provide median and sd:
+    if (data.size() > STAT_FRAG_SIZE_DIST_IDX)
+    {
+        size_distribution dist;
+        dist.read(data[STAT_FRAG_SIZE_DIST_IDX]);
+        fragSize.setDistribution(dist);
+    }
 }
 
 
@@ -169,109 +313,114 @@ ReadGroupStats(const std::vector<std::string>& data)
 // set read pair statistics from a bam reader object:
 //
 ReadGroupStats::
-ReadGroupStats(const std::string& statsBamFile)
+ReadGroupStats(
+    const std::string& statsBamFile,
+    const unsigned decompressThreadCount,
+    std::map<std::string,ReadGroupStats>* rgStats)
 {
 
     static const unsigned statsCheckCnt(100000);
     static const unsigned maxPosCount(1);
 
-    bam_streamer read_stream(statsBamFile.c_str());
+    bam_streamer read_stream(statsBamFile.c_str(),NULL,decompressThreadCount);
 
-    const bam_header_t& header(* read_stream.get_header());
-    const int32_t nChrom(header.n_targets);
-    std::vector<int32_t> chromSize(nChrom,0);
-    std::vector<int32_t> chromHighestPos(nChrom,-1);
-    for (int32_t i(0); i<nChrom; ++i)
-    {
-        chromSize[i] = (header.target_len[i]);
-    }
+    // sample reads from index windows in random order, this converges
+    // with far fewer seeks than walking through each chromosome:
+    std::vector<SampleWindow> windows;
+    getShuffledSampleWindows(statsBamFile,windows);
+    const int32_t windowSize(bam_index_reader::linear_window_size());
 
     bool isConverged(false);
     bool isStopEstimation(false);
     unsigned recordCnts(0);
 
-    unsigned posCount(0);
-
     bool isPairTypeSet(false);
 
     PairStatsData psd;
 
-    bool isActiveChrom(true);
-    while (isActiveChrom && (!isStopEstimation))
+    BOOST_FOREACH(const SampleWindow& window, windows)
     {
-        isActiveChrom=false;
-        for (int32_t i(0); i<nChrom; ++i)
-        {
-            if (isStopEstimation) break;
+        if (isStopEstimation) break;
 
-            const int32_t startPos(chromHighestPos[i]+1);
 #ifdef DEBUG_RPS
-            std::cerr << "INFO: Stats requesting bam region starting from: chrid: " << i << " start: " << startPos << "\n";
+        std::cerr << "INFO: Stats requesting bam region: chrid: " << window.tid << " start: " << window.beginPos << "\n";
 #endif
-            read_stream.set_new_region(i,startPos,chromSize[i]);
-            while (read_stream.next())
-            {
-                const bam_record& al(*(read_stream.get_record_ptr()));
-                if (al.pos()<startPos) continue;
+        const int32_t endPos(window.beginPos+windowSize);
+        read_stream.set_new_region(window.tid,window.beginPos,endPos);
 
-                if (al.pos()!=chromHighestPos[i])
-                {
-                    posCount=0;
-                }
+        int32_t lastPos(-1);
+        unsigned posCount(0);
+        while (read_stream.next())
+        {
+            const bam_record& al(*(read_stream.get_record_ptr()));
 
-                chromHighestPos[i]=al.pos();
-                isActiveChrom=true;
+            // only sample reads starting in this window:
+            const int32_t pos(al.pos()-1);
+            if (pos < window.beginPos) continue;
+            if (pos >= endPos) break;
 
-                if (! (al.is_paired() && al.is_proper_pair())) continue;
-                if (al.map_qual()==0) continue;
+            if (pos != lastPos)
+            {
+                posCount=0;
+                lastPos=pos;
+            }
 
-                // sample each read pair once by sampling stats from
-                // upstream read only:
-                if (al.pos()<al.mate_pos()) continue;
+            if (! (al.is_paired() && al.is_proper_pair())) continue;
+            if (al.map_qual()==0) continue;
 
-                // to prevent high-depth pileups from overly biasing the
-                // read stats, we only take maxPosCount read pairs from each start
-                // pos:
-                if (posCount>=maxPosCount) continue;
-                posCount++;
+            // sample each read pair once by sampling stats from
+            // upstream read only:
+            if (al.pos()<al.mate_pos()) continue;
 
-                ++recordCnts;
+            // to prevent high-depth pileups from overly biasing the
+            // read stats, we only take maxPosCount read pairs from each start
+            // pos:
+            if (posCount>=maxPosCount) continue;
+            posCount++;
 
-                // Assuming only two reads per fragment - based on bamtools.
-                const unsigned int readNum(al.is_first() ? 1 : 2);
-                assert(al.is_second() == (readNum == 2));
+            ++recordCnts;
 
-                if (! isPairTypeSet)
-                {
-                    // TODO: does orientation need to be averaged over several observations?
-                    relOrients = getRelOrient(al);
-                    isPairTypeSet=true;
-                }
+            // Assuming only two reads per fragment - based on bamtools.
+            const unsigned int readNum(al.is_first() ? 1 : 2);
+            assert(al.is_second() == (readNum == 2));
 
-                psd.fragmentLengths.push_back(std::abs(al.template_size()));
+            if (! isPairTypeSet)
+            {
+                // TODO: does orientation need to be averaged over several observations?
+                relOrients = getRelOrient(al);
+                isPairTypeSet=true;
+            }
 
-                if ((recordCnts % statsCheckCnt) != 0) continue;
+            psd.fragmentLengths.add_observation(std::abs(al.template_size()));
+
+            if (NULL != rgStats)
+            {
+                static const char rgTag[] = {'R','G'};
+                const char* rg(al.get_string_tag(rgTag));
+                if (NULL != rg) psd.rgFragmentLengths[rg].add_observation(std::abs(al.template_size()));
+            }
+
+            if ((recordCnts % statsCheckCnt) != 0) continue;
 
 #ifdef DEBUG_RPS
-                log_os << "INFO: Checking stats convergence at record count : " << recordCnts << "'\n"
-                       << "INFO: Stats before convergence check: ";
-                write(log_os);
-                log_os << "\n";
+            log_os << "INFO: Checking stats convergence at record count : " << recordCnts << "'\n"
+                   << "INFO: Stats before convergence check: ";
+            write(log_os);
+            log_os << "\n";
 #endif
 
-                isConverged=computePairStats(psd);
-                if (isConverged || (recordCnts>5000000)) isStopEstimation=true;
-                break;
-            }
+            isConverged=computePairStats(psd);
+            if (isConverged || (recordCnts>5000000)) isStopEstimation=true;
+            break;
         }
     }
 
     if (! isConverged)
     {
-        if (psd.fragmentLengths.size()<1000)
+        if (psd.fragmentLengths.total_observations()<MIN_PAIR_OBSERVATIONS)
         {
             log_os << "ERROR: Can't generate pair statistics for BAM file " << statsBamFile << "\n";
-            log_os << "\tTotal observed read pairs: " << psd.fragmentLengths.size() << "\n";
+            log_os << "\tTotal observed read pairs: " << psd.fragmentLengths.total_observations() << "\n";
             exit(EXIT_FAILURE);
         }
         isConverged=computePairStats(psd);
@@ -283,6 +432,28 @@ ReadGroupStats(const std::string& statsBamFile)
         // make sure stats are estimated for all values if we're going to continue:
         computePairStats(psd,true);
     }
+
+    fragSize.setDistribution(psd.fragmentLengths);
+
+    if (NULL != rgStats)
+    {
+        rgStats->clear();
+
+        // a single read group has the same stats as the whole file:
+        if (psd.rgFragmentLengths.size() > 1)
+        {
+            typedef std::map<std::string,size_distribution> rgdist_t;
+            BOOST_FOREACH(const rgdist_t::value_type& val, psd.rgFragmentLengths)
+            {
+                if (val.second.total_observations()<MIN_PAIR_OBSERVATIONS) continue;
+
+                ReadGroupStats& rgs((*rgStats)[val.first]);
+                rgs.relOrients = relOrients;
+                calcStats(val.second,rgs.fragSize);
+                rgs.fragSize.setDistribution(val.second);
+            }
+        }
+    }
 }
 
 
@@ -316,6 +487,7 @@ ReadGroupStats::
 write(std::ostream& os) const
 {
     os << fragSize << "\t"
-       << relOrients;
+       << relOrients << "\t";
+    fragSize.distribution.write(os);
 }
 
@@ -15,6 +15,7 @@
 #pragma once
 
 #include "blt_util/id_map.hh"
+#include "blt_util/size_distribution.hh"
 #include "common/ReadPairOrient.hh"
 
 #include <iosfwd>
@@ -23,6 +24,7 @@
 #include <map>
 
 #include "boost/optional.hpp"
+#include "boost/serialization/split_member.hpp"
 
 
 struct PairStatSet
@@ -38,6 +40,9 @@ struct PairStatSet
 
     // return value for which we observe value or less with prob p
     // (not sure what the exact way to phrase this is for the discrete case)
+    //
+    // for an empirical distribution this is size_distribution::quantile(p), with p
+    // rounded to the nearest multiple of 1e-4
     double
     quantile(const double p) const;
 
@@ -45,6 +50,34 @@ struct PairStatSet
     double
     cdf(const double x) const;
 
+    // probability of observing fragment size x
+    double
+    pdf(const double x) const;
+
+    /// set the empirical distribution and precompute its pmf, cdf and quantile lookup tables
+    ///
+    /// when no distribution is set the quantile/cdf/pdf interface falls back to a
+    /// normal approximation from median and sd
+    void
+    setDistribution(const size_distribution& dist);
+
+    template<class Archive>
+    void save(Archive& ar, const unsigned /* version */) const
+    {
+        ar << median << sd << distribution;
+    }
+
+    /// lookup tables are rebuilt from the distribution instead of being stored
+    template<class Archive>
+    void load(Archive& ar, const unsigned /* version */)
+    {
+        size_distribution dist;
+        ar >> median >> sd >> dist;
+        setDistribution(dist);
+    }
+
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
+
 
     ///
     /// remainder of interface for estimation, store/read from disk
@@ -53,11 +86,26 @@ struct PairStatSet
     {
         median = 0.;
         sd = 0.;
+        distribution.clear();
+        _pmf.clear();
+        _cdf.clear();
+        _quantile.clear();
     }
 
     /// TODO: hide implementation details, better estimate:
     double median;
     double sd;
+
+    /// the full empirical distribution which median and sd are estimated from
+    size_distribution distribution;
+
+private:
+    // lookup tables indexed by fragment size, built from distribution:
+    std::vector<float> _pmf;
+    std::vector<float> _cdf;
+
+    // quantile table, _quantile[i] is distribution.quantile(i/quantileTableSize):
+    std::vector<int> _quantile;
 };
 
 std::ostream&
@@ -72,17 +120,34 @@ struct ReadGroupStats
 {
 
     ReadGroupStats() {}
-    ReadGroupStats(const std::string& statsBamFile);
+    /// estimate stats from statsBamFile, optionally decompressing on decompressThreadCount threads
+    ///
+    /// if rgStats is not NULL and the file contains more than one @RG ID, rgStats is also filled
+    /// with stats for each read group estimated from the same sample of read pairs. Read groups
+    /// with too few sampled pairs are left out.
+    explicit
+    ReadGroupStats(const std::string& statsBamFile,
+                   const unsigned decompressThreadCount = 0,
+                   std::map<std::string,ReadGroupStats>* rgStats = NULL);
     ReadGroupStats(const std::vector<std::string>& data);
 
     void
     write(std::ostream& os) const;
 
+    template<class Archive>
+    void serialize(Archive& ar, const unsigned /* version */)
+    {
+        ar& relOrients& fragSize;
+    }
+
 private:
     // These data are used temporarily during ReadPairStats estimation
     struct PairStatsData
     {
-        std::vector<int32_t> fragmentLengths;
+        size_distribution fragmentLengths;
+
+        // fragment lengths of the same sample, split by read group:
+        std::map<std::string,size_distribution> rgFragmentLengths;
     };
 
     /// If PairStats has converged (or if isForcedConvergence is true)
@@ -18,6 +18,9 @@
 #include "blt_util/parse_util.hh"
 #include "blt_util/string_util.hh"
 
+#include "boost/archive/binary_iarchive.hpp"
+#include "boost/archive/binary_oarchive.hpp"
+
 #include <fstream>
 #include <iostream>
 
@@ -27,6 +30,7 @@
 const unsigned HEAD_FILL_IDX = 0;
 const unsigned HEAD_SRC_IDX  = 1;
 const unsigned HEAD_NAME_IDX = 2;
+const unsigned HEAD_RG_IDX   = 3;
 
 // Stats file data format
 const unsigned STAT_SOURCE_IDX             = 0;
@@ -45,11 +49,47 @@ read(const char* filename)
 
     std::ifstream ifs;
     open_ifstream(ifs,filename);
+
+    // the text format always starts with a header line:
+    if (ifs.peek() != '#')
+    {
+        ifs.close();
+        load(filename);
+        return;
+    }
     this->read(ifs);
 }
 
 
 
+void
+ReadGroupStatsSet::
+save(const char* filename) const
+{
+    using namespace boost::archive;
+
+    assert(NULL != filename);
+    std::ofstream ofs(filename, std::ios::binary);
+    binary_oarchive oa(ofs);
+    oa << *this;
+}
+
+
+
+void
+ReadGroupStatsSet::
+load(const char* filename)
+{
+    using namespace boost::archive;
+
+    assert(NULL != filename);
+    std::ifstream ifs(filename, std::ios::binary);
+    binary_iarchive ia(ifs);
+    ia >> *this;
+}
+
+
+
 void
 ReadGroupStatsSet::
 read(std::istream& is)
@@ -58,7 +98,7 @@ read(std::istream& is)
     using namespace illumina::blt_util;
 
     clear();
-    std::map<int,std::string> gmap;
+    std::map<int,ReadGroupLabel> gmap;
 
     std::string line;
     while (! is.eof())
@@ -77,7 +117,9 @@ read(std::istream& is)
 
         if (data[0] == "# Bam_Path")
         {
-            gmap[parse_int_str(data[HEAD_SRC_IDX])] = data[HEAD_NAME_IDX];
+            // the read group column is absent for per-file stats:
+            const std::string rg((data.size() > HEAD_RG_IDX) ? data[HEAD_RG_IDX] : "");
+            gmap[parse_int_str(data[HEAD_SRC_IDX])] = ReadGroupLabel(data[HEAD_NAME_IDX],rg);
             continue;
         }
         // Get key string
@@ -92,7 +134,8 @@ read(std::istream& is)
         }
 
         const ReadGroupStats rps(data);
-        setStats(gmap[key],rps);
+        const ReadGroupLabel& label(gmap[key]);
+        setStats(label.bamLabel,label.rgLabel,rps);
     }
 }
 
@@ -105,12 +148,16 @@ write(std::ostream& os) const
     const unsigned n_groups(_group.size());
     for (unsigned i(0); i<n_groups; ++i)
     {
-        os << "# Bam_Path\t" << i << "\t" << _group.get_key(i) << '\n';
+        const ReadGroupLabel& label(_group.get_key(i));
+        os << "# Bam_Path\t" << i << "\t" << label.bamLabel;
+        if (! label.rgLabel.empty()) os << "\t" << label.rgLabel;
+        os << '\n';
     }
     // write column header for better readability
     os << "#\tindex"
        << "\tsdInsSize\tmedianInsSize"
        << "\treadOrientation"
+       << "\tfragmentSizeDistribution"
        << '\n';
 
     for (unsigned i(0); i<n_groups; ++i)
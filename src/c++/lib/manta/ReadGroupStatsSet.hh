@@ -20,6 +20,45 @@
 #include <string>
 
 #include "boost/optional.hpp"
+#include "boost/serialization/split_member.hpp"
+#include "boost/serialization/string.hpp"
+
+
+
+/// identifies a read group as an alignment file and an optional @RG ID within that file
+///
+/// an empty rgLabel refers to all reads in the file
+///
+struct ReadGroupLabel
+{
+    explicit
+    ReadGroupLabel(
+        const std::string& initBamLabel = "",
+        const std::string& initRgLabel = "") :
+        bamLabel(initBamLabel),
+        rgLabel(initRgLabel)
+    {}
+
+    bool
+    operator<(const ReadGroupLabel& rhs) const
+    {
+        if (bamLabel < rhs.bamLabel) return true;
+        if (bamLabel == rhs.bamLabel)
+        {
+            return (rgLabel < rhs.rgLabel);
+        }
+        return false;
+    }
+
+    template<class Archive>
+    void serialize(Archive& ar, const unsigned /* version */)
+    {
+        ar& bamLabel& rgLabel;
+    }
+
+    std::string bamLabel;
+    std::string rgLabel;
+};
 
 
 
@@ -36,12 +75,28 @@ struct ReadGroupStatsSet
     /// if the group does not exist, the returned value
     /// evaluates to false per boost::optional
     ///
-    /// for now, a "read group" is fixed to the name of
-    /// each bam file
+    /// the default read group of each bam file covers all
+    /// reads in the file, groups for individual @RG IDs
+    /// are only present for files with several read groups
     boost::optional<unsigned>
-    getGroupIndex(const std::string& bam_file) const
+    getGroupIndex(const std::string& bam_file,
+                  const std::string& rg = "") const
+    {
+        return _group.get_optional_id(ReadGroupLabel(bam_file,rg));
+    }
+
+    /// total number of read groups over all bam files
+    unsigned
+    size() const
+    {
+        return _group.size();
+    }
+
+    /// get the label associated with index
+    const ReadGroupLabel&
+    getGroupLabel(const unsigned group_index) const
     {
-        return _group.get_optional_id(bam_file);
+        return _group.get_key(group_index);
     }
 
     /// get stats associated with index
@@ -56,7 +111,34 @@ struct ReadGroupStatsSet
     setStats(const std::string& bam_file,
              const ReadGroupStats& rps)
     {
-        _group.insert(bam_file,rps);
+        setStats(bam_file,"",rps);
+    }
+
+    /// set stats for read group rg in bam_file
+    void
+    setStats(const std::string& bam_file,
+             const std::string& rg,
+             const ReadGroupStats& rps)
+    {
+        _group.insert(ReadGroupLabel(bam_file,rg),rps);
+    }
+
+    /// merge all read groups from another set into this one
+    void
+    merge(const ReadGroupStatsSet& rhs)
+    {
+        const unsigned groupCount(rhs.size());
+        for (unsigned i(0); i<groupCount; ++i)
+        {
+            const ReadGroupLabel& label(rhs.getGroupLabel(i));
+            setStats(label.bamLabel,label.rgLabel,rhs.getStats(i));
+        }
+    }
+
+    void
+    clear()
+    {
+        _group.clear();
     }
 
     //
@@ -68,16 +150,47 @@ struct ReadGroupStatsSet
     void
     read(std::istream& os);
 
+    /// read stats in either the text format from write() or the binary format from save()
     void
     read(const char* filename);
 
-private:
+    /// write stats in a compact binary format
     void
-    clear()
+    save(const char* filename) const;
+
+    /// read the binary format from save()
+    void
+    load(const char* filename);
+
+    template<class Archive>
+    void save(Archive& ar, const unsigned /* version */) const
     {
-        _group.clear();
+        const unsigned groupCount(size());
+        ar << groupCount;
+        for (unsigned i(0); i<groupCount; ++i)
+        {
+            ar << getGroupLabel(i) << getStats(i);
+        }
     }
 
-    id_map<std::string, ReadGroupStats> _group;
-};
+    template<class Archive>
+    void load(Archive& ar, const unsigned /* version */)
+    {
+        clear();
+        unsigned groupCount(0);
+        ar >> groupCount;
+        for (unsigned i(0); i<groupCount; ++i)
+        {
+            ReadGroupLabel label;
+            ReadGroupStats rgs;
+            ar >> label >> rgs;
+            setStats(label.bamLabel,label.rgLabel,rgs);
+        }
+    }
+
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
 
+private:
+
+    id_map<ReadGroupLabel, ReadGroupStats> _group;
+};
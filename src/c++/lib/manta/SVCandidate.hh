@@ -190,7 +190,8 @@ struct SVCandidate
     {
         if (! isIntersect(rhs)) return false;
 
-        if (bp1.isIntersect(rhs.bp1))
+        // the direct breakend order is only used if both breakends intersect in that order:
+        if (bp1.isIntersect(rhs.bp1) && bp2.isIntersect(rhs.bp2))
         {
             bp1.merge(rhs.bp1);
             bp2.merge(rhs.bp2);
@@ -14,12 +14,17 @@
 ///
 /// \author Chris Saunders
 
+#include "blt_util/hash_util.hh"
 #include "blt_util/log.hh"
 #include "common/Exceptions.hh"
 #include "manta/SVCandidateData.hh"
 
+#include "boost/foreach.hpp"
+
 #include <cassert>
+#include <cstring>
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -28,7 +33,10 @@
 std::ostream&
 operator<<(std::ostream& os, const SVCandidateRead& svr)
 {
-    os << "SVCandidateRead: " << svr.bamrec << "\n";
+    os << "SVCandidateRead: " << svr.tid << ":" << svr.pos << " " << (svr.isFwdStrand ? '+' : '-')
+       << " mate: " << svr.mateTid << ":" << svr.matePos << " " << (svr.isMateFwdStrand ? '+' : '-')
+       << " readSize: " << svr.readSize << " refLength: " << svr.refLength
+       << " noninsertSize: " << svr.noninsertSize << " statsIndex: " << svr.statsIndex << "\n";
     return os;
 }
 
@@ -45,40 +53,88 @@ operator<<(std::ostream& os, const SVCandidateReadPair& svp)
 
 
 
-SVCandidateReadPair&
+unsigned
 SVCandidateDataGroup::
-getReadPair(const pindex_t::key_type& key)
+findSlot(
+    const char* qname,
+    const uint32_t hash) const
 {
-    const pindex_t::const_iterator kiter(_pairIndex.find(key));
+    assert(! _pairIndex.empty());
 
-    if (kiter == _pairIndex.end())
+    const unsigned mask(_pairIndex.size()-1);
+    unsigned slot(hash & mask);
+    while (true)
     {
-        _pairIndex[key] = _pairs.size();
-        _pairs.push_back(SVCandidateReadPair());
-        return _pairs.back();
+        const unsigned pairIndexPlusOne(_pairIndex[slot]);
+        if (0 == pairIndexPlusOne) return slot;
+
+        // the full name is only compared on a hash match:
+        const PairKey& key(_pairKeys[pairIndexPlusOne-1]);
+        if ((key.hash == hash) && (0 == strcmp(&(_qnames[key.qnameOffset]),qname))) return slot;
+        slot = (slot+1) & mask;
     }
-    else
+}
+
+
+
+void
+SVCandidateDataGroup::
+resizePairIndex(const unsigned tableSize)
+{
+    _pairIndex.assign(tableSize,0);
+
+    const unsigned mask(tableSize-1);
+    const unsigned pairCount(_pairKeys.size());
+    for (unsigned pairIndex(0); pairIndex<pairCount; ++pairIndex)
     {
-        return _pairs[kiter->second];
+        unsigned slot(_pairKeys[pairIndex].hash & mask);
+        while (0 != _pairIndex[slot]) slot = (slot+1) & mask;
+        _pairIndex[slot] = (pairIndex+1);
+        _pairKeys[pairIndex].slot = slot;
     }
 }
 
 
 
+SVCandidateReadPair&
+SVCandidateDataGroup::
+getReadPair(const char* qname)
+{
+    // keep the load factor at or below one half:
+    if ((_pairs.size()+1)*2 > _pairIndex.size())
+    {
+        resizePairIndex(std::max(64u,static_cast<unsigned>(_pairIndex.size()*2)));
+    }
+
+    const uint32_t hash(fnv1a_hash(qname));
+    const unsigned slot(findSlot(qname,hash));
+    if (0 != _pairIndex[slot]) return _pairs[_pairIndex[slot]-1];
+
+    _pairKeys.push_back(PairKey(hash,_qnames.size(),slot));
+    _qnames.insert(_qnames.end(),qname,qname+strlen(qname)+1);
+    _pairs.push_back(SVCandidateReadPair());
+    _pairIndex[slot] = _pairs.size();
+    return _pairs.back();
+}
+
+
+
 void
 SVCandidateDataGroup::
-add(const bam_record& bamRead)
+add(const char* qname,
+    const int readNo,
+    const SVCandidateRead& svRead)
 {
     using namespace illumina::common;
 
 #ifdef DEBUG_SVDATA
-    log_os << "SVDataGroup adding: " << bamRead << "\n";
+    log_os << "SVDataGroup adding: " << qname << "/" << readNo << " " << svRead << "\n";
 #endif
 
-    SVCandidateReadPair& pair(getReadPair(bamRead.qname()));
+    SVCandidateReadPair& pair(getReadPair(qname));
 
     SVCandidateRead* targetReadPtr(&(pair.read1));
-    if (2 == bamRead.read_no())
+    if (2 == readNo)
     {
         targetReadPtr = (&(pair.read2));
     }
@@ -87,8 +143,52 @@ add(const bam_record& bamRead)
         std::ostringstream oss;
         oss << "Unexpected read name collision.\n"
             << "\tExisting read: " << (*targetReadPtr) << "\n"
-            << "\tNew read: " << bamRead << "\n";
+            << "\tNew read: " << qname << "/" << readNo << " " << svRead << "\n";
         BOOST_THROW_EXCEPTION(LogicException(oss.str()));
     }
-    targetReadPtr->bamrec = bamRead;
+    *targetReadPtr = svRead;
+}
+
+
+
+void
+SVCandidateDataGroup::
+clear()
+{
+    // only reset the used slots, so that clearing a group after a small edge is cheap
+    // even when the table has grown to fit a much larger edge:
+    BOOST_FOREACH(const PairKey& key, _pairKeys)
+    {
+        _pairIndex[key.slot] = 0;
+    }
+
+    _pairs.clear();
+    _pairKeys.clear();
+    _qnames.clear();
+}
+
+
+
+bool
+SVCandidateData::
+getMaxDepth(
+    const GenomeInterval& interval,
+    unsigned& maxDepth) const
+{
+    for (unsigned regionIndex(0); regionIndex<_depthRegionCount; ++regionIndex)
+    {
+        const SVCandidateDepthRegion& region(_depthRegions[regionIndex]);
+        if (region.interval.tid != interval.tid) continue;
+        if (! region.interval.range.is_superset_of(interval.range)) continue;
+
+        const pos_t beginOffset(interval.range.begin_pos()-region.interval.range.begin_pos());
+        const pos_t endOffset(interval.range.end_pos()-region.interval.range.begin_pos());
+        maxDepth=0;
+        for (pos_t offset(beginOffset); offset<endOffset; ++offset)
+        {
+            maxDepth=std::max(maxDepth,region.depth[offset]);
+        }
+        return true;
+    }
+    return false;
 }
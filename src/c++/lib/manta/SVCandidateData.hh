@@ -17,24 +17,62 @@
 #pragma once
 
 #include "blt_util/bam_record.hh"
+#include "svgraph/GenomeInterval.hh"
 
+#include <stdint.h>
+
+#include <cassert>
 #include <iosfwd>
-#include <map>
 #include <vector>
 
 //#define DEBUG_SVDATA
 
 
+/// compact summary of a read, holding only the information required to translate the read
+/// (together with its mate when available) into a breakend pair
+///
+/// summaries are generated by SVLocusScanner so that the bam record itself does not need to
+/// be kept after the read is added to the candidate data
+///
 struct SVCandidateRead
 {
+    SVCandidateRead() :
+        tid(-1),
+        pos(0),
+        mateTid(-1),
+        matePos(0),
+        readSize(0),
+        refLength(0),
+        noninsertSize(0),
+        statsIndex(0),
+        isFwdStrand(true),
+        isMateFwdStrand(true)
+    {}
+
+    /// only reads with an alignment position are added to candidate data
     bool
     isSet() const
     {
-        return (! bamrec.empty());
+        return (tid >= 0);
     }
 
-    //realignment info, etc...
-    bam_record bamrec;
+    // read and mate alignment positions follow the one-indexed bam_record convention:
+    int32_t tid;
+    int32_t pos;
+    int32_t mateTid;
+    int32_t matePos;
+
+    unsigned readSize;
+    unsigned refLength;
+
+    /// size of the aligned portion of the read on the side facing its mate
+    unsigned noninsertSize;
+
+    /// index of the read group insert stats in SVLocusScanner
+    unsigned statsIndex;
+
+    bool isFwdStrand;
+    bool isMateFwdStrand;
 };
 
 std::ostream&
@@ -60,14 +98,25 @@ operator<<(std::ostream& os, const SVCandidateReadPair& svp);
 
 
 /// SVCandidateData associated with a specific bam-file/read-group
+///
+/// reads are paired by a hash of the read name. Read names are copied into a character
+/// arena owned by the group, and the pair index is a flat open-addressing table, so
+/// adding a read does not allocate once the group has grown to the size of a typical
+/// edge. clear() resets the group but keeps all storage for reuse on the next edge.
+///
 struct SVCandidateDataGroup
 {
     typedef std::vector<SVCandidateReadPair> pair_t;
     typedef pair_t::iterator iterator;
     typedef pair_t::const_iterator const_iterator;
 
+    /// add the read summary svRead to the pair sharing the read name qname
+    ///
+    /// \param readNo the read number (1 or 2) of the summarized read in its pair
     void
-    add(const bam_record& bamRead);
+    add(const char* qname,
+        const int readNo,
+        const SVCandidateRead& svRead);
 
     iterator
     begin()
@@ -93,16 +142,67 @@ struct SVCandidateDataGroup
         return _pairs.end();
     }
 
+    unsigned
+    size() const
+    {
+        return _pairs.size();
+    }
+
+    void
+    clear();
 
 private:
-    typedef std::string bamqname_t;
-    typedef std::map<bamqname_t,unsigned> pindex_t;
+
+    struct PairKey
+    {
+        PairKey(
+            const uint32_t initHash = 0,
+            const unsigned initQnameOffset = 0,
+            const unsigned initSlot = 0) :
+            hash(initHash),
+            qnameOffset(initQnameOffset),
+            slot(initSlot)
+        {}
+
+        uint32_t hash;
+
+        /// offset of the pair's read name in the arena
+        unsigned qnameOffset;
+
+        /// slot of the pair in the pair index table
+        unsigned slot;
+    };
+
+    /// find the pair index table slot for qname, which is either empty or refers to qname's pair
+    unsigned
+    findSlot(
+        const char* qname,
+        const uint32_t hash) const;
+
+    void
+    resizePairIndex(const unsigned tableSize);
 
     SVCandidateReadPair&
-    getReadPair(const pindex_t::key_type& key);
+    getReadPair(const char* qname);
 
     pair_t _pairs;
-    pindex_t _pairIndex;
+    std::vector<PairKey> _pairKeys;
+
+    // arena of null-terminated read names:
+    std::vector<char> _qnames;
+
+    // open-addressing table of (pair index + 1), zero for empty slots:
+    std::vector<unsigned> _pairIndex;
+};
+
+
+
+/// mapped read depth of the depth estimate alignment file at each position of a region
+///
+struct SVCandidateDepthRegion
+{
+    GenomeInterval interval;
+    std::vector<unsigned> depth;
 };
 
 
@@ -117,31 +217,56 @@ private:
 
 struct SVCandidateData
 {
+    SVCandidateData() :
+        _depthRegionCount(0)
+    {}
+
     SVCandidateDataGroup&
     getDataGroup(const unsigned bamIndex)
     {
-        data_t::iterator diter(_data.find(bamIndex));
-        if (diter != _data.end()) return diter->second;
-
-        std::pair<data_t::iterator,bool> diter2 = _data.insert(std::make_pair(bamIndex,SVCandidateDataGroup()));
-        return diter2.first->second;
+        if (bamIndex >= _data.size()) _data.resize(bamIndex+1);
+        return _data[bamIndex];
     }
 
     const SVCandidateDataGroup&
     getDataGroup(const unsigned bamIndex) const
     {
-        data_t::const_iterator diter(_data.find(bamIndex));
-        assert(diter != _data.end());
-        return diter->second;
+        assert(bamIndex < _data.size());
+        return _data[bamIndex];
     }
 
+    /// add a depth region, the region's storage may be reused from before the last clear()
+    SVCandidateDepthRegion&
+    addDepthRegion()
+    {
+        if (_depthRegionCount >= _depthRegions.size()) _depthRegions.resize(_depthRegionCount+1);
+        return _depthRegions[_depthRegionCount++];
+    }
+
+    /// get max depth over interval from a depth region covering all of interval
+    ///
+    /// \returns false if no depth region covers interval
+    bool
+    getMaxDepth(
+        const GenomeInterval& interval,
+        unsigned& maxDepth) const;
+
+    /// clear all data groups and depth regions, the storage of each is kept for reuse
     void
     clear()
     {
-        _data.clear();
+        const unsigned groupCount(_data.size());
+        for (unsigned groupIndex(0); groupIndex<groupCount; ++groupIndex)
+        {
+            _data[groupIndex].clear();
+        }
+        _depthRegionCount=0;
     }
 
 private:
-    typedef std::map<unsigned,SVCandidateDataGroup> data_t;
+    typedef std::vector<SVCandidateDataGroup> data_t;
     data_t _data;
+
+    std::vector<SVCandidateDepthRegion> _depthRegions;
+    unsigned _depthRegionCount;
 };
@@ -34,31 +34,29 @@ SVLocusScanner(
     // pull in insert stats:
     _rss.read(statsFilename.c_str());
 
-    // cache the insert stats we'll be looking up most often:
-    BOOST_FOREACH(const std::string& file, alignmentFilename)
+    // cache the insert stats we'll be looking up most often, the default stats for
+    // each alignment file are stored at the file's index:
+    const unsigned fileCount(alignmentFilename.size());
+    for (unsigned fileIndex(0); fileIndex<fileCount; ++fileIndex)
     {
-        const boost::optional<unsigned> index(_rss.getGroupIndex(file));
+        const boost::optional<unsigned> index(_rss.getGroupIndex(alignmentFilename[fileIndex]));
         assert(index);
-        const ReadGroupStats rgs(_rss.getStats(*index));
+        cacheReadGroupStats(_rss.getStats(*index));
+    }
 
-        _stats.resize(_stats.size()+1);
-        CachedReadGroupStats& stat(_stats.back());
-        {
-            Range& breakend(stat.breakendRegion);
-            breakend.min=rgs.fragSize.quantile(_opt.breakendEdgeTrimProb);
-            breakend.max=rgs.fragSize.quantile((1-_opt.breakendEdgeTrimProb));
+    // add stats for individual read groups, these are looked up from each read's RG tag:
+    _readGroupIndex.resize(fileCount);
+    const unsigned groupCount(_rss.size());
+    for (unsigned groupIndex(0); groupIndex<groupCount; ++groupIndex)
+    {
+        const ReadGroupLabel& label(_rss.getGroupLabel(groupIndex));
+        if (label.rgLabel.empty()) continue;
 
-            if (breakend.min<0.) breakend.min = 0;
-            assert(breakend.max>0.);
-        }
+        for (unsigned fileIndex(0); fileIndex<fileCount; ++fileIndex)
         {
-            Range& ppair(stat.properPair);
-            ppair.min=rgs.fragSize.quantile(_opt.properPairTrimProb);
-            ppair.max=rgs.fragSize.quantile((1-_opt.properPairTrimProb));
-
-            if (ppair.min<0.) ppair.min = 0;
-
-            assert(ppair.max>0.);
+            if (label.bamLabel != alignmentFilename[fileIndex]) continue;
+            _readGroupIndex[fileIndex].insert(label.rgLabel.c_str(),_stats.size());
+            cacheReadGroupStats(_rss.getStats(groupIndex));
         }
     }
 }
@@ -67,58 +65,110 @@ SVLocusScanner(
 
 void
 SVLocusScanner::
-getReadBreakendsImpl(
-    const CachedReadGroupStats& rstats,
-    const bam_record& localRead,
-    const bam_record* remoteReadPtr,
-    SVBreakend& localBreakend,
-    SVBreakend& remoteBreakend,
-    known_pos_range2& evidenceRange)
+cacheReadGroupStats(const ReadGroupStats& rgs)
 {
-    static const pos_t minPairBreakendSize(40);
+    _stats.resize(_stats.size()+1);
+    CachedReadGroupStats& stat(_stats.back());
+    stat.fragSize = rgs.fragSize;
+    {
+        Range& breakend(stat.breakendRegion);
+        breakend.min=stat.fragSize.quantile(_opt.breakendEdgeTrimProb);
+        breakend.max=stat.fragSize.quantile((1-_opt.breakendEdgeTrimProb));
 
-    ALIGNPATH::path_t apath;
-    bam_cigar_to_apath(localRead.raw_cigar(),localRead.n_cigar(),apath);
+        if (breakend.min<0.) breakend.min = 0;
+        assert(breakend.max>0.);
+    }
+    {
+        Range& ppair(stat.properPair);
+        ppair.min=stat.fragSize.quantile(_opt.properPairTrimProb);
+        ppair.max=stat.fragSize.quantile((1-_opt.properPairTrimProb));
 
-    const unsigned readSize(apath_read_length(apath));
-    const unsigned localRefLength(apath_ref_length(apath));
+        if (ppair.min<0.) ppair.min = 0;
 
-    unsigned thisReadNoninsertSize(0);
-    if (localRead.is_fwd_strand())
+        assert(ppair.max>0.);
+    }
+}
+
+
+
+unsigned
+SVLocusScanner::
+getStatsIndex(
+    const bam_record& bamRead,
+    const unsigned defaultReadGroupIndex) const
+{
+    // skip the tag lookup for files without per read group stats:
+    const string_index_map& rgIndex(_readGroupIndex[defaultReadGroupIndex]);
+    if (rgIndex.empty()) return defaultReadGroupIndex;
+
+    static const char rgTag[] = {'R','G'};
+    const char* rg(bamRead.get_string_tag(rgTag));
+    if (NULL == rg) return defaultReadGroupIndex;
+
+    unsigned statsIndex(0);
+    if (! rgIndex.find(rg,statsIndex)) return defaultReadGroupIndex;
+    return statsIndex;
+}
+
+
+
+/// summarize everything but the read group stats index of bamRead
+static
+void
+setCandidateRead(
+    const bam_record& bamRead,
+    SVCandidateRead& svRead)
+{
+    ALIGNPATH::path_t apath;
+    bam_cigar_to_apath(bamRead.raw_cigar(),bamRead.n_cigar(),apath);
+
+    svRead.tid = bamRead.target_id();
+    svRead.pos = bamRead.pos();
+    svRead.mateTid = bamRead.mate_target_id();
+    svRead.matePos = bamRead.mate_pos();
+    svRead.isFwdStrand = bamRead.is_fwd_strand();
+    svRead.isMateFwdStrand = bamRead.is_mate_fwd_strand();
+
+    svRead.readSize = apath_read_length(apath);
+    svRead.refLength = apath_ref_length(apath);
+    if (svRead.isFwdStrand)
     {
-        thisReadNoninsertSize=(readSize-apath_read_trail_size(apath));
+        svRead.noninsertSize=(svRead.readSize-apath_read_trail_size(apath));
     }
     else
     {
-        thisReadNoninsertSize=(readSize-apath_read_lead_size(apath));
+        svRead.noninsertSize=(svRead.readSize-apath_read_lead_size(apath));
     }
+}
+
+
+
+void
+SVLocusScanner::
+getReadBreakendsImpl(
+    const CachedReadGroupStats& rstats,
+    const SVCandidateRead& localRead,
+    const SVCandidateRead* remoteReadPtr,
+    SVBreakend& localBreakend,
+    SVBreakend& remoteBreakend,
+    known_pos_range2& evidenceRange)
+{
+    static const pos_t minPairBreakendSize(40);
 
     localBreakend.readCount = 1;
 
     // if remoteRead is not available, estimate mate localRead size to be same as local,
     // and assume no clipping on mate localRead:
-    unsigned remoteReadNoninsertSize(readSize);
-    unsigned remoteRefLength(localRefLength);
+    unsigned remoteReadNoninsertSize(localRead.readSize);
+    unsigned remoteRefLength(localRead.refLength);
 
     if (NULL != remoteReadPtr)
     {
         // if remoteRead is available, we can more accurately determine the size:
-        const bam_record& remoteRead(*remoteReadPtr);
-
-        ALIGNPATH::path_t remoteApath;
-        bam_cigar_to_apath(remoteRead.raw_cigar(),remoteRead.n_cigar(),remoteApath);
+        const SVCandidateRead& remoteRead(*remoteReadPtr);
 
-        const unsigned remoteReadSize(apath_read_length(remoteApath));
-        remoteRefLength = (apath_ref_length(remoteApath));
-
-        if (remoteRead.is_fwd_strand())
-        {
-            remoteReadNoninsertSize=(remoteReadSize-apath_read_trail_size(remoteApath));
-        }
-        else
-        {
-            remoteReadNoninsertSize=(remoteReadSize-apath_read_lead_size(remoteApath));
-        }
+        remoteRefLength = remoteRead.refLength;
+        remoteReadNoninsertSize = remoteRead.noninsertSize;
 
         remoteBreakend.readCount = 1;
 
@@ -127,16 +177,16 @@ getReadBreakendsImpl(
 
     }
 
-    const pos_t totalNoninsertSize(thisReadNoninsertSize+remoteReadNoninsertSize);
+    const pos_t totalNoninsertSize(localRead.noninsertSize+remoteReadNoninsertSize);
     const pos_t breakendSize(std::max(minPairBreakendSize,static_cast<pos_t>(rstats.breakendRegion.max-totalNoninsertSize)));
 
     {
-        localBreakend.interval.tid = (localRead.target_id());
+        localBreakend.interval.tid = (localRead.tid);
 
-        const pos_t startRefPos(localRead.pos()-1);
-        const pos_t endRefPos(startRefPos+localRefLength);
+        const pos_t startRefPos(localRead.pos-1);
+        const pos_t endRefPos(startRefPos+localRead.refLength);
         // expected breakpoint range is from the end of the localRead alignment to the (probabilistic) end of the fragment:
-        if (localRead.is_fwd_strand())
+        if (localRead.isFwdStrand)
         {
             localBreakend.state = SVBreakendState::RIGHT_OPEN;
             localBreakend.interval.range.set_begin_pos(endRefPos);
@@ -154,11 +204,11 @@ getReadBreakendsImpl(
 
     // get remote breakend estimate:
     {
-        remoteBreakend.interval.tid = (localRead.mate_target_id());
+        remoteBreakend.interval.tid = (localRead.mateTid);
 
-        const pos_t startRefPos(localRead.mate_pos()-1);
+        const pos_t startRefPos(localRead.matePos-1);
         pos_t endRefPos(startRefPos+remoteRefLength);
-        if (localRead.is_mate_fwd_strand())
+        if (localRead.isMateFwdStrand)
         {
             remoteBreakend.state = SVBreakendState::RIGHT_OPEN;
             remoteBreakend.interval.range.set_begin_pos(endRefPos);
@@ -187,7 +237,9 @@ getSVLocusImpl(
     SVBreakend localBreakend;
     SVBreakend remoteBreakend;
     known_pos_range2 evidenceRange;
-    getReadBreakendsImpl(rstats, bamRead, NULL, localBreakend, remoteBreakend, evidenceRange);
+    SVCandidateRead localRead;
+    setCandidateRead(bamRead,localRead);
+    getReadBreakendsImpl(rstats, localRead, NULL, localBreakend, remoteBreakend, evidenceRange);
 
     if ((0==localBreakend.interval.range.size()) ||
         (0==remoteBreakend.interval.range.size()))
@@ -240,7 +292,7 @@ isProperPair(
     if (bamRead.is_unmapped() || bamRead.is_mate_unmapped()) return false;
     if (bamRead.target_id() != bamRead.mate_target_id()) return false;
 
-    const Range& ppr(_stats[defaultReadGroupIndex].properPair);
+    const Range& ppr(getCachedStats(bamRead,defaultReadGroupIndex).properPair);
     const int32_t fragmentSize(std::abs(bamRead.template_size()));
     if (fragmentSize > ppr.max || fragmentSize < ppr.min) return false;
 
@@ -275,7 +327,7 @@ getChimericSVLocus(
 
     if (bamRead.is_chimeric())
     {
-        const CachedReadGroupStats& rstats(_stats[defaultReadGroupIndex]);
+        const CachedReadGroupStats& rstats(getCachedStats(bamRead,defaultReadGroupIndex));
         getSVLocusImpl(rstats,bamRead,locus);
     }
 }
@@ -296,7 +348,7 @@ getSVLocus(
         if (std::abs(bamRead.template_size())<2000) return;
     }
 
-    const CachedReadGroupStats& rstats(_stats[defaultReadGroupIndex]);
+    const CachedReadGroupStats& rstats(getCachedStats(bamRead,defaultReadGroupIndex));
     getSVLocusImpl(rstats,bamRead,locus);
 }
 
@@ -304,14 +356,25 @@ getSVLocus(
 
 void
 SVLocusScanner::
-getBreakendPair(
-    const bam_record& localRead,
-    const bam_record* remoteReadPtr,
+getCandidateRead(
+    const bam_record& bamRead,
     const unsigned defaultReadGroupIndex,
+    SVCandidateRead& svRead) const
+{
+    setCandidateRead(bamRead,svRead);
+    svRead.statsIndex = getStatsIndex(bamRead,defaultReadGroupIndex);
+}
+
+
+
+void
+SVLocusScanner::
+getBreakendPair(
+    const SVCandidateRead& localRead,
+    const SVCandidateRead* remoteReadPtr,
     SVBreakend& localBreakend,
     SVBreakend& remoteBreakend) const
 {
-    const CachedReadGroupStats& rstats(_stats[defaultReadGroupIndex]);
     known_pos_range2 evidenceRange;
-    getReadBreakendsImpl(rstats, localRead, remoteReadPtr, localBreakend, remoteBreakend, evidenceRange);
+    getReadBreakendsImpl(_stats[localRead.statsIndex], localRead, remoteReadPtr, localBreakend, remoteBreakend, evidenceRange);
 }
@@ -18,8 +18,10 @@
 #pragma once
 
 #include "blt_util/bam_record.hh"
+#include "blt_util/string_index_map.hh"
 #include "manta/ReadGroupStatsSet.hh"
 #include "manta/SVCandidate.hh"
+#include "manta/SVCandidateData.hh"
 #include "svgraph/SVLocus.hh"
 #include "options/ReadScannerOptions.hh"
 
@@ -57,7 +59,7 @@ struct SVLocusScanner
     /// else return an empty object.
     ///
     /// \param defaultReadGroupIndex the read group index to use by in the absence of an RG tag
-    /// (for now RGs are ignored for the purpose of gathering insert stats)
+    /// (or when no stats are available for the read's RG)
     ///
     void
     getChimericSVLocus(
@@ -74,18 +76,37 @@ struct SVLocusScanner
         const unsigned defaultReadGroupIndex,
         SVLocus& locus) const;
 
-    /// get local and remote breakends from read pair
+    /// summarize the information from bamRead required to find its breakends
+    ///
+    /// \param defaultReadGroupIndex the read group index to use by in the absence of an RG tag
+    /// (or when no stats are available for the read's RG)
+    ///
+    void
+    getCandidateRead(
+        const bam_record& bamRead,
+        const unsigned defaultReadGroupIndex,
+        SVCandidateRead& svRead) const;
+
+    /// get local and remote breakends from read pair summaries
     ///
     /// if remote read is not available, set to NULL and best estimate will be generated
     ///
     void
     getBreakendPair(
-        const bam_record& localRead,
-        const bam_record* remoteReadPtr,
-        const unsigned defaultReadGroupIndex,
+        const SVCandidateRead& localRead,
+        const SVCandidateRead* remoteReadPtr,
         SVBreakend& localBreakend,
         SVBreakend& remoteBreakend) const;
 
+    /// fragment size distribution for the given read group stats index
+    ///
+    /// lookups into the returned distribution are O(1) for quantile, cdf and pdf
+    const PairStatSet&
+    getFragSizeStats(const unsigned statsIndex) const
+    {
+        return _stats[statsIndex].fragSize;
+    }
+
 private:
 
     struct Range
@@ -103,15 +124,34 @@ private:
     {
         Range breakendRegion;
         Range properPair;
+        PairStatSet fragSize;
     };
 
 
+    /// add insert stats of one read group to the end of the stats cache
+    void
+    cacheReadGroupStats(const ReadGroupStats& rgs);
+
+    /// get the stats index for bamRead's read group, or the index of the default stats of its alignment file
+    unsigned
+    getStatsIndex(
+        const bam_record& bamRead,
+        const unsigned defaultReadGroupIndex) const;
+
+    const CachedReadGroupStats&
+    getCachedStats(
+        const bam_record& bamRead,
+        const unsigned defaultReadGroupIndex) const
+    {
+        return _stats[getStatsIndex(bamRead,defaultReadGroupIndex)];
+    }
+
     static
     void
     getReadBreakendsImpl(
         const CachedReadGroupStats& rstats,
-        const bam_record& localRead,
-        const bam_record* remoteReadPtr,
+        const SVCandidateRead& localRead,
+        const SVCandidateRead* remoteReadPtr,
         SVBreakend& localBreakend,
         SVBreakend& remoteBreakend,
         known_pos_range2& evidenceRange);
@@ -129,5 +169,8 @@ private:
     ReadGroupStatsSet _rss;
 
     std::vector<CachedReadGroupStats> _stats;
+
+    // for each alignment file, the _stats index of each read group with its own stats:
+    std::vector<string_index_map> _readGroupIndex;
 };
 
@@ -119,6 +119,20 @@ struct SVLocusSet : public observer<SVLocusNodeMoveMessage>
         _totalNonAnom += count;
     }
 
+    /// total anomolous reads used to construct the graph
+    unsigned long
+    totalAnomCount() const
+    {
+        return _totalAnom;
+    }
+
+    /// total non-anomolous reads used to construct the graph
+    unsigned long
+    totalNonAnomCount() const
+    {
+        return _totalNonAnom;
+    }
+
     void
     clear()
     {
@@ -94,6 +94,7 @@ macro(static_find_boost boost_version boost_components)
     set      (HAVE_LIBBOOST_REGEX           ${Boost_REGEX_FOUND})
     set      (HAVE_LIBBOOST_SERIALIZATION   ${Boost_SERIALIZATION_FOUND})
     set      (HAVE_LIBBOOST_SYSTEM          ${Boost_SYSTEM_FOUND})
+    set      (HAVE_LIBBOOST_THREAD          ${Boost_THREAD_FOUND})
 endmacro()
 
 
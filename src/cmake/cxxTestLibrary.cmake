@@ -33,8 +33,9 @@ add_dependencies(${TEST_TARGET} MANTA_OPT)
 
 set(ADDITIONAL_UNITTEST_LIB ${ADDITIONAL_UNITTEST_LIB} manta_${MANTA_LIB_DIR})
 
+set(BAM_LIBRARY "${SAMTOOLS_DIR}/libbam.a")
 target_link_libraries (${TEST_TARGET} ${ADDITIONAL_UNITTEST_LIB} ${MANTA_AVAILABLE_LIBRARIES}
-                      ${Boost_LIBRARIES} ${MANTA_ADDITIONAL_LIB})
+                      ${BAM_LIBRARY} ${Boost_LIBRARIES} ${MANTA_ADDITIONAL_LIB})
 
 set(TEST_BINARY ${CMAKE_CURRENT_BINARY_DIR}/${TEST_TARGET})
 
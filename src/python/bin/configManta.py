@@ -65,6 +65,14 @@ You must specify a BAM file for at least one sample.
     def addExtendedGroupOptions(self,group) :
         group.add_option("--referenceFasta",type="string",dest="referenceFasta",metavar="FILE",
                          help="samtools-indexed reference fasta file [required] (default: %default)")
+        group.add_option("--statsCacheDir",type="string",dest="statsCacheDir",metavar="DIR",
+                         help="Reuse alignment statistics computed by previous runs on the same BAM files, which are stored in this directory. [optional] (no default)")
+        group.add_option("--edgeRuntimeFile",type="string",dest="edgeRuntimeFile",metavar="FILE",
+                         help="Balance SV candidate generation work using the edge runtimes written by a previous run on the same data (results/stats/svCandidateGenerationEdgeRuntime.tsv). [optional] (no default)")
+        group.add_option("--fixedSegments", dest="isAdaptiveSegments", action="store_false",
+                         help="Split the genome into fixed size segments of binSize, instead of segments balanced by sampled read density.")
+        group.add_option("--depthIndex", dest="isDepthIndex", action="store_true",
+                         help="Read somatic breakend depth from a binned depth index built during graph construction, instead of counting it exactly during candidate generation. The index depth is the max over 100 base bins, so it can exceed the exact breakend depth.")
         MantaWorkflowOptionsBase.addExtendedGroupOptions(self,group)
 
 
@@ -76,7 +84,22 @@ You must specify a BAM file for at least one sample.
             'runDir' : 'MantaWorkflow',
             'isExome' : False,
             'binSize' : 25000000,
-            'nonlocalWorkBins' : 128
+            'isAdaptiveSegments' : True,
+            'isDepthIndex' : False,
+            'minSegmentSize' : 1000000,
+            'maxSegmentSize' : 100000000,
+            'segmentSampleCount' : 64,
+            'segmentSampleBlockWindows' : 64,
+            'segmentSampleSize' : 100000,
+            'graphThrottleDepthFactor' : 10,
+            'statsMaxThreads' : 8,
+            'statsCacheDir' : None,
+            'edgeRuntimeFile' : None,
+            'nonlocalWorkBins' : 128,
+            'hygenMaxThreads' : 8,
+            'hygenEdgeBatchSize' : 32,
+            'hygenReadCacheMegabytes' : 64,
+            'hygenChunkCount' : 512
                           })
         return defaults
 
@@ -101,6 +124,12 @@ You must specify a BAM file for at least one sample.
 
         options.referenceFasta=validateFixExistingFileArg(options.referenceFasta,"reference")
 
+        if options.statsCacheDir is not None :
+            options.statsCacheDir=os.path.abspath(options.statsCacheDir)
+
+        if options.edgeRuntimeFile is not None :
+            options.edgeRuntimeFile=validateFixExistingFileArg(options.edgeRuntimeFile,"edge runtime file")
+
 
         # check for reference fasta index file:
         if options.referenceFasta is not None :
@@ -0,0 +1,266 @@
+#
+# Manta
+# Copyright (c) 2013 Illumina, Inc.
+#
+# This software is provided under the terms and conditions of the
+# Illumina Open Source Software License 1.
+#
+# You should have received a copy of the Illumina Open Source
+# Software License 1 along with this program. If not, see
+# <https://github.com/downloads/sequencing/licenses/>.
+#
+
+"""
+This module contains functions to partition the genome into segments of
+approximately equal processing cost, using the read density recorded
+in the BAM index.
+"""
+
+__author__ = "Chris Saunders"
+
+
+import os
+import struct
+
+from checkChromSet import getBamChromInfo
+
+
+# size of each BAM linear index window in bases:
+baiWindowSize=16384
+
+
+
+def readBaiChromOffsets(baiFile) :
+    """
+    read the linear index of a samtools BAM index file
+
+    returns a list with one entry per BAM reference sequence. Each
+    entry is the list of compressed file offsets for each 16kb window
+    of the reference.
+    """
+
+    def readInt(fp,fmt) :
+        size=struct.calcsize(fmt)
+        data=fp.read(size)
+        if len(data) != size :
+            raise Exception("Unexpected end of BAM index file: '%s'" % (baiFile))
+        return struct.unpack(fmt,data)[0]
+
+    chromOffsets=[]
+    fp=open(baiFile,"rb")
+    try :
+        if fp.read(4) != "BAI\1" :
+            raise Exception("Unexpected BAM index format for file: '%s'" % (baiFile))
+
+        nRef=readInt(fp,"<i")
+        for _ in xrange(nRef) :
+            # skip the binning index, only the linear index is needed here:
+            nBin=readInt(fp,"<i")
+            for _ in xrange(nBin) :
+                readInt(fp,"<I")
+                nChunk=readInt(fp,"<i")
+                fp.seek(nChunk*16,os.SEEK_CUR)
+
+            nIntv=readInt(fp,"<i")
+            data=fp.read(nIntv*8)
+            if len(data) != (nIntv*8) :
+                raise Exception("Unexpected end of BAM index file: '%s'" % (baiFile))
+
+            # convert virtual offsets to compressed file offsets:
+            chromOffsets.append([ (x >> 16) for x in struct.unpack("<%iQ" % (nIntv),data) ])
+    finally :
+        fp.close()
+
+    return chromOffsets
+
+
+
+def getBamWindowCost(samtoolsBin,bamFile,chromOrder,chromSizes) :
+    """
+    approximate the read density of bamFile in each BAM index window
+    as the compressed BAM bytes between consecutive linear index offsets
+
+    returns a hash of chrom -> list of window costs
+    """
+
+    baiFile=bamFile+".bai"
+    chromInfo=getBamChromInfo(samtoolsBin,bamFile)
+    chromOffsets=readBaiChromOffsets(baiFile)
+
+    bamChroms=sorted(chromInfo.keys(),key=lambda x:chromInfo[x][1])
+    assert len(bamChroms) == len(chromOffsets)
+
+    # the end of each chromosome's data is the start of the next chromosome with data:
+    chromEnd=[0]*len(bamChroms)
+    nextStart=os.path.getsize(bamFile)
+    for chromIndex in reversed(xrange(len(bamChroms))) :
+        chromEnd[chromIndex]=nextStart
+        for offset in chromOffsets[chromIndex] :
+            if offset == 0 : continue
+            nextStart=offset
+            break
+
+    windowCost={}
+    for chrom in chromOrder :
+        windowCount=1+((chromSizes[chrom]-1)/baiWindowSize)
+        cost=[0]*windowCount
+        windowCost[chrom]=cost
+        if chrom not in chromInfo : continue
+        chromIndex=chromInfo[chrom][1]
+        offsets=chromOffsets[chromIndex]
+
+        # empty windows are recorded as zero before the first read, and as the
+        # offset of the previous window after it:
+        lastOffset=None
+        lastWindow=None
+        for (window,offset) in enumerate(offsets[:windowCount]) :
+            if offset == 0 : continue
+            if lastOffset is not None :
+                cost[lastWindow]=max(0,offset-lastOffset)
+            lastOffset=offset
+            lastWindow=window
+
+        if lastOffset is not None :
+            cost[lastWindow]=max(0,chromEnd[chromIndex]-lastOffset)
+
+    return windowCost
+
+
+
+def getSampleAnomalousFraction(samtoolsBin,bamFile,region) :
+    """
+    count reads in region which are paired but not in a proper pair,
+    and return this count as a fraction of all mapped reads
+    """
+
+    import subprocess
+
+    def getCount(flagArgs) :
+        cmd="%s view -c %s %s %s" % (samtoolsBin,flagArgs,bamFile,region)
+        proc=subprocess.Popen(cmd,shell=True,stdout=subprocess.PIPE)
+        count=int(proc.stdout.read().strip())
+        proc.wait()
+        if proc.returncode != 0 :
+            raise Exception("Failed to run command: '%s'" % (cmd))
+        return count
+
+    totalCount=getCount("-F 0x604")
+    if totalCount == 0 : return 0.
+    anomCount=getCount("-f 0x1 -F 0x606")
+    return float(anomCount)/float(totalCount)
+
+
+
+def refineWindowCostBySampling(samtoolsBin,bamList,chromOrder,windowCost,blockWindows,maxSampleCount,sampleSize) :
+    """
+    The compressed byte density misses the extra work generated by regions
+    rich in anomalous read pairs (such as satellite repeats), which drive most
+    of the SV locus graph construction time.
+
+    To account for this, sample the highest density blocks of blockWindows index windows, and
+    scale each sampled block cost by the ratio of its anomalous read fraction to the
+    median sampled fraction.
+    """
+
+    if maxSampleCount <= 0 : return
+
+    blocks=[]
+    for chrom in chromOrder :
+        cost=windowCost[chrom]
+        for blockStart in xrange(0,len(cost),blockWindows) :
+            blockEnd=min(blockStart+blockWindows,len(cost))
+            blocks.append((sum(cost[blockStart:blockEnd]),chrom,blockStart,blockEnd))
+
+    blocks=[ x for x in blocks if x[0] > 0 ]
+    if len(blocks) == 0 : return
+
+    blocks.sort(reverse=True)
+    sampleBlocks=blocks[:maxSampleCount]
+
+    blockFrac=[]
+    for (_,chrom,blockStart,blockEnd) in sampleBlocks :
+        # sample from the center of the block:
+        center=((blockStart+blockEnd)*baiWindowSize)/2
+        region="%s:%i-%i" % (chrom,max(1,center-sampleSize/2),center+sampleSize/2)
+        frac=0.
+        for bamFile in bamList :
+            frac=max(frac,getSampleAnomalousFraction(samtoolsBin,bamFile,region))
+        blockFrac.append(frac)
+
+    medianFrac=sorted(blockFrac)[len(blockFrac)/2]
+    if medianFrac <= 0. : return
+
+    for ((_,chrom,blockStart,blockEnd),frac) in zip(sampleBlocks,blockFrac) :
+        scale=frac/medianFrac
+        if scale <= 1. : continue
+        cost=windowCost[chrom]
+        for window in xrange(blockStart,blockEnd) :
+            cost[window] = int(cost[window]*scale)
+
+
+
+def getCostBalancedChromIntervals(chromOrder,chromSizes,windowCost,segmentSize,minSegmentSize,maxSegmentSize) :
+    """
+    generate chromosome intervals with approximately equal total cost
+
+    The total number of intervals is set to match the number of fixed size segments
+    of segmentSize, so that overall task granularity is unchanged. Intervals are constrained
+    to minSegmentSize and maxSegmentSize, and are aligned to BAM index windows.
+
+    return chrom,start,end,chromSegment
+    in the same format as workflowUtil.getChromIntervals
+    """
+
+    assert minSegmentSize <= maxSegmentSize
+
+    def getWindowCount(size) :
+        return 1+((size-1)/baiWindowSize)
+
+    segmentCount=0
+    totalCost=0
+    for chrom in chromOrder :
+        segmentCount += 1+((chromSizes[chrom]-1)/segmentSize)
+        totalCost += sum(windowCost[chrom])
+
+    # each window is given a nominal cost so that empty regions are not entirely free:
+    windowFloor=max(1,totalCost/(100*sum([getWindowCount(chromSizes[x]) for x in chromOrder])))
+    totalCost=0
+    for chrom in chromOrder :
+        totalCost += sum(windowCost[chrom])+(windowFloor*len(windowCost[chrom]))
+
+    targetCost=float(totalCost)/float(segmentCount)
+
+    for chrom in chromOrder :
+        chromSize=chromSizes[chrom]
+        cost=[ (x+windowFloor) for x in windowCost[chrom] ]
+        chromCost=sum(cost)
+
+        minCount=1+((chromSize-1)/maxSegmentSize)
+        maxCount=max(minCount,chromSize/minSegmentSize)
+        chromSegments=min(maxCount,max(minCount,int(round(chromCost/targetCost))))
+
+        # find window boundaries which split the chromosome cost evenly:
+        ends=[]
+        segmentCost=float(chromCost)/float(chromSegments)
+        cumCost=0
+        for (window,wcost) in enumerate(cost) :
+            cumCost += wcost
+            if len(ends)+1 >= chromSegments : break
+            if cumCost >= (len(ends)+1)*segmentCost :
+                ends.append(min(chromSize,(window+1)*baiWindowSize))
+        ends.append(chromSize)
+
+        # enforce segment size limits:
+        start=1
+        segIndex=0
+        for end in ends :
+            if end < start : continue
+            if (end-start+1) < minSegmentSize and end != chromSize : continue
+            nSplit=1+((end-start)/maxSegmentSize)
+            splitSize=((end-start)+nSplit)/nSplit
+            for _ in xrange(nSplit) :
+                if start > end : break
+                splitEnd=min(end,start+splitSize-1)
+                yield (chrom,start,splitEnd,segIndex)
+                segIndex += 1
+                start=splitEnd+1
@@ -68,11 +68,11 @@ class MantaWorkflowOptionsBase(ConfigureWorkflowOptions) :
         assert os.path.isfile(mantaHyGenBin)
         mantaGraphStatsBin=os.path.join(libexecDir,"SummarizeSVLoci")
         assert os.path.isfile(mantaGraphStatsBin)
+        mantaMergeVcfBin=os.path.join(libexecDir,"MergeSortedVcf")
+        assert os.path.isfile(mantaMergeVcfBin)
 
         mantaChromDepth=os.path.join(libexecDir,"getBamAvgChromDepth.py")
         assert os.path.isfile(mantaChromDepth)
-        mantaSortVcf=os.path.join(libexecDir,"sortVcf.py")
-        assert os.path.isfile(mantaSortVcf)
 
         return cleanLocals(locals())
 
@@ -33,6 +33,8 @@ from workflowUtil import checkFile, ensureDir, preJoin, which, \
                          getChromIntervals, getFastaChromOrderSize
 
 from configureUtil import getIniSections,dumpIniSections
+from genomeSegmentUtil import getBamWindowCost, refineWindowCostBySampling, \
+                              getCostBalancedChromIntervals
 
 
 
@@ -70,12 +72,51 @@ class GenomeSegment(object) :
 
 
 
+def planGenomeSegments(self) :
+    """
+    partition the genome into segments of approximately equal graph construction cost
+
+    segment cost is estimated from the read density in the BAM indices, optionally refined
+    by sampling the anomalous read fraction from the densest regions. The resulting
+    segment list is stored in params.genomeSegments
+    """
+
+    bamList = self.params.normalBamList + self.params.tumorBamList
+
+    windowCost = None
+    for bamPath in bamList :
+        bamCost = getBamWindowCost(self.params.samtoolsBin, bamPath, self.params.chromOrder, self.params.chromSizes)
+        if windowCost is None :
+            windowCost = bamCost
+            continue
+        for chrom in self.params.chromOrder :
+            windowCost[chrom] = [ (x+y) for (x,y) in zip(windowCost[chrom],bamCost[chrom]) ]
+
+    refineWindowCostBySampling(self.params.samtoolsBin, bamList, self.params.chromOrder, windowCost,
+                               self.params.segmentSampleBlockWindows, self.params.segmentSampleCount,
+                               self.params.segmentSampleSize)
+
+    self.params.genomeSegments = list(getCostBalancedChromIntervals(self.params.chromOrder, self.params.chromSizes, windowCost,
+                                                                    self.params.binSize, self.params.minSegmentSize,
+                                                                    self.params.maxSegmentSize))
+
+    self.flowLog("Partitioned genome into %i cost-balanced segments" % (len(self.params.genomeSegments)))
+
+
+
 def getNextGenomeSegment(params) :
     """
     generator which iterates through all genomic segments and
     returns a segmentValues object for each one.
+
+    If a cost-balanced segment plan has been computed it is used,
+    otherwise the genome is split into segments of fixed size.
     """
-    for (chrom,beginPos,endPos,binId) in getChromIntervals(params.chromOrder,params.chromSizes,params.binSize) :
+    segments = params.genomeSegments
+    if segments is None :
+        segments = getChromIntervals(params.chromOrder,params.chromSizes,params.binSize)
+
+    for (chrom,beginPos,endPos,binId) in segments :
         yield GenomeSegment(chrom,beginPos,endPos,binId)
 
 
@@ -84,15 +125,23 @@ def runStats(self,taskPrefix="",dependencies=None):
 
     statsPath=self.paths.getStatsPath()
 
+    # each alignment file is processed on a separate thread:
+    bamCount = len(self.params.normalBamList) + len(self.params.tumorBamList)
+    statsCores = self.limitNCores(max(1,min(bamCount,self.params.statsMaxThreads)))
+
     cmd = [ self.params.mantaStatsBin ]
     cmd.extend(["--output-file",statsPath])
+    cmd.extend(["--output-binary-file",self.paths.getStatsBinaryPath()])
+    cmd.extend(["--threads",str(statsCores)])
+    if self.params.statsCacheDir is not None :
+        cmd.extend(["--cache-dir",self.params.statsCacheDir])
     for bamPath in self.params.normalBamList :
         cmd.extend(["--align-file",bamPath])
     for bamPath in self.params.tumorBamList :
         cmd.extend(["--tumor-align-file",bamPath])
 
     nextStepWait = set()
-    nextStepWait.add(self.addTask(preJoin(taskPrefix,"generateStats"),cmd,dependencies=dependencies))
+    nextStepWait.add(self.addTask(preJoin(taskPrefix,"generateStats"),cmd,dependencies=dependencies,nCores=statsCores))
 
     return nextStepWait
 
@@ -123,12 +172,26 @@ def runDepth(self,taskPrefix="",dependencies=None) :
 
 
 
+def isSomaticRun(params) :
+    return (len(params.normalBamList) > 0) and (len(params.tumorBamList) > 0)
+
+
+
+def isBreakendDepthIndex(params) :
+    """
+    breakend depth is read from the binned depth index of the normal sample only on request,
+    by default hygen collects the exact breakend depth while reading the evidence regions
+    """
+    return isSomaticRun(params) and params.isDepthIndex
+
+
+
 def runLocusGraph(self,taskPrefix="",dependencies=None):
     """
     Create the full SV locus graph
     """
 
-    statsPath=self.paths.getStatsPath()
+    statsPath=self.paths.getStatsBinaryPath()
     graphPath=self.paths.getGraphPath()
     graphStatsPath=self.paths.getGraphStatsPath()
 
@@ -137,8 +200,13 @@ def runLocusGraph(self,taskPrefix="",dependencies=None):
     dirTask=self.addTask(preJoin(taskPrefix,"makeTmpDir"), "mkdir -p "+tmpGraphDir, dependencies=dependencies, isForceLocal=True)
 
     tmpGraphFiles = []
+    tmpThrottledFiles = []
+    tmpDepthIndexFiles = []
     graphTasks = set()
 
+    # the binned depth of the normal sample is only used for somatic scoring:
+    isDepthIndex = isBreakendDepthIndex(self.params)
+
     for gseg in getNextGenomeSegment(self.params) :
 
         tmpGraphFiles.append(os.path.join(tmpGraphDir,graphFilename+"."+gseg.id+".bin"))
@@ -146,6 +214,14 @@ def runLocusGraph(self,taskPrefix="",dependencies=None):
         graphCmd.extend(["--output-file", tmpGraphFiles[-1]])
         graphCmd.extend(["--align-stats",statsPath])
         graphCmd.extend(["--region",gseg.bamRegion])
+        if not self.params.isExome :
+            tmpThrottledFiles.append(os.path.join(tmpGraphDir,"throttledRegions."+gseg.id+".txt"))
+            graphCmd.extend(["--chrom-depth", self.paths.getChromDepth()])
+            graphCmd.extend(["--throttle-depth-factor", str(self.params.graphThrottleDepthFactor)])
+            graphCmd.extend(["--throttled-region-file", tmpThrottledFiles[-1]])
+        if isDepthIndex :
+            tmpDepthIndexFiles.append(os.path.join(tmpGraphDir,"depthIndex."+gseg.id+".bin"))
+            graphCmd.extend(["--depth-index-output-file", tmpDepthIndexFiles[-1]])
         for bamPath in self.params.normalBamList :
             graphCmd.extend(["--align-file",bamPath])
         for bamPath in self.params.tumorBamList :
@@ -158,9 +234,17 @@ def runLocusGraph(self,taskPrefix="",dependencies=None):
     mergeCmd.extend(["--output-file", graphPath])
     for gfile in tmpGraphFiles :
         mergeCmd.extend(["--graph-file", gfile])
+    if isDepthIndex :
+        for ifile in tmpDepthIndexFiles :
+            mergeCmd.extend(["--depth-index-file", ifile])
+        mergeCmd.extend(["--depth-index-output-file", self.paths.getDepthIndexPath()])
 
     mergeTask = self.addTask(preJoin(taskPrefix,"mergeLocusGraph"),mergeCmd,dependencies=graphTasks)
 
+    if len(tmpThrottledFiles) :
+        throttledCmd = "cat " + " ".join(tmpThrottledFiles) + " >| " + self.paths.getThrottledRegionPath()
+        self.addTask(preJoin(taskPrefix,"mergeThrottledRegions"),throttledCmd,dependencies=graphTasks,isForceLocal=True)
+
     rmGraphTmpCmd = "rm -rf " + tmpGraphDir
     #rmTask=self.addTask(preJoin(taskPrefix,"rmGraphTmp"),rmGraphTmpCmd,dependencies=mergeTask)
 
@@ -182,33 +266,67 @@ def runHyGen(self, taskPrefix="", dependencies=None) :
     Run hypothesis generation on each SV locus
     """
 
-    statsPath=self.paths.getStatsPath()
+    statsPath=self.paths.getStatsBinaryPath()
     graphPath=self.paths.getGraphPath()
     hygenDir=self.paths.getHyGenDir()
 
-    dirTask=self.addTask(preJoin(taskPrefix,"makeHyGenDir"), "mkdir -p "+ hygenDir, dependencies=dependencies, isForceLocal=True)
+    # in dynamic mode, hygen processes claim small chunks of the graph's edges through a shared directory
+    # until all chunks are claimed, so that no process is left idle behind a slow static bin:
+    # a restarted hygen task reprocesses the chunks claimed under its bin index that it did not complete:
+    isDynamic = (self.params.hygenChunkCount > 0)
+    dirCmd = "mkdir -p "+ hygenDir
+    if isDynamic :
+        claimDir=self.paths.getHyGenClaimDir()
+        dirCmd = "rm -rf %s && mkdir -p %s %s" % (claimDir, hygenDir, claimDir)
+
+    dirTask=self.addTask(preJoin(taskPrefix,"makeHyGenDir"), dirCmd, dependencies=dependencies, isForceLocal=True)
 
-    isSomatic = (len(self.params.normalBamList) and len(self.params.tumorBamList))
+    isSomatic = isSomaticRun(self.params)
 
     hygenTasks=set()
     candidateVcfPaths = []
     somaticVcfPaths = []
+    edgeRuntimePaths = []
+
+    # each process shares one copy of the graph over several threads, so the work is
+    # divided into fewer, larger bins:
+    hygenCores = self.limitNCores(max(1,self.params.hygenMaxThreads))
+    hygenBinCount = max(1,(self.params.nonlocalWorkBins+hygenCores-1)//hygenCores)
 
-    for binId in range(self.params.nonlocalWorkBins) :
+    for binId in range(hygenBinCount) :
         binStr = str(binId).zfill(4)
-        candidateVcfPaths.append(self.paths.getHyGenCandidatePath(binStr))
+
+        # dynamic mode output filenames are prefixes for the output of each chunk:
+        outStr = binStr
+        if isDynamic : outStr = "chunk"
+        candidateVcfPaths.append(self.paths.getHyGenCandidatePath(outStr))
+        edgeRuntimePaths.append(self.paths.getHyGenEdgeRuntimePath(outStr))
         if isSomatic :
-            somaticVcfPaths.append(self.paths.getHyGenSomaticPath(binStr))
+            somaticVcfPaths.append(self.paths.getHyGenSomaticPath(outStr))
 
         hygenCmd = [ self.params.mantaHyGenBin ]
         hygenCmd.extend(["--align-stats",statsPath])
         hygenCmd.extend(["--graph-file",graphPath])
         hygenCmd.extend(["--bin-index", str(binId)])
-        hygenCmd.extend(["--bin-count", str(self.params.nonlocalWorkBins)])
+        hygenCmd.extend(["--bin-count", str(hygenBinCount)])
+        hygenCmd.extend(["--threads", str(hygenCores)])
+        hygenCmd.extend(["--edge-batch-size", str(self.params.hygenEdgeBatchSize)])
+        hygenCmd.extend(["--read-cache-megabytes", str(self.params.hygenReadCacheMegabytes)])
         hygenCmd.extend(["--ref",self.params.referenceFasta])
         hygenCmd.extend(["--candidate-output-file", candidateVcfPaths[-1]])
+        hygenCmd.append("--prefetch-regions")
+        hygenCmd.append("--locality-edge-order")
+        hygenCmd.append("--bgzf-output")
+        hygenCmd.extend(["--edge-runtime-output-file", edgeRuntimePaths[-1]])
+        if self.params.edgeRuntimeFile is not None :
+            hygenCmd.extend(["--edge-runtime-file", self.params.edgeRuntimeFile])
         if isSomatic :
             hygenCmd.extend(["--somatic-output-file", somaticVcfPaths[-1]])
+            if isBreakendDepthIndex(self.params) :
+                hygenCmd.extend(["--depth-index-file", self.paths.getDepthIndexPath()])
+        if isDynamic :
+            hygenCmd.extend(["--claim-dir", claimDir])
+            hygenCmd.extend(["--chunk-count", str(self.params.hygenChunkCount)])
 
         if not self.params.isExome :
             hygenCmd.extend(["--chrom-depth", self.paths.getChromDepth()])
@@ -220,27 +338,44 @@ def runHyGen(self, taskPrefix="", dependencies=None) :
             hygenCmd.extend(["--tumor-align-file",bamPath])
 
         hygenTaskLabel=preJoin(taskPrefix,"generateCandidateSV_"+binStr)
-        hygenTasks.add(self.addTask(hygenTaskLabel,hygenCmd,dependencies=dirTask))
+        hygenTasks.add(self.addTask(hygenTaskLabel,hygenCmd,dependencies=dirTask,nCores=hygenCores))
 
     nextStepWait = hygenTasks
 
+    if isDynamic :
+        def getChunkPaths(prefixPaths) :
+            if len(prefixPaths) == 0 : return []
+            return [ "%s.%05i" % (prefixPaths[0], chunkId) for chunkId in range(self.params.hygenChunkCount) ]
+
+        candidateVcfPaths = getChunkPaths(candidateVcfPaths)
+        somaticVcfPaths = getChunkPaths(somaticVcfPaths)
+        edgeRuntimePaths = getChunkPaths(edgeRuntimePaths)
 
-    def getVcfSortCmd(vcfPaths, outPath) :
-        cmd  = "%s -E %s " % (sys.executable,self.params.mantaSortVcf)
-        cmd += " ".join(vcfPaths)
-        cmd += " | %s -c > %s && %s -p vcf %s" % (self.params.bgzipBin, outPath, self.params.tabixBin, outPath)
+    # edge runtimes can be used to balance the hygen bins of a later run on the same graph:
+    runtimeCmd = "cat " + " ".join(edgeRuntimePaths) + " >| " + self.paths.getEdgeRuntimePath()
+    nextStepWait.add(self.addTask(preJoin(taskPrefix,"mergeEdgeRuntime"),runtimeCmd,dependencies=hygenTasks,isForceLocal=True))
+
+
+    # each hygen vcf is sorted and indexed, so the output is consolidated by a streaming merge
+    # in reference order:
+    def getVcfMergeCmd(vcfPaths, outPath) :
+        cmd  = [ self.params.mantaMergeVcfBin ]
+        cmd.extend(["--ref",self.params.referenceFasta])
+        cmd.extend(["--output-file",outPath])
+        for vcfPath in vcfPaths :
+            cmd.extend(["--vcf-file",vcfPath])
         return cmd
 
     # consolidate output:
     if len(candidateVcfPaths) :
         outPath = self.paths.getSortedCandidatePath()
-        candSortCmd = getVcfSortCmd(candidateVcfPaths,outPath)
+        candSortCmd = getVcfMergeCmd(candidateVcfPaths,outPath)
         candSortLabel=preJoin(taskPrefix,"sortCandidateSV")
         nextStepWait.add(self.addTask(candSortLabel,candSortCmd,dependencies=hygenTasks))
 
     if len(somaticVcfPaths) :
         outPath = self.paths.getSortedSomaticPath()
-        candSortCmd = getVcfSortCmd(somaticVcfPaths,outPath)
+        candSortCmd = getVcfMergeCmd(somaticVcfPaths,outPath)
         candSortLabel=preJoin(taskPrefix,"sortSomaticSV")
         nextStepWait.add(self.addTask(candSortLabel,candSortCmd,dependencies=hygenTasks))
 
@@ -259,23 +394,38 @@ class PathInfo:
     def getStatsPath(self) :
         return os.path.join(self.params.workDir,"alignmentStats.txt")
 
+    def getStatsBinaryPath(self) :
+        return os.path.join(self.params.workDir,"alignmentStats.bin")
+
     def getChromDepth(self) :
         return os.path.join(self.params.workDir,"chromDepth.txt")
 
+    def getThrottledRegionPath(self) :
+        return os.path.join(self.params.workDir,"throttledRegions.txt")
+
     def getGraphPath(self) :
         return os.path.join(self.params.workDir,"svLocusGraph.bin")
 
+    def getDepthIndexPath(self) :
+        return os.path.join(self.params.workDir,"depthIndex.bin")
+
     def getHyGenDir(self) :
         return os.path.join(self.params.workDir,"svHyGen")
 
     def getHyGenCandidatePath(self, binStr) :
-        return os.path.join(self.getHyGenDir(),"candidateSV.%s.vcf" % (binStr))
+        return os.path.join(self.getHyGenDir(),"candidateSV.%s.vcf.gz" % (binStr))
 
     def getSortedCandidatePath(self) :
         return os.path.join(self.params.variantsDir,"candidateSV.vcf.gz")
 
     def getHyGenSomaticPath(self, binStr) :
-        return os.path.join(self.getHyGenDir(),"somaticSV.%s.vcf" % (binStr))
+        return os.path.join(self.getHyGenDir(),"somaticSV.%s.vcf.gz" % (binStr))
+
+    def getHyGenClaimDir(self) :
+        return os.path.join(self.getHyGenDir(),"chunkClaims")
+
+    def getHyGenEdgeRuntimePath(self, binStr) :
+        return os.path.join(self.getHyGenDir(),"edgeRuntime.%s.tsv" % (binStr))
 
     def getSortedSomaticPath(self) :
         return os.path.join(self.params.variantsDir,"somaticSV.vcf.gz")
@@ -283,6 +433,9 @@ class PathInfo:
     def getGraphStatsPath(self) :
         return os.path.join(self.params.statsDir,"svLocusGraphStats.tsv")
 
+    def getEdgeRuntimePath(self) :
+        return os.path.join(self.params.statsDir,"svCandidateGenerationEdgeRuntime.tsv")
+
 
 
 class MantaWorkflow(WorkflowRunner) :
@@ -342,7 +495,21 @@ class MantaWorkflow(WorkflowRunner) :
 
         # sanity check some parameter typing:
         self.params.binSize = int(self.params.binSize)
+        self.params.minSegmentSize = int(self.params.minSegmentSize)
+        self.params.maxSegmentSize = int(self.params.maxSegmentSize)
+        self.params.segmentSampleCount = int(self.params.segmentSampleCount)
+        self.params.segmentSampleBlockWindows = int(self.params.segmentSampleBlockWindows)
+        self.params.segmentSampleSize = int(self.params.segmentSampleSize)
+        self.params.graphThrottleDepthFactor = float(self.params.graphThrottleDepthFactor)
+        self.params.statsMaxThreads = int(self.params.statsMaxThreads)
         self.params.nonlocalWorkBins = int(self.params.nonlocalWorkBins)
+        self.params.hygenMaxThreads = int(self.params.hygenMaxThreads)
+        self.params.hygenEdgeBatchSize = int(self.params.hygenEdgeBatchSize)
+        self.params.hygenReadCacheMegabytes = int(self.params.hygenReadCacheMegabytes)
+        self.params.hygenChunkCount = int(self.params.hygenChunkCount)
+
+        # the cost-balanced genome segmentation is computed at the start of the workflow run:
+        self.params.genomeSegments = None
 
         self.paths = PathInfo(self.params)
 
@@ -360,12 +527,17 @@ class MantaWorkflow(WorkflowRunner) :
     def workflow(self) :
         self.flowLog("Initiating Manta workflow version: %s" % (__version__))
 
+        if self.params.isAdaptiveSegments :
+            planGenomeSegments(self)
+
         statsTasks = runStats(self)
 
+        graphPrereq = statsTasks
         if not self.params.isExome :
             depthTasks = runDepth(self)
+            graphPrereq = graphPrereq | depthTasks
 
-        graphTasks = runLocusGraph(self,dependencies=statsTasks)
+        graphTasks = runLocusGraph(self,dependencies=graphPrereq)
 
         hygenPrereq = graphTasks
         if not self.params.isExome :